@@ -0,0 +1,130 @@
+// Redis 行情值编解码微基准：JSON（ostringstream + nlohmann::json）vs 定长二进制
+// 1. 编码 / 解码 ns/op，不需要 Redis
+// 2. 给定 Redis 地址时，分别写入 N 个 key，用 MEMORY USAGE 比较每个 key 的内存占用
+// 用法: codec_bench [redis_host] [redis_port] [keys]
+#include "market_data_codec.h"
+#include <hiredis/hiredis.h>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::vector<RawRecord> make_records(int n) {
+    const std::string exchanges[] = {"bitmart", "cryptocom", "mexc"};
+    const std::string symbols[] = {"BTC/USDT", "ETH/USDT", "XRP/USDT", "SOL/USDT"};
+    std::vector<RawRecord> records(n);
+    for (int i = 0; i < n; ++i) {
+        double price = 60000.0 + (i % 1000) * 0.12345678;
+        records[i] = RawRecord{i, exchanges[i % 3], symbols[i % 4], price, price - 0.5, price + 0.5,
+                               price + 100.0, price - 100.0, 1234.56789 + i, 1700000000000L + i};
+    }
+    return records;
+}
+
+template <typename Fn>
+double time_ns(int n, Fn fn) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < n; ++i) fn(i);
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / n;
+}
+
+void run_codec(int n) {
+    auto records = make_records(n);
+
+    std::vector<std::string> json_values(n);
+    double json_encode = time_ns(n, [&](int i) { json_values[i] = market_codec::encode_raw_json(records[i]); });
+
+    // 二进制编码写入预先分配的定长缓冲区，exchange/symbol id 直接用下标代替 intern 表
+    std::vector<char> binary_values(static_cast<size_t>(n) * market_codec::RAW_BINARY_SIZE);
+    double binary_encode = time_ns(n, [&](int i) {
+        market_codec::encode_raw(records[i], i % 3, i % 4, &binary_values[i * market_codec::RAW_BINARY_SIZE]);
+    });
+
+    RawRecord json_out;
+    double json_decode = time_ns(n, [&](int i) {
+        market_codec::decode_raw_json(json_values[i].data(), json_values[i].size(), json_out);
+    });
+
+    market_codec::RawBinary binary_out;
+    double binary_decode = time_ns(n, [&](int i) {
+        market_codec::decode_raw(&binary_values[i * market_codec::RAW_BINARY_SIZE],
+                                 market_codec::RAW_BINARY_SIZE, binary_out);
+    });
+
+    // 防止优化掉
+    volatile double sink = json_out.last + binary_out.last;
+    (void)sink;
+
+    std::printf("%8d records | encode: json %7.1f ns/op, binary %6.1f ns/op (%.1fx) | "
+                "decode: json %7.1f ns/op, binary %6.1f ns/op (%.1fx) | size: json %zu B, binary %zu B\n",
+                n, json_encode, binary_encode, json_encode / binary_encode,
+                json_decode, binary_decode, json_decode / binary_decode,
+                json_values[0].size(), market_codec::RAW_BINARY_SIZE);
+}
+
+// 返回每个 key 的平均 MEMORY USAGE（字节），失败返回 -1
+double memory_per_key(redisContext* ctx, const std::string& prefix, const std::vector<std::string>& values) {
+    for (size_t i = 0; i < values.size(); ++i) {
+        std::string key = prefix + std::to_string(i);
+        redisAppendCommand(ctx, "SET %s %b", key.c_str(), values[i].data(), values[i].size());
+    }
+    for (size_t i = 0; i < values.size(); ++i) {
+        redisReply* reply;
+        if (redisGetReply(ctx, (void**)&reply) != REDIS_OK) return -1;
+        freeReplyObject(reply);
+    }
+
+    long long total = 0;
+    for (size_t i = 0; i < values.size(); ++i) {
+        std::string key = prefix + std::to_string(i);
+        redisReply* reply = (redisReply*)redisCommand(ctx, "MEMORY USAGE %s", key.c_str());
+        if (reply && reply->type == REDIS_REPLY_INTEGER) total += reply->integer;
+        if (reply) freeReplyObject(reply);
+        reply = (redisReply*)redisCommand(ctx, "DEL %s", key.c_str());
+        if (reply) freeReplyObject(reply);
+    }
+    return static_cast<double>(total) / values.size();
+}
+
+void run_memory(const std::string& host, int port, int n) {
+    redisContext* ctx = redisConnect(host.c_str(), port);
+    if (ctx == nullptr || ctx->err) {
+        std::cerr << "Redis connection failed, skipping memory benchmark" << std::endl;
+        if (ctx) redisFree(ctx);
+        return;
+    }
+
+    auto records = make_records(n);
+    std::vector<std::string> json_values, binary_values;
+    char buf[market_codec::RAW_BINARY_SIZE];
+    for (int i = 0; i < n; ++i) {
+        json_values.push_back(market_codec::encode_raw_json(records[i]));
+        size_t len = market_codec::encode_raw(records[i], i % 3, i % 4, buf);
+        binary_values.emplace_back(buf, len);
+    }
+
+    double json_bytes = memory_per_key(ctx, "bench:codec:json:", json_values);
+    double binary_bytes = memory_per_key(ctx, "bench:codec:binary:", binary_values);
+    std::printf("%8d keys | MEMORY USAGE per key: json %.1f B, binary %.1f B (%.1f%% saved)\n",
+                n, json_bytes, binary_bytes, 100.0 * (json_bytes - binary_bytes) / json_bytes);
+
+    redisFree(ctx);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::cout << "=== Redis value codec benchmark (RawRecord) ===" << std::endl;
+    run_codec(10000);
+    run_codec(1000000);
+
+    if (argc > 1) {
+        int port = argc > 2 ? std::stoi(argv[2]) : 6379;
+        int keys = argc > 3 ? std::stoi(argv[3]) : 10000;
+        run_memory(argv[1], port, keys);
+    }
+    return 0;
+}
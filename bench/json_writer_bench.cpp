@@ -0,0 +1,164 @@
+// JSON 编码吞吐基准：原 ostringstream + std::fixed + setprecision(8) vs to_chars
+// 1. 先对一批普通值和边界值（负数、-0、舍入进位、极大值、nan/inf）逐字节比对两种输出
+// 2. 再比较 ns/op 与 MB/s：ostringstream 每条一个 std::string、to_chars 每条一个 std::string、
+//    JsonWriter 整批写入一块复用的缓冲区
+// 用法: json_writer_bench [records]
+#include "market_data_codec.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+// 改动前 RedisWriter 使用的序列化代码，作为基准和比对对象
+std::string legacy_raw_json(const RawRecord& record) {
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(8);
+    oss << "{"
+        << "\"id\":" << record.id << ","
+        << "\"exchange\":\"" << record.exchange << "\","
+        << "\"symbol\":\"" << record.symbol << "\","
+        << "\"last\":" << record.last << ","
+        << "\"bid\":" << record.bid << ","
+        << "\"ask\":" << record.ask << ","
+        << "\"high\":" << record.high << ","
+        << "\"low\":" << record.low << ","
+        << "\"volume\":" << record.volume << ","
+        << "\"timestamp\":" << record.timestamp
+        << "}";
+    return oss.str();
+}
+
+std::string legacy_price_stats_json(const PriceStatsRecord& record) {
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(8);
+    oss << "{"
+        << "\"id\":" << record.id << ","
+        << "\"symbol\":\"" << record.symbol << "\","
+        << "\"highest_price\":" << record.highest_price << ","
+        << "\"highest_exchange\":\"" << record.highest_exchange << "\","
+        << "\"lowest_price\":" << record.lowest_price << ","
+        << "\"lowest_exchange\":\"" << record.lowest_exchange << "\","
+        << "\"record_count\":" << record.record_count << ","
+        << "\"earliest_timestamp\":" << record.earliest_timestamp << ","
+        << "\"latest_timestamp\":" << record.latest_timestamp
+        << "}";
+    return oss.str();
+}
+
+std::vector<RawRecord> make_records(int n) {
+    const std::string exchanges[] = {"bitmart", "cryptocom", "mexc"};
+    const std::string symbols[] = {"BTC/USDT", "ETH/USDT", "XRP/USDT", "SOL/USDT"};
+    std::vector<RawRecord> records(n);
+    for (int i = 0; i < n; ++i) {
+        double price = 60000.0 + (i % 1000) * 0.12345678;
+        records[i] = RawRecord{i, exchanges[i % 3], symbols[i % 4], price, price - 0.5, price + 0.5,
+                               price + 100.0, price - 100.0, 1234.56789 + i, 1700000000000L + i};
+    }
+    return records;
+}
+
+std::vector<double> edge_values() {
+    return {0.0, -0.0, 1.0, -1.0, 0.123456785, 0.123456775, 0.999999995, 1e-9, -1e-9, 5e-9,
+            123456789.123456789, 1e15 + 0.5, 1e300, -1e300, std::numeric_limits<double>::max(),
+            std::numeric_limits<double>::lowest(), std::numeric_limits<double>::denorm_min(),
+            std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity(),
+            std::numeric_limits<double>::quiet_NaN()};
+}
+
+// 返回不一致的条数
+int verify(const std::vector<RawRecord>& records) {
+    int mismatches = 0;
+    auto report = [&](const std::string& expected, const std::string& actual) {
+        if (expected == actual) return;
+        if (++mismatches <= 5) {
+            std::cerr << "MISMATCH\n  ostringstream: " << expected << "\n  to_chars:      " << actual << std::endl;
+        }
+    };
+
+    for (const auto& record : records) {
+        report(legacy_raw_json(record), market_codec::encode_raw_json(record));
+    }
+
+    long ints[] = {0, -1, std::numeric_limits<int>::max(), std::numeric_limits<int>::min()};
+    for (double v : edge_values()) {
+        for (long n : ints) {
+            RawRecord raw{static_cast<int>(n), "binance", "BTC/USDT", v, -v, v, v, v, v, n * 1000L};
+            report(legacy_raw_json(raw), market_codec::encode_raw_json(raw));
+            PriceStatsRecord stats{static_cast<int>(n), "BTC/USDT", v, "binance", -v, "mexc",
+                                   static_cast<int>(n), n * 1000L, std::numeric_limits<long>::max()};
+            report(legacy_price_stats_json(stats), market_codec::encode_price_stats_json(stats));
+        }
+    }
+
+    // JsonWriter 按批写入后的每个切片也要与单条编码一致
+    market_codec::JsonWriter writer(256);
+    std::vector<market_codec::ValueSlice> slices;
+    for (const auto& record : records) slices.push_back(writer.append_raw(record));
+    for (size_t i = 0; i < records.size(); ++i) {
+        report(legacy_raw_json(records[i]), std::string(writer.data(slices[i]), slices[i].len));
+    }
+    return mismatches;
+}
+
+template <typename Fn>
+double time_ns(int n, Fn fn) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < n; ++i) fn(i);
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / n;
+}
+
+void run_throughput(int n, int batch) {
+    auto records = make_records(n);
+    size_t bytes = 0;
+    for (const auto& record : records) bytes += market_codec::encode_raw_json(record).size();
+    double avg_bytes = static_cast<double>(bytes) / n;
+
+    std::string sink;
+    double legacy = time_ns(n, [&](int i) { sink = legacy_raw_json(records[i]); });
+    double to_chars = time_ns(n, [&](int i) { sink = market_codec::encode_raw_json(records[i]); });
+
+    // 与 RedisWriter 的写入路径相同：每 batch 条 clear() 一次，整批写进同一块缓冲区
+    market_codec::JsonWriter writer;
+    size_t total = 0;
+    double batched = time_ns(n, [&](int i) {
+        if (i % batch == 0) {
+            total += writer.size();
+            writer.clear();
+        }
+        writer.append_raw(records[i]);
+    });
+
+    volatile size_t keep = sink.size() + total + writer.size();
+    (void)keep;
+
+    auto mbps = [&](double ns) { return avg_bytes / ns * 1e3; };
+    std::printf("%8d records | ostringstream %6.1f ns/op (%6.1f MB/s) | to_chars string %6.1f ns/op (%.1fx) | "
+                "JsonWriter batch=%d %6.1f ns/op (%6.1f MB/s, %.1fx)\n",
+                n, legacy, mbps(legacy), to_chars, legacy / to_chars,
+                batch, batched, mbps(batched), legacy / batched);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int n = argc > 1 ? std::stoi(argv[1]) : 1000000;
+
+    std::cout << "=== JSON writer benchmark (RawRecord) ===" << std::endl;
+    int mismatches = verify(make_records(10000));
+    if (mismatches > 0) {
+        std::cerr << mismatches << " outputs differ from the ostringstream encoder" << std::endl;
+        return 1;
+    }
+    std::cout << "to_chars output is byte-identical to ostringstream" << std::endl;
+
+    run_throughput(10000, 1000);
+    run_throughput(n, 1000);
+    return 0;
+}
@@ -0,0 +1,128 @@
+// TimescaleDBReader 结果解码微基准：文本格式（std::stoi/stod/stol）vs 二进制格式
+// 不需要数据库，直接用 libpq 构造结果集
+#include "pg_binary.h"
+#include <libpq-fe.h>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+const int RAW_COLUMNS = 10;
+const char* COLUMN_NAMES[RAW_COLUMNS] = {
+    "id", "exchange", "symbol", "last", "bid", "ask", "high", "low", "volume", "timestamp"};
+
+// 改造前 read_latest_raw() 的逐格文本解析
+void decode_raw_row_text(const PGresult* res, int i, RawRecord& rec) {
+    rec.id = std::stoi(PQgetvalue(res, i, 0));
+    rec.exchange = PQgetvalue(res, i, 1);
+    rec.symbol = PQgetvalue(res, i, 2);
+    rec.last = std::stod(PQgetvalue(res, i, 3));
+    rec.bid = std::stod(PQgetvalue(res, i, 4));
+    rec.ask = std::stod(PQgetvalue(res, i, 5));
+    rec.high = std::stod(PQgetvalue(res, i, 6));
+    rec.low = std::stod(PQgetvalue(res, i, 7));
+    rec.volume = std::stod(PQgetvalue(res, i, 8));
+    rec.timestamp = std::stol(PQgetvalue(res, i, 9));
+}
+
+PGresult* make_result(int format) {
+    PGresult* res = PQmakeEmptyPGresult(nullptr, PGRES_TUPLES_OK);
+    PGresAttDesc attrs[RAW_COLUMNS] = {};
+    for (int c = 0; c < RAW_COLUMNS; ++c) {
+        attrs[c].name = const_cast<char*>(COLUMN_NAMES[c]);
+        attrs[c].format = format;
+        attrs[c].typlen = -1;
+        attrs[c].atttypmod = -1;
+    }
+    PQsetResultAttrs(res, RAW_COLUMNS, attrs);
+    return res;
+}
+
+void set_int4(PGresult* res, int row, int col, int32_t v) {
+    uint32_t be = htobe32(static_cast<uint32_t>(v));
+    PQsetvalue(res, row, col, reinterpret_cast<char*>(&be), sizeof(be));
+}
+
+void set_int8(PGresult* res, int row, int col, int64_t v) {
+    char buf[8];
+    pg_binary::write_int8(buf, v);
+    PQsetvalue(res, row, col, buf, sizeof(buf));
+}
+
+void set_float8(PGresult* res, int row, int col, double v) {
+    uint64_t bits;
+    std::memcpy(&bits, &v, sizeof(bits));
+    set_int8(res, row, col, static_cast<int64_t>(bits));
+}
+
+void set_text(PGresult* res, int row, int col, const std::string& v) {
+    PQsetvalue(res, row, col, const_cast<char*>(v.data()), v.size());
+}
+
+void fill(PGresult* text, PGresult* binary, int rows) {
+    const std::string exchanges[] = {"bitmart", "cryptocom", "mexc"};
+    const std::string symbols[] = {"BTC/USDT", "ETH/USDT", "XRP/USDT", "SOL/USDT"};
+    char buf[64];
+    for (int i = 0; i < rows; ++i) {
+        double price = 60000.0 + (i % 1000) * 0.12345678;
+        double values[6] = {price, price - 0.5, price + 0.5, price + 100.0, price - 100.0, 1234.56789 + i};
+        long ts = 1700000000000L + i;
+
+        set_text(text, i, 0, std::to_string(i));
+        set_text(text, i, 1, exchanges[i % 3]);
+        set_text(text, i, 2, symbols[i % 4]);
+        for (int c = 0; c < 6; ++c) {
+            std::snprintf(buf, sizeof(buf), "%.8f", values[c]);
+            set_text(text, i, 3 + c, buf);
+        }
+        set_text(text, i, 9, std::to_string(ts));
+
+        set_int4(binary, i, 0, i);
+        set_text(binary, i, 1, exchanges[i % 3]);
+        set_text(binary, i, 2, symbols[i % 4]);
+        for (int c = 0; c < 6; ++c) set_float8(binary, i, 3 + c, values[c]);
+        set_int8(binary, i, 9, ts);
+    }
+}
+
+template <typename Decode>
+double time_decode(const PGresult* res, int rows, Decode decode) {
+    std::vector<RawRecord> out(rows);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < rows; ++i) decode(res, i, out[i]);
+    auto end = std::chrono::steady_clock::now();
+    // 防止优化掉
+    volatile double sink = out[rows - 1].last;
+    (void)sink;
+    return std::chrono::duration<double, std::nano>(end - start).count();
+}
+
+void run(int rows) {
+    PGresult* text = make_result(0);
+    PGresult* binary = make_result(1);
+    fill(text, binary, rows);
+
+    double text_ns = time_decode(text, rows, decode_raw_row_text);
+    double binary_ns = time_decode(binary, rows, pg_binary::decode_raw_row);
+
+    std::printf("%8d rows | text: %8.1f ns/row %10.0f rows/s | binary: %8.1f ns/row %10.0f rows/s | speedup %.2fx\n",
+                rows,
+                text_ns / rows, rows / (text_ns / 1e9),
+                binary_ns / rows, rows / (binary_ns / 1e9),
+                text_ns / binary_ns);
+
+    PQclear(text);
+    PQclear(binary);
+}
+
+} // namespace
+
+int main() {
+    std::cout << "=== PG result decode benchmark (RawRecord) ===" << std::endl;
+    run(10000);
+    run(1000000);
+    return 0;
+}
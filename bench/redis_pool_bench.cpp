@@ -0,0 +1,99 @@
+// RedisWriter 并发读吞吐：单连接 vs 连接池
+// 先写入 N 个 raw key，再用 1/2/4/8/16 个线程并发 read_raw_record，
+// 分别在 pool_size = 1（所有线程排队用一个连接）和 pool_size = 线程数 下测量 ops/s
+// 用法: redis_pool_bench [redis_host] [redis_port] [keys]
+#include "redis_writer.h"
+#include "timescaledb_reader.h"
+#include <hiredis/hiredis.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+const int READS_PER_THREAD = 20000;
+
+std::vector<RawRecord> make_records(int n) {
+    const std::string exchanges[] = {"bitmart", "cryptocom", "mexc"};
+    std::vector<RawRecord> records(n);
+    for (int i = 0; i < n; ++i) {
+        double price = 60000.0 + (i % 1000) * 0.12345678;
+        records[i] = RawRecord{i, exchanges[i % 3], "BENCH" + std::to_string(i) + "/USDT", price, price - 0.5,
+                               price + 0.5, price + 100.0, price - 100.0, 1234.56789 + i, 1700000000000L + i};
+    }
+    return records;
+}
+
+// 返回 ops/s，失败的读取计入 failed
+double run_reads(RedisWriter& writer, const std::vector<RawRecord>& records, int threads, long& failed) {
+    std::atomic<long> failures{0};
+    std::vector<std::thread> workers;
+    auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t]() {
+            RawRecord out;
+            for (int i = 0; i < READS_PER_THREAD; ++i) {
+                const RawRecord& record = records[(t * 7919 + i) % records.size()];
+                if (!writer.read_raw_record(record.exchange, record.symbol, out)) failures++;
+            }
+        });
+    }
+    for (auto& worker : workers) worker.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    failed = failures;
+    return static_cast<double>(threads) * READS_PER_THREAD / seconds;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string host = argc > 1 ? argv[1] : "127.0.0.1";
+    int port = argc > 2 ? std::stoi(argv[2]) : 6379;
+    int keys = argc > 3 ? std::stoi(argv[3]) : 1000;
+
+    auto records = make_records(keys);
+    {
+        RedisWriter writer(host, port);
+        if (!writer.is_connected() || !writer.write_raw_records(records)) {
+            std::cerr << "Failed to prepare benchmark keys" << std::endl;
+            return 1;
+        }
+    }
+
+    std::cout << "=== RedisWriter read throughput (" << keys << " keys, "
+              << READS_PER_THREAD << " GETs per thread) ===" << std::endl;
+    for (int threads : {1, 2, 4, 8, 16}) {
+        long single_failed = 0, pooled_failed = 0;
+
+        RedisWriter single(host, port, "", 1);
+        double single_ops = run_reads(single, records, threads, single_failed);
+
+        auto pool = std::make_shared<RedisPool>(host, port, "", threads);
+        RedisWriter pooled(pool);
+        double pooled_ops = run_reads(pooled, records, threads, pooled_failed);
+
+        std::printf("%3d threads | pool=1 %10.0f ops/s | pool=%-2d %10.0f ops/s (%.2fx) | "
+                    "waits %llu, failed %ld/%ld\n",
+                    threads, single_ops, threads, pooled_ops, pooled_ops / single_ops,
+                    static_cast<unsigned long long>(pool->wait_count()), single_failed, pooled_failed);
+    }
+
+    // 只删除基准写入的 key，索引集合里残留的成员会在下次读取时被清理
+    RedisPool cleanup(host, port, "", 1);
+    if (auto conn = cleanup.acquire()) {
+        for (const auto& record : records) {
+            std::string key = "crypto:raw:" + record.exchange + ":" + record.symbol;
+            redisAppendCommand(conn.get(), "DEL %s", key.c_str());
+        }
+        for (size_t i = 0; i < records.size(); ++i) {
+            redisReply* reply;
+            if (redisGetReply(conn.get(), (void**)&reply) != REDIS_OK) break;
+            freeReplyObject(reply);
+        }
+    }
+    return 0;
+}
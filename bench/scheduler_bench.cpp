@@ -0,0 +1,127 @@
+// 调度器负载基准：大量任务、部分任务执行时间超过间隔
+// 统计各 OverrunPolicy 下的触发延迟分位数、overrun/skip/coalesce 次数和进程线程数峰值，
+// 以及 FixedRate / FixedDelay 的累计漂移和唤醒抖动
+// 用法: scheduler_bench [tasks] [seconds] [workers]
+#include "scheduler.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// /proc/self/status 里的 Threads 字段
+int thread_count() {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, 8, "Threads:") == 0) return std::stoi(line.substr(8));
+    }
+    return -1;
+}
+
+const char* policy_name(OverrunPolicy policy) {
+    switch (policy) {
+        case OverrunPolicy::Skip: return "skip";
+        case OverrunPolicy::Coalesce: return "coalesce";
+        case OverrunPolicy::Queue: return "queue";
+    }
+    return "?";
+}
+
+void run_policy(OverrunPolicy policy, int tasks, int seconds, size_t workers) {
+    Scheduler scheduler(workers);
+    std::vector<SchedulerTaskHandle> handles;
+    std::atomic<long> executed{0};
+
+    // 每 50 个任务里有 1 个慢任务：间隔 20ms、执行 50ms，必然重叠
+    for (int i = 0; i < tasks; ++i) {
+        bool slow = i % 50 == 0;
+        int interval_ms = slow ? 20 : 10 + i % 40;
+        int work_us = slow ? 50000 : 200;
+        handles.push_back(scheduler.addTask([work_us, &executed]() {
+            std::this_thread::sleep_for(std::chrono::microseconds(work_us));
+            executed++;
+        }, interval_ms, policy));
+    }
+
+    scheduler.start();
+    int peak_threads = 0;
+    auto end = std::chrono::steady_clock::now() + std::chrono::seconds(seconds);
+    while (std::chrono::steady_clock::now() < end) {
+        peak_threads = std::max(peak_threads, thread_count());
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+
+    SchedulerTaskStats total;
+    double p99 = 0.0, max_latency = 0.0;
+    for (const auto& handle : handles) {
+        SchedulerTaskStats stats;
+        if (!handle.getStats(stats)) continue;
+        total.runs += stats.runs;
+        total.overruns += stats.overruns;
+        total.skipped += stats.skipped;
+        total.coalesced += stats.coalesced;
+        p99 = std::max(p99, stats.latencyP99Us);
+        max_latency = std::max(max_latency, stats.latencyMaxUs);
+    }
+    scheduler.stop();
+
+    std::printf("%-8s | %d tasks, %zu workers | runs %lu, overruns %lu, skipped %lu, coalesced %lu | "
+                "worst task latency p99 %.0f us, max %.0f us | peak threads %d\n",
+                policy_name(policy), tasks, workers, (unsigned long)total.runs, (unsigned long)total.overruns,
+                (unsigned long)total.skipped, (unsigned long)total.coalesced, p99, max_latency, peak_threads);
+}
+
+// 单个 50ms 任务跑 seconds 秒：比较两种模式下最后一次触发相对理想时刻的漂移和唤醒抖动
+void run_drift(ScheduleMode mode, bool high_resolution, int seconds) {
+    Scheduler scheduler(1);
+    scheduler.setHighResolutionWait(high_resolution);
+    const int interval_ms = 50;
+    std::chrono::steady_clock::time_point first, last;
+    long fired = 0;
+    SchedulerTaskHandle handle = scheduler.addTask([&]() {
+        auto now = std::chrono::steady_clock::now();
+        if (fired++ == 0) first = now;
+        last = now;
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));  // 让 FixedDelay 的间隔明显变长
+    }, interval_ms, OverrunPolicy::Skip, mode);
+
+    scheduler.start();
+    std::this_thread::sleep_for(std::chrono::seconds(seconds));
+    SchedulerTaskStats stats;
+    handle.getStats(stats);
+    scheduler.stop();
+
+    double drift_ms = fired > 1
+        ? std::chrono::duration<double, std::milli>(last - first).count() - (fired - 1) * interval_ms
+        : 0.0;
+    std::printf("%-11s %-9s | %ld runs | drift after last run %+.2f ms | wakeup jitter p50 %.0f us, "
+                "p99 %.0f us, max %.0f us\n",
+                mode == ScheduleMode::FixedRate ? "fixed-rate" : "fixed-delay",
+                high_resolution ? "spin-wait" : "cv-wait", fired, drift_ms,
+                stats.jitterP50Us, stats.jitterP99Us, stats.jitterMaxUs);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int tasks = argc > 1 ? std::stoi(argv[1]) : 200;
+    int seconds = argc > 2 ? std::stoi(argv[2]) : 3;
+    size_t workers = argc > 3 ? std::stoul(argv[3]) : 8;
+
+    std::cout << "=== Scheduler benchmark ===" << std::endl;
+    run_policy(OverrunPolicy::Skip, tasks, seconds, workers);
+    run_policy(OverrunPolicy::Coalesce, tasks, seconds, workers);
+    run_policy(OverrunPolicy::Queue, tasks, seconds, workers);
+
+    run_drift(ScheduleMode::FixedDelay, false, seconds);
+    run_drift(ScheduleMode::FixedRate, false, seconds);
+    run_drift(ScheduleMode::FixedRate, true, seconds);
+    return 0;
+}
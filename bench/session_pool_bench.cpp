@@ -0,0 +1,127 @@
+// 会话执行基准：原来的单线程串行循环 vs 工作窃取线程池
+// 每个模拟会话一次执行 = 一段 CPU 计算 + 一次短暂的 I/O 等待（模拟 Redis 读取），
+// 其中一个会话每次卡住 stall_ms（模拟 Redis 抖动）。比较每轮全部会话执行完的耗时，
+// 以及池模式下正常会话的执行不被慢会话拖住。
+// 用法: session_pool_bench [sessions] [rounds] [threads] [stall_ms]
+#include "work_stealing_pool.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct SimSession {
+    std::atomic<bool> in_flight{false};
+    std::atomic<bool> rerun{false};
+    bool slow = false;
+};
+
+volatile double sink = 0.0;
+
+void execute(const SimSession& session, int stall_ms) {
+    double x = 0.0;
+    for (int i = 0; i < 20000; ++i) x += i * 1e-9;  // 策略计算
+    sink = x;
+    std::this_thread::sleep_for(std::chrono::microseconds(200));  // 读取行情
+    if (session.slow) std::this_thread::sleep_for(std::chrono::milliseconds(stall_ms));
+}
+
+double ms_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+double run_serial(std::vector<SimSession>& sessions, int rounds, int stall_ms) {
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; ++r) {
+        for (auto& session : sessions) execute(session, stall_ms);
+    }
+    return ms_since(start) / rounds;
+}
+
+// 与 TradingEngineManager::submit_group / run_group 相同的提交方式
+struct PoolRunner {
+    PoolRunner(WorkStealingPool& pool, int stall_ms) : pool(pool), stall_ms(stall_ms) {}
+
+    WorkStealingPool& pool;
+    int stall_ms;
+    std::mutex mutex;
+    std::condition_variable cv;
+    long remaining = 0;       // 本轮还没执行完的普通会话数
+    double fast_done_ms = 0;  // 本轮普通会话全部完成的时刻
+
+    void submit(SimSession* session) {
+        session->rerun = true;
+        if (session->in_flight.exchange(true)) return;
+        pool.submit([this, session]() { run(session); });
+    }
+
+    void run(SimSession* session) {
+        while (true) {
+            session->rerun = false;
+            execute(*session, stall_ms);
+            if (!session->slow) {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (--remaining == 0) cv.notify_all();
+            }
+            session->in_flight = false;
+            if (!session->rerun || session->in_flight.exchange(true)) return;
+        }
+    }
+};
+
+void run_pool(std::vector<SimSession>& sessions, int rounds, size_t threads, int stall_ms, double serial_ms) {
+    WorkStealingPool pool(threads);
+    pool.start();
+    PoolRunner runner(pool, stall_ms);
+
+    long fast = 0;
+    for (const auto& session : sessions) fast += session.slow ? 0 : 1;
+
+    double total_ms = 0.0;
+    for (int r = 0; r < rounds; ++r) {
+        auto start = std::chrono::steady_clock::now();
+        {
+            std::lock_guard<std::mutex> lock(runner.mutex);
+            runner.remaining = fast;
+        }
+        for (auto& session : sessions) runner.submit(&session);
+        std::unique_lock<std::mutex> lock(runner.mutex);
+        runner.cv.wait(lock, [&]() { return runner.remaining == 0; });
+        total_ms += ms_since(start);
+    }
+    auto stats = pool.stats();
+    pool.stop();
+
+    double round_ms = total_ms / rounds;
+    std::printf("pool   %2zu threads | %zu sessions | healthy sessions done in %8.2f ms/round (%.1fx vs serial) | "
+                "executed %lu, stolen %lu\n",
+                threads, sessions.size(), round_ms, serial_ms / round_ms,
+                (unsigned long)stats.executed, (unsigned long)stats.stolen);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t count = argc > 1 ? std::stoul(argv[1]) : 200;
+    int rounds = argc > 2 ? std::stoi(argv[2]) : 5;
+    size_t max_threads = argc > 3 ? std::stoul(argv[3]) : std::max(1u, std::thread::hardware_concurrency());
+    int stall_ms = argc > 4 ? std::stoi(argv[4]) : 50;
+
+    std::vector<SimSession> sessions(count);
+    sessions[0].slow = true;
+
+    std::cout << "=== Session execution benchmark ===" << std::endl;
+    double serial_ms = run_serial(sessions, rounds, stall_ms);
+    std::printf("serial  1 thread  | %zu sessions | all sessions done in %8.2f ms/round\n", count, serial_ms);
+
+    for (size_t threads = 1; threads <= max_threads; threads *= 2) {
+        run_pool(sessions, rounds, threads, stall_ms, serial_ms);
+    }
+    return 0;
+}
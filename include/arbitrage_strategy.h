@@ -2,6 +2,8 @@
 #include "redis_writer.h"
 #include "timescaledb_reader.h"
 #include "strategy_result.h"
+#include "market_data_cache.h"
+#include "freshness_tracker.h"
 
 #include <string>
 #include <memory>
@@ -10,7 +12,7 @@
 /**
  * 套利策略
  * 功能：
- * 1. 从 Redis 读取市场数据
+ * 1. 从进程内行情缓存读取市场数据（没有缓存数据时回退到 Redis）
  * 2. 计算价差，判断是否存在套利机会
  * 3. 考虑手续费后计算净利润
  * 4. 显示套利机会和建议操作
@@ -18,15 +20,32 @@
 class ArbitrageStrategy {
 public:
     ArbitrageStrategy(std::shared_ptr<RedisWriter> redis_client,
-                      const std::string& symbol);
+                      const std::string& symbol,
+                      std::shared_ptr<MarketDataCache> market_cache = nullptr);
     
+    // 一次读取的价格统计，同一 symbol 的多个会话共用
+    struct PriceStatsData {
+        PriceStatsRecord stats{};
+        bool is_valid = false;
+        double published_at_ms = 0.0;  // 发布到缓存的时间，从 Redis 读到时为 0
+        double read_at_ms = 0.0;       // 读到的时间
+    };
+
     // 核心方法
     StrategyResult run_once();
+    // 使用调用方已经读好的数据，不再访问缓存或 Redis
+    StrategyResult run_once(const PriceStatsData& data);
+    // 从缓存读取（没有时回退到 Redis），结果可以交给同一 symbol 的所有策略
+    PriceStatsData get_price_stats();
     
     // 策略配置
     void set_min_profit_bps(double min_profit_bps);
     void set_max_trade_size(double max_size);
     
+    // 数据新鲜度：价格统计距最新交易所时间戳超过 max_staleness_ms 时跳过本次决策，<= 0 表示不限制
+    void set_max_staleness_ms(long max_staleness_ms) { max_staleness_ms_ = max_staleness_ms; }
+    void set_freshness_tracker(std::shared_ptr<FreshnessTracker> tracker) { freshness_tracker_ = std::move(tracker); }
+    
     // 状态查询
     bool is_healthy() const;
     void print_status() const;
@@ -62,6 +81,8 @@ private:
     };
 
     // 内部方法
+    bool read_price_stats(PriceStatsRecord& stats, double& published_at_ms);
+    void record_freshness(const PriceStatsRecord& stats, double published_at_ms, double read_at_ms, double decided_at_ms);
     ArbitrageOpportunity analyze_price_stats_arbitrage(const PriceStatsRecord& stats);
     double calculate_net_profit_bps(double buy_price, double sell_price, 
                                     const std::string& buy_exchange, 
@@ -71,10 +92,14 @@ private:
 
     // 成员变量
     std::shared_ptr<RedisWriter> redis_client_;
+    std::shared_ptr<MarketDataCache> market_cache_;
+    std::shared_ptr<FreshnessTracker> freshness_tracker_;
+    const MarketDataCache::StatsSlot* stats_slot_;  // 构造时解析一次，之后直接读槽位
     std::string symbol_;
     
     // 策略参数
     double min_profit_bps_;
     double max_trade_size_;
+    long max_staleness_ms_;
 
 };
@@ -0,0 +1,172 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// 前向声明，避免包含 hiredis 头文件
+struct redisAsyncContext;
+struct redisReply;
+
+// 重用 TimescaleDB 的数据结构
+struct RawRecord;
+struct PriceStatsRecord;
+
+class RedisWriter;
+namespace market_codec {
+enum class ValueCodec;
+class InternTable;
+}
+
+/**
+ * 非阻塞 Redis 读写
+ * 基于 hiredis 异步接口和一个 epoll 事件循环线程：调用方只把命令放进队列就返回，
+ * 结果通过 future 或完成回调交付。事件循环每次把队列里的命令一起追加到连接的输出缓冲区，
+ * 未完成的命令自动 pipeline，不需要调用方攒批。
+ *
+ * 完成回调在事件循环线程上执行，应尽快返回，不要在回调里等待本对象的其他 future。
+ * 写入维护与 RedisWriter 相同的索引集合，按同样的配置追加 tick 流和变更通知；值编码通过 share_codec 与 RedisWriter 保持一致，
+ * 未共享时全部写 JSON。读取识别两种格式，本地 intern 表没有的 id 用一次 HMGET 补齐。
+ * 连接断开时未完成的命令以失败结束，事件循环每秒尝试重连一次。
+ */
+class AsyncRedisWriter {
+public:
+    // reply 为 nullptr 表示连接断开或命令未能发出；回调返回后 reply 由 hiredis 释放
+    using ReplyCallback = std::function<void(redisReply* reply)>;
+    using DoneCallback = std::function<void(bool success)>;
+    using RawCallback = std::function<void(bool success, const RawRecord& record)>;
+    using PriceStatsCallback = std::function<void(bool success, const PriceStatsRecord& record)>;
+
+    AsyncRedisWriter(const std::string& host = "127.0.0.1", int port = 6379, const std::string& password = "");
+    ~AsyncRedisWriter();
+
+    AsyncRedisWriter(const AsyncRedisWriter&) = delete;
+    AsyncRedisWriter& operator=(const AsyncRedisWriter&) = delete;
+
+    /**
+     * 启动事件循环线程并开始连接
+     * @return epoll / eventfd 创建失败时返回 false；连接本身是异步的，用 is_connected 查看
+     */
+    bool start();
+
+    /**
+     * 停止事件循环，未完成和排队中的命令以失败结束
+     */
+    void stop();
+
+    /**
+     * 采用 writer 的按前缀编码配置并共享它的 intern 表，两个写入者对同一个 key 写出同一种格式
+     * 应在 start 前调用；writer 之后再 set_codec 需要重新调用。
+     * 新名字的 id 由 writer 分配（需要同步访问 Redis），分配之前这条记录先写 JSON，读取端按首字节识别
+     */
+    void share_codec(const RedisWriter& writer);
+
+    bool is_running() const { return running_; }
+    bool is_connected() const { return connected_; }
+
+    // === 写入操作 ===
+    // 整批记录的 SETEX 和索引 SADD 一起入队，全部成功才算成功
+    std::future<bool> write_raw_records(const std::vector<RawRecord>& records);
+    void write_raw_records(const std::vector<RawRecord>& records, DoneCallback done);
+
+    std::future<bool> write_price_stats_records(const std::vector<PriceStatsRecord>& records);
+    void write_price_stats_records(const std::vector<PriceStatsRecord>& records, DoneCallback done);
+
+    // === 读取操作 ===
+    // future 版本把结果写入 record，调用方需保证 record 在 future 就绪前有效
+    std::future<bool> read_raw_record(const std::string& exchange, const std::string& symbol, RawRecord& record);
+    void read_raw_record(const std::string& exchange, const std::string& symbol, RawCallback done);
+
+    std::future<bool> read_price_stats_record(const std::string& symbol, PriceStatsRecord& record);
+    void read_price_stats_record(const std::string& symbol, PriceStatsCallback done);
+
+    // 任意命令，参数按二进制安全方式发送
+    void command(std::vector<std::string> args, ReplyCallback done);
+
+    // === 配置和监控 ===
+    void set_expire_time(int seconds) { expire_time_ = seconds; }
+    int get_expire_time() const { return expire_time_; }
+
+    // 与 RedisWriter 相同：raw 记录同时 XADD 到 tick 流，0 表示关闭（默认）
+    void set_tick_stream_max_len(size_t max_len) { tick_stream_max_len_ = max_len; }
+    size_t get_tick_stream_max_len() const { return tick_stream_max_len_; }
+
+    // 与 RedisWriter 相同：每条记录在 SETEX 之后 PUBLISH 一条变更事件，空字符串表示关闭（默认）。
+    // 应在开始写入前设置
+    void set_change_channel(const std::string& channel) { change_channel_ = channel; }
+    const std::string& get_change_channel() const { return change_channel_; }
+
+    // 已发出尚未收到回复的命令数
+    uint64_t in_flight() const { return in_flight_; }
+    // 累计完成的命令数和失败数（断开、错误回复）
+    uint64_t completed_count() const { return completed_count_; }
+    uint64_t failed_count() const { return failed_count_; }
+
+private:
+    struct Command {
+        std::vector<std::string> args;
+        ReplyCallback done;
+    };
+
+    // 事件循环线程
+    void event_loop();
+    void connect_async();
+    void drain_queue();
+    void fail_queue();
+    void update_events();
+    void submit(std::vector<Command> commands);
+
+    // 按 key 的编码配置序列化；二进制 key 缺少 intern id 时退回 JSON
+    std::string encode_raw_value(const std::string& key, const RawRecord& record) const;
+    std::string encode_price_stats_value(const std::string& key, const PriceStatsRecord& record) const;
+    // 本地 intern 表缺少的 id 用 HMGET 补齐，全部可解析时 done(true)
+    void resolve_ids(const std::vector<uint32_t>& ids, DoneCallback done);
+
+    // hiredis 回调（均在事件循环线程上执行）
+    static void on_reply(redisAsyncContext* ac, void* reply, void* privdata);
+    static void on_connect(const redisAsyncContext* ac, int status);
+    static void on_disconnect(const redisAsyncContext* ac, int status);
+    static void ev_add_read(void* privdata);
+    static void ev_del_read(void* privdata);
+    static void ev_add_write(void* privdata);
+    static void ev_del_write(void* privdata);
+    static void ev_cleanup(void* privdata);
+
+    std::string host_;
+    int port_;
+    std::string password_;
+    std::atomic<int> expire_time_;
+    std::atomic<size_t> tick_stream_max_len_;
+    std::string change_channel_;
+
+    // 值编码配置（start 前设置）和 intern 表
+    std::vector<std::pair<std::string, market_codec::ValueCodec>> codecs_;
+    std::shared_ptr<market_codec::InternTable> interned_;
+
+    // 只在事件循环线程访问
+    redisAsyncContext* context_;
+    int registered_fd_;      // 已加入 epoll 的 redis socket，-1 表示未注册
+    bool want_read_;
+    bool want_write_;
+    int64_t next_reconnect_ms_;
+
+    int epoll_fd_;
+    int wake_fd_;            // eventfd：入队后唤醒事件循环
+    std::thread loop_thread_;
+    std::atomic<bool> running_;
+    std::atomic<bool> connected_;
+
+    // 调用方线程入队，事件循环线程取走
+    std::mutex queue_mutex_;
+    std::vector<Command> queue_;
+
+    std::atomic<uint64_t> in_flight_;
+    std::atomic<uint64_t> completed_count_;
+    std::atomic<uint64_t> failed_count_;
+};
@@ -2,8 +2,20 @@
 #include "timescaledb_reader.h"
 #include "redis_writer.h"
 #include "scheduler.hpp"
+#include "pg_listener.h"
+#include "market_data_cache.h"
+#include "latency_histogram.h"
+#include "freshness_tracker.h"
+#include "market_data_codec.h"
 #include <memory>
 #include <chrono>
+#include <atomic>
+#include <mutex>
+#include <utility>
+#include <map>
+#include <cstdint>
+#include <thread>
+#include <condition_variable>
 
 class DataSyncService {
 public:
@@ -19,6 +31,7 @@ public:
     /**
      * 执行一次完整的数据同步（raw + stats）
      * 这是最常用的核心功能
+     * 单次流水线：查询 → 解码 → 发布缓存 → 序列化 → Redis pipeline，每个查询只执行一次
      */
     bool sync_once();
     
@@ -34,6 +47,54 @@ public:
      */
     bool sync_price_stats_data();
     
+    /**
+     * 请求一次全量重同步
+     * 下一次同步会清空高水位，重新扫描每个 (exchange, symbol) 的最新记录
+     */
+    void request_full_resync();
+    
+    /**
+     * 只同步指定的 (exchange, symbol)，以及有更新的价格统计
+     * NOTIFY 推送模式下由监听线程调用
+     */
+    bool sync_keys(const std::vector<std::pair<std::string, std::string>>& keys);
+    
+    // === 推送模式 ===
+    
+    /**
+     * 启动 LISTEN/NOTIFY 推送同步
+     * 在独立连接上监听 crypto_raw_prices 的写入通知（触发器见 sql/crypto_raw_prices_notify.sql），
+     * 收到通知立即同步受影响的 key。定时同步任务保留为兜底心跳。
+     * @return 监听连接建立失败时返回 false，此时只能依赖轮询
+     */
+    bool start_push_sync(const std::string& channel = "crypto_raw_prices_changed");
+    
+    /**
+     * 停止推送同步
+     */
+    void stop_push_sync();
+    
+    bool is_push_sync_running() const { return listener_ && listener_->is_running(); }
+    
+    // === 分片模式 ===
+    
+    /**
+     * 启用按 symbol 分片的并行同步
+     * symbol 按哈希分到 shard_count 个工作线程，每个线程有自己的 PG 和 Redis 连接和写入指纹，
+     * 独立同步自己的分片；sync_once 等周期同步并行驱动所有分片，统计汇总到 SyncStats。
+     * NOTIFY 定向同步把每个 key 交给拥有它的分片，用该分片的连接和指纹写入。
+     * @param shard_count 分片数，<= 1 等同于 disable_sharding
+     * @return 有分片的 Redis 连接建立失败时返回 false，此时保留原来的模式和分片不变
+     */
+    bool enable_sharding(int shard_count);
+    
+    /**
+     * 关闭分片模式，停止所有分片线程，回到主连接串行同步
+     */
+    void disable_sharding();
+    
+    int shard_count() const { return static_cast<int>(shards_.size()); }
+    
     // === 调度器功能 ===
     
     /**
@@ -55,6 +116,33 @@ public:
      */
     void schedule_sync_task(int interval_ms);
     
+    /**
+     * 添加 Redis 连接池健康检查任务
+     * @param pool 要检查的连接池（例如引擎共享的 Redis 客户端）
+     * @param interval_ms 间隔时间（毫秒），应小于连接池的空闲检查阈值
+     */
+    void schedule_redis_health_check(std::shared_ptr<RedisPool> pool, int interval_ms);
+
+    
+    /**
+     * 运行中调整定时同步的间隔，不重启调度器
+     * 行情剧烈时调快、平静时调慢；没有定时同步任务时返回 false
+     */
+    bool set_sync_interval(int interval_ms);
+    
+    /**
+     * 调度精度设置，在 start_scheduler 前调用
+     * @param cpu 调度线程绑定的 CPU，-1 表示不绑定
+     * @param high_resolution 到点前的最后一段自旋等待，降低唤醒抖动
+     */
+    void set_scheduler_timing(int cpu, bool high_resolution);
+    
+    /**
+     * 定时同步任务的调度统计：唤醒抖动、开始延迟的 p50/p99/max，overrun 次数
+     * 没有调用过 schedule_sync_task 时返回 false
+     */
+    bool get_sync_schedule_stats(SchedulerTaskStats& stats) const;
+    
     // === 配置和监控 ===
     
     /**
@@ -63,38 +151,202 @@ public:
      */
     void set_redis_expire_time(int seconds);
     
+    /**
+     * 设置 Redis 值编码（对主连接和所有分片生效）
+     * @param key_prefix key 前缀，例如 "crypto:raw:"
+     * @param codec JSON 给外部读者，BINARY 更小更快；读取端自动识别两种格式
+     */
+    void set_redis_codec(const std::string& key_prefix, market_codec::ValueCodec codec);
+    
+    /**
+     * 开启 Redis tick 流（对主连接和所有分片生效）
+     * 每条写入的 raw 记录同时追加到 crypto:stream:raw:<symbol>，消费者见 RedisWriter::read_ticks
+     * 增量写入只写内容变化的记录，所以流里是每一个新 tick，不含重复
+     * @param max_len 每个流保留的大约条数，0 表示关闭
+     */
+    void set_tick_stream_max_len(size_t max_len);
+    
+    /**
+     * 设置 Redis 变更通知频道（对主连接和所有分片生效），空字符串表示关闭
+     * 每条写入的记录 PUBLISH 一条事件，订阅端见 RedisChangeSubscriber
+     */
+    void set_change_channel(const std::string& channel);
+    
+    /**
+     * 开启原子快照模式：每个同步周期的 raw 和 stats 通过 RedisWriter::write_snapshot 一次提交，
+     * 读者用 RedisWriter::read_snapshot 一次读取一致的版本。
+     * 分片模式下每个分片各自提交快照；分片按 symbol 划分，同一 symbol 的 raw 和 stats 仍然一起可见
+     */
+    void set_snapshot_mode(bool enabled) { snapshot_mode_ = enabled; }
+    
+    /**
+     * 设置周期性全量重同步的间隔
+     * @param cycles 每隔多少次同步做一次全量扫描，<= 0 表示只在启动和手动请求时全量
+     * 全量同步兜住晚于回看窗口落库的记录；未变化的记录仍会被指纹过滤，不会重复写入
+     */
+    void set_full_resync_interval(int cycles) { full_resync_interval_ = cycles; }
+    
     /**
      * 检查服务健康状态
      * 主要检查 Redis 连接是否正常
      */
     bool is_healthy() const;
     
+    /**
+     * 设置进程内行情缓存
+     * 每次同步读到的新记录会先发布到缓存（即使 Redis 不可用），再写入 Redis
+     */
+    void set_market_data_cache(std::shared_ptr<MarketDataCache> cache);
+    
+    /**
+     * 设置数据新鲜度统计
+     * 每批写入成功的记录按 symbol 记录 交易所→读取、读取→写入 两个阶段的延迟
+     */
+    void set_freshness_tracker(std::shared_ptr<FreshnessTracker> tracker);
+    
     // === 统计信息 ===
     
+    // 分片模式下单个分片的统计
+    struct ShardStats {
+        int raw_records_synced = 0;
+        int price_stats_records_synced = 0;
+        int failed_sync_count = 0;
+        RollingHistogram total_us;        // 该分片每轮同步耗时
+    };
+    
     struct SyncStats {
         int raw_records_synced;           // 已同步的原始记录数
         int price_stats_records_synced;   // 已同步的统计记录数
         int total_sync_count;             // 总同步次数
         int failed_sync_count;            // 失败同步次数
+        int push_sync_count;              // 由 NOTIFY 触发的定向同步次数
+        int raw_records_skipped;          // 内容未变化、跳过写入的原始记录数
+        int price_stats_records_skipped;  // 内容未变化、跳过写入的统计记录数
+        int ttl_refresh_count;            // 只刷新 TTL 的 key 数
         std::chrono::system_clock::time_point last_sync_time;  // 最后同步时间
+        
+        // 每次同步各阶段耗时（微秒），保留最近 1024 次
+        RollingHistogram query_us;        // 数据库执行 + 结果传输
+        RollingHistogram decode_us;       // 结果解码 + 高水位过滤
+        RollingHistogram serialize_us;    // 序列化 + 追加 pipeline
+        RollingHistogram flush_us;        // Redis pipeline 发送与回复
+        RollingHistogram total_us;        // 整次同步
+        
+        // 分片模式下按分片下标排列；非分片模式为空。
+        // 分片模式下上面的阶段耗时取各分片中最慢的一个（关键路径），total_us 为整轮墙钟时间
+        std::vector<ShardStats> shards;
+        
+        // 跳过写入的记录占比
+        double skip_ratio() const {
+            long skipped = raw_records_skipped + price_stats_records_skipped;
+            long total = skipped + raw_records_synced + price_stats_records_synced;
+            return total > 0 ? static_cast<double>(skipped) / total : 0.0;
+        }
     };
     
     /**
      * 获取同步统计信息
      * 用于监控和调试
      */
-    SyncStats get_stats() const { return stats_; }
+    SyncStats get_stats() const;
 
 private:
+    // 每个 key 上次写入 Redis 时的指纹，内容不变的记录不再重复序列化和写入
+    struct Fingerprint {
+        long timestamp = 0;
+        uint64_t content_hash = 0;
+        std::chrono::steady_clock::time_point last_written;  // 上次写入或刷新 TTL 的时间
+    };
+    
+    // 一套独立的同步连接：reader/writer 不是线程安全的，指纹只描述经这个 writer 写入的 key
+    struct SyncContext {
+        std::unique_ptr<TimescaleDBReader> db_reader;
+        std::unique_ptr<RedisWriter> redis_writer;
+        std::map<std::pair<std::string, std::string>, Fingerprint> raw_fingerprints;  // (exchange, symbol)
+        std::map<std::string, Fingerprint> stats_fingerprints;                       // symbol
+    };
+    
+    // 一次同步流水线的数据和分阶段耗时
+    struct SyncBatch {
+        std::vector<RawRecord> raw;
+        std::vector<PriceStatsRecord> stats;
+        int raw_skipped = 0;
+        int stats_skipped = 0;
+        int ttl_refreshed = 0;
+        double read_at_ms = 0.0;  // 查询完成的时间（Unix 毫秒）
+        ReadTiming read;
+        RedisWriteTiming write;
+    };
+    
+    // 一个分片：自己的连接、工作线程和最近一轮的结果
+    struct SyncShard {
+        SyncContext context;
+        std::thread worker;
+        SyncBatch batch;
+        bool success = false;
+        double total_us = 0.0;
+    };
+    
+    // 一轮分片同步的参数
+    struct ShardRound {
+        bool include_raw = true;
+        bool include_stats = true;
+        bool full_resync = false;
+    };
+    
     // 核心组件
-    std::unique_ptr<TimescaleDBReader> db_reader_;
-    std::unique_ptr<RedisWriter> redis_writer_;
+    SyncContext primary_;
     std::unique_ptr<Scheduler> scheduler_;
+    SchedulerTaskHandle sync_task_;  // schedule_sync_task 注册的任务
+    SchedulerTaskHandle redis_health_task_;  // schedule_redis_health_check 注册的任务
+    std::unique_ptr<PgNotificationListener> listener_;
+    std::shared_ptr<MarketDataCache> market_cache_;
+    std::shared_ptr<FreshnessTracker> freshness_tracker_;
+    std::string db_conninfo_;
+    std::string redis_host_;
+    int redis_port_;
+    std::string redis_password_;
+    std::vector<std::pair<std::string, market_codec::ValueCodec>> redis_codecs_;  // 新建分片时沿用
+    
+    // 调度线程和监听线程都会同步，同一时间只有一次同步（一轮分片同步也算一次）
+    std::mutex sync_mutex_;
+    
+    // 分片工作线程：协调线程推进 shard_round_，等 shards_pending_ 归零
+    std::vector<std::unique_ptr<SyncShard>> shards_;
+    std::mutex shard_mutex_;
+    std::condition_variable shard_cv_;
+    std::condition_variable shard_done_cv_;
+    uint64_t shard_round_;
+    ShardRound round_;
+    int shards_pending_;
+    bool shards_stopping_;
     
     // 统计数据
     SyncStats stats_;
+    mutable std::mutex stats_mutex_;
+    
+    // 增量同步状态
+    std::atomic<bool> full_resync_requested_;
+    std::atomic<bool> snapshot_mode_;
+    int full_resync_interval_;
+    int cycles_since_full_resync_;
     
     // 内部辅助方法
     void reset_stats();
     void update_stats(bool success, int raw_count, int stats_count);
+    bool take_full_resync();
+    bool run_pipeline(bool include_raw, bool include_stats);
+    bool run_sharded(bool include_raw, bool include_stats, bool full_resync);
+    bool sync_context(SyncContext& ctx, bool include_raw, bool include_stats, SyncBatch& batch);
+    bool sync_keys_context(SyncContext& ctx, const std::vector<std::pair<std::string, std::string>>& keys, SyncBatch& batch);
+    bool sync_keys_sharded(const std::vector<std::pair<std::string, std::string>>& keys, SyncBatch& batch);
+    void shard_loop(SyncShard& shard, uint64_t seen_round);
+    void stop_shards();
+    bool deliver_batch(SyncContext& ctx, SyncBatch& batch);
+    void drop_unchanged(SyncContext& ctx, SyncBatch& batch);
+    bool refresh_due_ttls(SyncContext& ctx, SyncBatch& batch);
+    void remember_written(SyncContext& ctx, const SyncBatch& batch);
+    void record_batch(const SyncBatch& batch, bool success, double total_us);
+    static void log_batch(const SyncBatch& batch, bool success, double total_us, bool include_raw, bool include_stats);
+    static void add_read_timing(SyncBatch& batch, const ReadTiming& timing);
 };
\ No newline at end of file
@@ -12,7 +12,10 @@ public:
     bool start_session(const std::string& session_id);
     bool stop_session(const std::string& session_id);
     std::vector<std::string> get_all_sessions();
-    TradingSession* get_session(const std::string& session_id);
+    std::shared_ptr<TradingSession> get_session(const std::string& session_id);
+    std::map<std::string, FreshnessTracker::SymbolSummary> get_freshness_summary() const;
+    bool get_redis_cache_stats(RedisClientCache::Stats& stats) const;
+    bool set_sync_interval(int interval_ms);
     TradingEngineManager& get_engine();  // 暴露底层引用
 
 private:
@@ -0,0 +1,69 @@
+#pragma once
+#include "latency_histogram.h"
+#include "timescaledb_reader.h"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// 行情从交易所到策略决策经过的阶段
+enum class FreshnessStage {
+    EXCHANGE_TO_READ = 0,  // 交易所时间戳 → 同步服务从 TimescaleDB 读到（采集、落库、轮询间隔）
+    READ_TO_WRITE,         // 读到 → 发布缓存并写入 Redis 完成
+    WRITE_TO_STRATEGY,     // 发布 → 策略读取（只有从进程内缓存读到时才有）
+    READ_TO_DECISION,      // 策略读取 → 做出决策
+    END_TO_END,            // 交易所时间戳 → 决策
+};
+
+constexpr size_t FRESHNESS_STAGE_COUNT = 5;
+
+const char* freshness_stage_name(FreshnessStage stage);
+
+// 与 RawRecord::timestamp 同一时钟（Unix 毫秒），带小数部分
+inline double wall_clock_ms() {
+    return std::chrono::duration<double, std::milli>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * 数据新鲜度统计
+ * 按 symbol 记录行情在每个阶段上的延迟（毫秒），每个 (symbol, 阶段) 一个滚动直方图。
+ * 同步服务记录前两个阶段，策略记录后三个阶段。线程安全。
+ */
+class FreshnessTracker {
+public:
+    struct StageSummary {
+        uint64_t count = 0;
+        double p50 = 0.0;
+        double p99 = 0.0;
+        double max = 0.0;
+        double mean = 0.0;
+    };
+    using SymbolSummary = std::array<StageSummary, FRESHNESS_STAGE_COUNT>;
+
+    explicit FreshnessTracker(size_t window = 1024);
+
+    void record(const std::string& symbol, FreshnessStage stage, double latency_ms);
+
+    // 同步服务写完一批记录后调用，一次加锁记录 EXCHANGE_TO_READ 和 READ_TO_WRITE
+    void record_sync(const std::vector<RawRecord>& records, double read_at_ms, double written_at_ms);
+    void record_sync(const std::vector<PriceStatsRecord>& records, double read_at_ms, double written_at_ms);
+
+    // 各 symbol 各阶段的分位数快照，按 symbol 排序
+    std::map<std::string, SymbolSummary> summary() const;
+
+    void clear();
+
+private:
+    using StageHistograms = std::array<RollingHistogram, FRESHNESS_STAGE_COUNT>;
+    StageHistograms& histograms_for(const std::string& symbol);  // 调用方持有 mutex_
+
+    size_t window_;
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, StageHistograms> histograms_;
+};
@@ -0,0 +1,68 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * 滚动窗口延迟直方图
+ * 保留最近 capacity 个样本（单位由调用方决定，同一个直方图内保持一致），
+ * 按需排序计算分位数。记录是 O(1)，只在查询时排序。
+ * 非线程安全，由持有者加锁。
+ */
+class RollingHistogram {
+public:
+    explicit RollingHistogram(size_t capacity = 1024)
+        : capacity_(capacity > 0 ? capacity : 1), next_(0), total_count_(0) {}
+
+    void record(double value) {
+        if (samples_.size() < capacity_) {
+            samples_.push_back(value);
+        } else {
+            samples_[next_] = value;
+        }
+        next_ = (next_ + 1) % capacity_;
+        total_count_++;
+    }
+
+    // 窗口内样本数
+    size_t count() const { return samples_.size(); }
+    // 累计记录过的样本数
+    uint64_t total_count() const { return total_count_; }
+
+    // p 取值 [0, 100]；没有样本时返回 0
+    double percentile(double p) const {
+        if (samples_.empty()) return 0.0;
+        std::vector<double> sorted(samples_);
+        size_t rank = static_cast<size_t>(p / 100.0 * (sorted.size() - 1) + 0.5);
+        rank = std::min(rank, sorted.size() - 1);
+        std::nth_element(sorted.begin(), sorted.begin() + rank, sorted.end());
+        return sorted[rank];
+    }
+
+    double p50() const { return percentile(50.0); }
+    double p99() const { return percentile(99.0); }
+
+    double max() const {
+        return samples_.empty() ? 0.0 : *std::max_element(samples_.begin(), samples_.end());
+    }
+
+    double mean() const {
+        if (samples_.empty()) return 0.0;
+        double sum = 0.0;
+        for (double v : samples_) sum += v;
+        return sum / samples_.size();
+    }
+
+    void clear() {
+        samples_.clear();
+        next_ = 0;
+        total_count_ = 0;
+    }
+
+private:
+    size_t capacity_;
+    size_t next_;
+    uint64_t total_count_;
+    std::vector<double> samples_;
+};
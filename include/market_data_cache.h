@@ -0,0 +1,122 @@
+#pragma once
+#include "timescaledb_reader.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+// 单个 (exchange, symbol) 的最新行情，定长可平凡拷贝，exchange/symbol 由槽位的 key 表示
+struct RawQuote {
+    int id;
+    double last;
+    double bid;
+    double ask;
+    double high;
+    double low;
+    double volume;
+    long timestamp;
+    double read_at_ms;       // 同步服务从数据库读到的时间（Unix 毫秒），未知为 0
+    double published_at_ms;  // 发布到缓存的时间（Unix 毫秒）
+};
+
+// 单个 symbol 的最新价格统计，交易所名截断到定长数组
+struct StatsQuote {
+    int id;
+    double highest_price;
+    char highest_exchange[32];
+    double lowest_price;
+    char lowest_exchange[32];
+    int record_count;
+    long earliest_timestamp;
+    long latest_timestamp;
+    double read_at_ms;       // 同步服务从数据库读到的时间（Unix 毫秒），未知为 0
+    double published_at_ms;  // 发布到缓存的时间（Unix 毫秒）
+};
+
+/**
+ * seqlock 槽位
+ * 写者把序号改成奇数后写入、写完再加一（写者之间用 CAS 互斥）；
+ * 读者读前读后比较序号，不一致则重试。读者不加锁、不阻塞写者。
+ */
+template <typename T>
+class SeqlockSlot {
+    static_assert(std::is_trivially_copyable<T>::value, "SeqlockSlot requires a trivially copyable type");
+
+public:
+    void store(const T& value) {
+        uint64_t seq = seq_.load(std::memory_order_relaxed);
+        do {
+            while (seq & 1) seq = seq_.load(std::memory_order_relaxed);
+        } while (!seq_.compare_exchange_weak(seq, seq + 1, std::memory_order_acquire, std::memory_order_relaxed));
+        std::atomic_thread_fence(std::memory_order_release);
+        std::memcpy(&value_, &value, sizeof(T));
+        seq_.store(seq + 2, std::memory_order_release);
+    }
+
+    // 从未写入过时返回 false
+    bool load(T& out) const {
+        while (true) {
+            uint64_t before = seq_.load(std::memory_order_acquire);
+            if (before == 0) return false;
+            if (before & 1) continue;
+            std::memcpy(&out, &value_, sizeof(T));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (seq_.load(std::memory_order_relaxed) == before) return true;
+        }
+    }
+
+private:
+    alignas(64) std::atomic<uint64_t> seq_{0};
+    T value_{};
+};
+
+/**
+ * 进程内行情缓存
+ * DataSyncService 同步时发布，策略直接从内存读取，不经过 Redis。
+ * 每个品种一个 seqlock 槽位；槽位创建后地址不变，策略可以缓存槽位指针，
+ * 之后的读取只有一次 seqlock 拷贝。Redis 仍然是对外分发的通道。
+ */
+class MarketDataCache {
+public:
+    using RawSlot = SeqlockSlot<RawQuote>;
+    using StatsSlot = SeqlockSlot<StatsQuote>;
+
+    // === 发布（同步线程调用） ===
+    // read_at_ms 为记录从数据库读出的时间，和发布时间一起存进槽位，供策略统计数据新鲜度
+    void publish_raw(const RawRecord& record, double read_at_ms = 0.0);
+    void publish_raw(const std::vector<RawRecord>& records, double read_at_ms = 0.0);
+    void publish_price_stats(const PriceStatsRecord& record, double read_at_ms = 0.0);
+    void publish_price_stats(const std::vector<PriceStatsRecord>& records, double read_at_ms = 0.0);
+
+    // === 槽位查找 ===
+    // 不存在时创建空槽位，返回的指针在 cache 生命周期内有效
+    const RawSlot* raw_slot(const std::string& exchange, const std::string& symbol);
+    const StatsSlot* stats_slot(const std::string& symbol);
+
+    // === 便捷读取 ===
+    bool read_raw(const std::string& exchange, const std::string& symbol, RawRecord& record);
+    bool read_price_stats(const std::string& symbol, PriceStatsRecord& record);
+
+    // 槽位数据与记录之间的转换
+    static RawQuote to_quote(const RawRecord& record);
+    static StatsQuote to_quote(const PriceStatsRecord& record);
+    static void from_quote(const RawQuote& quote, const std::string& exchange, const std::string& symbol, RawRecord& record);
+    static void from_quote(const StatsQuote& quote, const std::string& symbol, PriceStatsRecord& record);
+
+    size_t raw_slot_count() const;
+    size_t stats_slot_count() const;
+
+private:
+    RawSlot* get_or_create_raw(const std::string& exchange, const std::string& symbol);
+    StatsSlot* get_or_create_stats(const std::string& symbol);
+
+    mutable std::shared_mutex mutex_;  // 只保护槽位表本身，不保护槽位内容
+    std::unordered_map<std::string, std::unique_ptr<RawSlot>> raw_slots_;
+    std::unordered_map<std::string, std::unique_ptr<StatsSlot>> stats_slots_;
+};
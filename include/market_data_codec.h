@@ -0,0 +1,187 @@
+#pragma once
+#include "timescaledb_reader.h"
+#include <endian.h>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Redis 行情值的编解码
+// JSON：给外部读者用的自描述格式
+// 二进制：定长布局，小端序，exchange/symbol 用 intern id 表示，首字节为格式版本。
+//   raw (70 字节):   version u8 | type u8 | exchange_id u32 | symbol_id u32 | id i32 |
+//                    last bid ask high low volume f64 | timestamp i64
+//   stats (54 字节): version u8 | type u8 | symbol_id u32 | id i32 | highest_price f64 |
+//                    highest_exchange_id u32 | lowest_price f64 | lowest_exchange_id u32 |
+//                    record_count i32 | earliest_timestamp i64 | latest_timestamp i64
+// JSON 总是以 '{' 开头，读取时按首字节区分两种格式
+namespace market_codec {
+
+enum class ValueCodec {
+    JSON,
+    BINARY
+};
+
+constexpr uint8_t BINARY_VERSION = 1;
+constexpr uint8_t TYPE_RAW = 1;
+constexpr uint8_t TYPE_PRICE_STATS = 2;
+constexpr size_t RAW_BINARY_SIZE = 70;
+constexpr size_t PRICE_STATS_BINARY_SIZE = 54;
+
+// 二进制解码结果，字符串字段保留为 intern id，由调用方解析
+struct RawBinary {
+    uint32_t exchange_id;
+    uint32_t symbol_id;
+    int32_t id;
+    double last;
+    double bid;
+    double ask;
+    double high;
+    double low;
+    double volume;
+    int64_t timestamp;
+};
+
+struct PriceStatsBinary {
+    uint32_t symbol_id;
+    int32_t id;
+    double highest_price;
+    uint32_t highest_exchange_id;
+    double lowest_price;
+    uint32_t lowest_exchange_id;
+    int32_t record_count;
+    int64_t earliest_timestamp;
+    int64_t latest_timestamp;
+};
+
+inline void put_u32(char*& p, uint32_t value) {
+    uint32_t v = htole32(value);
+    std::memcpy(p, &v, sizeof(v));
+    p += sizeof(v);
+}
+
+inline void put_u64(char*& p, uint64_t value) {
+    uint64_t v = htole64(value);
+    std::memcpy(p, &v, sizeof(v));
+    p += sizeof(v);
+}
+
+inline void put_f64(char*& p, double value) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    put_u64(p, bits);
+}
+
+inline uint32_t get_u32(const char*& p) {
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    p += sizeof(v);
+    return le32toh(v);
+}
+
+inline uint64_t get_u64(const char*& p) {
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    p += sizeof(v);
+    return le64toh(v);
+}
+
+inline double get_f64(const char*& p) {
+    uint64_t bits = get_u64(p);
+    double d;
+    std::memcpy(&d, &bits, sizeof(d));
+    return d;
+}
+
+inline bool is_binary(const char* data, size_t len) {
+    return len > 0 && static_cast<uint8_t>(data[0]) == BINARY_VERSION;
+}
+
+// === 二进制（不分配内存） ===
+// out 至少 RAW_BINARY_SIZE / PRICE_STATS_BINARY_SIZE 字节，返回写入的字节数
+size_t encode_raw(const RawRecord& record, uint32_t exchange_id, uint32_t symbol_id, char* out);
+size_t encode_price_stats(const PriceStatsRecord& record, uint32_t symbol_id,
+                          uint32_t highest_exchange_id, uint32_t lowest_exchange_id, char* out);
+// 版本、类型或长度不符时返回 false
+bool decode_raw(const char* data, size_t len, RawBinary& out);
+bool decode_price_stats(const char* data, size_t len, PriceStatsBinary& out);
+
+// === JSON ===
+// 数字用 std::to_chars 写出，与原先 ostringstream + std::fixed + setprecision(8) 的输出逐字节一致：
+// 浮点数固定 8 位小数，整数原样，字符串不转义
+constexpr int JSON_PRECISION = 8;
+// 一个定点浮点数最长的字符数：符号 + 309 位整数 + 小数点 + 8 位小数
+constexpr size_t JSON_DOUBLE_MAX = 1 + 309 + 1 + JSON_PRECISION;
+constexpr size_t JSON_INT_MAX = 20;
+
+// 编码结果长度的上限，用于预先分配缓冲区
+size_t raw_json_max_size(const RawRecord& record);
+size_t price_stats_json_max_size(const PriceStatsRecord& record);
+// 写入 out（至少 *_json_max_size 字节），返回写入的字节数，不分配内存
+size_t write_raw_json(const RawRecord& record, char* out);
+size_t write_price_stats_json(const PriceStatsRecord& record, char* out);
+
+std::string encode_raw_json(const RawRecord& record);
+std::string encode_price_stats_json(const PriceStatsRecord& record);
+// 解析失败返回 false
+bool decode_raw_json(const char* data, size_t len, RawRecord& out);
+bool decode_price_stats_json(const char* data, size_t len, PriceStatsRecord& out);
+
+// 按 key 前缀选择编码：最长前缀优先，未配置的 key 使用 JSON
+ValueCodec select_codec(const std::vector<std::pair<std::string, ValueCodec>>& prefixes, const std::string& key);
+
+/**
+ * 可复用的批量编码缓冲区
+ * 一批记录依次追加到同一块连续内存，返回每条值的 (offset, len)；clear() 只重置长度，
+ * 容量保留给下一批，稳定运行后不再分配。缓冲区扩容会移动数据，所以先编码完整批，再按 offset 取指针。
+ */
+// 值在 JsonWriter 缓冲区中的位置
+struct ValueSlice {
+    size_t offset;
+    size_t len;
+};
+
+class JsonWriter {
+public:
+    explicit JsonWriter(size_t capacity = 64 * 1024) : buffer_(capacity), size_(0) {}
+
+    void clear() { size_ = 0; }
+    size_t size() const { return size_; }
+    const char* data() const { return buffer_.data(); }
+    const char* data(const ValueSlice& slice) const { return buffer_.data() + slice.offset; }
+
+    ValueSlice append_raw(const RawRecord& record);
+    ValueSlice append_price_stats(const PriceStatsRecord& record);
+    // 已经编码好的值（二进制格式）原样追加
+    ValueSlice append_bytes(const char* bytes, size_t len);
+
+private:
+    char* reserve(size_t len);
+
+    std::vector<char> buffer_;
+    size_t size_;
+};
+
+/**
+ * exchange / symbol 名与 intern id 的双向映射（进程内缓存）
+ * id 的分配和持久化由 RedisWriter 负责，这里只做查表。线程安全，
+ * 可以由 RedisWriter 和 AsyncRedisWriter 共享。
+ */
+class InternTable {
+public:
+    bool find_id(const std::string& name, uint32_t& id) const;
+    // 返回的指针在表的生命周期内有效
+    const std::string* find_name(uint32_t id) const;
+    void insert(uint32_t id, const std::string& name);
+
+private:
+    mutable std::shared_mutex mutex_;
+    std::unordered_map<std::string, uint32_t> ids_;
+    std::unordered_map<uint32_t, std::string> names_;
+};
+
+} // namespace market_codec
@@ -2,6 +2,8 @@
 #include "redis_writer.h"
 #include "timescaledb_reader.h"
 #include "strategy_result.h"
+#include "market_data_cache.h"
+#include "freshness_tracker.h"
 
 #include <string>
 #include <memory>
@@ -11,7 +13,7 @@
 /**
  * 做市策略
  * 功能：
- * 1. 从 Redis 读取市场数据
+ * 1. 从进程内行情缓存读取市场数据（没有缓存数据时回退到 Redis）
  * 2. 计算公允价格和买卖价差
  * 3. 显示理论报价
  */
@@ -19,42 +21,58 @@ class MarketMakingStrategy {
 public:
     MarketMakingStrategy(std::shared_ptr<RedisWriter> redis_client,
                      const std::string& symbol,
-                     const std::string& exchange);
+                     const std::string& exchange,
+                     std::shared_ptr<MarketDataCache> market_cache = nullptr);
     
+    // 市场数据结构，同一 (exchange, symbol) 的多个会话共用一次读取
+    struct MarketData {
+        double bid = 0.0;
+        double ask = 0.0;
+        double last = 0.0;
+        bool is_valid = false;
+        long timestamp = 0;            // 交易所时间戳
+        double published_at_ms = 0.0;  // 发布到缓存的时间，从 Redis 读到时为 0
+        double read_at_ms = 0.0;       // 策略读到的时间
+        
+        double mid_price() const { return (bid + ask) / 2.0; }
+        double spread_bps() const { return (ask - bid) / mid_price() * 10000; }
+    };
+
     // 核心方法
     StrategyResult run_once();
+    // 使用调用方已经读好的数据，不再访问缓存或 Redis
+    StrategyResult run_once(const MarketData& market_data);
+    // 从缓存读取（没有时回退到 Redis），结果可以交给同一 (exchange, symbol) 的所有策略
+    MarketData get_market_data();
     
     // 配置方法
     void set_spread_bps(double spread_bps);
     void set_order_size(double size);
     
+    // 数据新鲜度：读到的行情距交易所时间戳超过 max_staleness_ms 时跳过本次决策，<= 0 表示不限制
+    void set_max_staleness_ms(long max_staleness_ms) { max_staleness_ms_ = max_staleness_ms; }
+    void set_freshness_tracker(std::shared_ptr<FreshnessTracker> tracker) { freshness_tracker_ = std::move(tracker); }
+    
     // 状态查询
     bool is_healthy() const;
     void print_status() const;
 
 private:
-    // 市场数据结构
-    struct MarketData {
-        double bid;
-        double ask;
-        double last;
-        bool is_valid;
-        
-        double mid_price() const { return (bid + ask) / 2.0; }
-        double spread_bps() const { return (ask - bid) / mid_price() * 10000; }
-    };
-    
     // 内部方法
-    MarketData get_market_data();
     void calculate_quotes(double fair_value, double& bid_price, double& ask_price);
+    void record_freshness(const MarketData& data, double decided_at_ms);
     // void print_quotes(double bid_price, double ask_price, const MarketData& market_data);
     std::string get_redis_key() const;
     
     // 成员变量
     std::shared_ptr<RedisWriter> redis_client_;
+    std::shared_ptr<MarketDataCache> market_cache_;
+    std::shared_ptr<FreshnessTracker> freshness_tracker_;
+    const MarketDataCache::RawSlot* raw_slot_;  // 构造时解析一次，之后直接读槽位
     std::string symbol_;
     std::string exchange_;
     double spread_bps_;
     double order_size_;
+    long max_staleness_ms_;
 
 };
\ No newline at end of file
@@ -0,0 +1,75 @@
+#pragma once
+#include "timescaledb_reader.h"
+#include <libpq-fe.h>
+#include <endian.h>
+#include <cstdint>
+#include <cstring>
+
+// libpq 二进制结果格式的解码工具
+// 所有字段按网络字节序（大端）传输，查询里显式转换为 int4 / int8 / float8 / text
+namespace pg_binary {
+
+// PostgreSQL 内置类型 OID
+constexpr Oid INT8_OID = 20;
+
+inline int32_t read_int4(const char* p) {
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return static_cast<int32_t>(be32toh(v));
+}
+
+inline int64_t read_int8(const char* p) {
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return static_cast<int64_t>(be64toh(v));
+}
+
+inline double read_float8(const char* p) {
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    v = be64toh(v);
+    double d;
+    std::memcpy(&d, &v, sizeof(d));
+    return d;
+}
+
+inline void write_int8(char* out, int64_t value) {
+    uint64_t v = htobe64(static_cast<uint64_t>(value));
+    std::memcpy(out, &v, sizeof(v));
+}
+
+// 定长列的安全读取：NULL 时取 0（与 Redis JSON 解码的缺省值一致），
+// 长度不符说明列类型和查询对不上，返回 false 由调用方丢弃整行
+inline bool get_int4(const PGresult* res, int row, int col, int32_t& out) {
+    if (PQgetisnull(res, row, col)) { out = 0; return true; }
+    if (PQgetlength(res, row, col) != 4) return false;
+    out = read_int4(PQgetvalue(res, row, col));
+    return true;
+}
+
+inline bool get_int8(const PGresult* res, int row, int col, int64_t& out) {
+    if (PQgetisnull(res, row, col)) { out = 0; return true; }
+    if (PQgetlength(res, row, col) != 8) return false;
+    out = read_int8(PQgetvalue(res, row, col));
+    return true;
+}
+
+inline bool get_float8(const PGresult* res, int row, int col, double& out) {
+    if (PQgetisnull(res, row, col)) { out = 0.0; return true; }
+    if (PQgetlength(res, row, col) != 8) return false;
+    out = read_float8(PQgetvalue(res, row, col));
+    return true;
+}
+
+// 按 raw 查询的列顺序解码一行：
+// id::int4, exchange::text, symbol::text, last..volume::float8, timestamp::int8
+// exchange / symbol / timestamp 为 NULL 或任一列长度不符时返回 false，调用方跳过该行
+bool decode_raw_row(const PGresult* res, int row, RawRecord& rec);
+
+// 按 stats 查询的列顺序解码一行：
+// id::int4, symbol::text, highest_price::float8, highest_exchange::text, lowest_price::float8,
+// lowest_exchange::text, record_count::int4, earliest_timestamp::int8, latest_timestamp::int8
+// symbol / latest_timestamp 为 NULL 或任一列长度不符时返回 false
+bool decode_price_stats_row(const PGresult* res, int row, PriceStatsRecord& rec);
+
+} // namespace pg_binary
@@ -0,0 +1,40 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <functional>
+#include <thread>
+#include <atomic>
+
+/**
+ * PostgreSQL LISTEN/NOTIFY 监听器
+ * 在独立的 libpq 连接和线程上 LISTEN 一个频道，
+ * 每次把已经到达的通知 payload 成批交给回调。
+ * 市场安静时只阻塞在 socket 上，不产生任何查询。
+ */
+class PgNotificationListener {
+public:
+    // payloads：本批收到的通知内容（已去重）
+    using Callback = std::function<void(const std::vector<std::string>& payloads)>;
+
+    PgNotificationListener(const std::string& conninfo, const std::string& channel);
+    ~PgNotificationListener();
+
+    // 建立连接并启动监听线程，连接失败返回 false
+    bool start(Callback callback);
+    void stop();
+
+    bool is_running() const { return running_; }
+
+private:
+    void run();
+    bool connect();
+    void disconnect();
+
+    std::string conninfo_;
+    std::string channel_;
+    void* conn_; // PGconn*
+
+    Callback callback_;
+    std::atomic<bool> running_;
+    std::thread thread_;
+};
@@ -0,0 +1,64 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <functional>
+#include <thread>
+#include <atomic>
+
+// 前向声明，避免包含 hiredis 头文件
+struct redisContext;
+
+// 一条行情变更：raw 记录按 (exchange, symbol)，统计记录只有 symbol
+struct MarketChangeEvent {
+    bool is_stats = false;
+    std::string exchange;  // 统计记录为空
+    std::string symbol;
+};
+
+/**
+ * Redis 变更通知订阅者
+ * 在独立的 Redis 连接和线程上 SUBSCRIBE RedisWriter::set_change_channel 设置的频道，
+ * 每次把已经到达的事件成批（去重）交给回调。没有变更时只阻塞在 socket 上。
+ * 断线期间的消息不会重放：订阅线程自动重连，并通过状态回调通知断开和恢复，
+ * 调用方据此在断线期间改为轮询，恢复后补一轮。
+ */
+class RedisChangeSubscriber {
+public:
+    using Callback = std::function<void(const std::vector<MarketChangeEvent>& events)>;
+    // 连接断开（false）或重新订阅成功（true）时在订阅线程上调用
+    using StateCallback = std::function<void(bool connected)>;
+
+    RedisChangeSubscriber(const std::string& host, int port, const std::string& password,
+                          const std::string& channel);
+    ~RedisChangeSubscriber();
+
+    // 建立连接并启动订阅线程，连接失败返回 false
+    bool start(Callback callback, StateCallback state_callback = nullptr);
+    void stop();
+
+    // 订阅线程在运行（包括断线重连期间）
+    bool is_running() const { return running_; }
+    // 订阅连接当前可用，断线重连期间为 false
+    bool is_connected() const { return connected_; }
+
+    // 解析 "raw:<exchange>:<symbol>" / "stats:<symbol>"，格式不对返回 false
+    static bool parse_payload(const std::string& payload, MarketChangeEvent& event);
+
+private:
+    void run();
+    bool connect();
+    void disconnect();
+    void set_connected(bool connected);
+
+    std::string host_;
+    int port_;
+    std::string password_;
+    std::string channel_;
+    redisContext* context_;
+
+    Callback callback_;
+    StateCallback state_callback_;
+    std::atomic<bool> running_;
+    std::atomic<bool> connected_;
+    std::thread thread_;
+};
@@ -0,0 +1,88 @@
+#pragma once
+#include <string>
+#include <unordered_map>
+#include <shared_mutex>
+#include <thread>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+#include "timescaledb_reader.h"  // RawRecord / PriceStatsRecord
+
+// 前向声明，避免包含 hiredis 头文件
+struct redisContext;
+struct redisReply;
+
+/**
+ * Redis 客户端缓存（RESP3 CLIENT TRACKING，广播模式）
+ * 独立连接上 HELLO 3 并对 crypto:raw: / crypto:stats: 前缀开启 BCAST 跟踪，
+ * 后台线程接收服务端推送的失效消息并删除本地条目。读取先查本地，未命中再由调用方读 Redis 后回填。
+ *
+ * 回填用 epoch 防止旧值覆盖：未命中时先取 epoch()，读完 Redis 后连同 epoch 一起 put，
+ * 期间发生过任何失效（epoch 变化）就放弃回填，保证本地不会留下已经失效的值。
+ * 失效连接断开时缓存整体失效并停止命中，重连并重新开启跟踪后恢复。
+ */
+class RedisClientCache {
+public:
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t invalidations = 0;   // 收到的失效 key 数
+        uint64_t flushes = 0;         // 整体清空次数（FLUSHALL、断线）
+        size_t entries = 0;
+
+        double hit_rate() const {
+            uint64_t total = hits + misses;
+            return total > 0 ? static_cast<double>(hits) / total : 0.0;
+        }
+    };
+
+    RedisClientCache(const std::string& host, int port, const std::string& password,
+                     size_t max_entries = 100000);
+    ~RedisClientCache();
+
+    // 建立失效连接并开启跟踪，Redis 不支持 RESP3（6.0 以前）时返回 false
+    bool start();
+    void stop();
+
+    // 跟踪连接正常、可以使用缓存
+    bool is_active() const { return active_; }
+
+    // 命中返回 true；未命中计入 misses
+    bool get_raw(const std::string& key, RawRecord& record);
+    bool get_price_stats(const std::string& key, PriceStatsRecord& record);
+
+    // 未命中前取的 epoch，回填时传回
+    uint64_t epoch() const;
+    void put_raw(const std::string& key, const RawRecord& record, uint64_t epoch);
+    void put_price_stats(const std::string& key, const PriceStatsRecord& record, uint64_t epoch);
+
+    Stats stats() const;
+
+private:
+    void run();
+    bool connect();
+    void disconnect();
+    void invalidate_all();
+    void handle_push(const redisReply* reply);
+
+    std::string host_;
+    int port_;
+    std::string password_;
+    size_t max_entries_;
+    redisContext* context_;
+
+    mutable std::shared_mutex mutex_;
+    uint64_t epoch_;  // 每次失效加一，受 mutex_ 保护
+    std::unordered_map<std::string, RawRecord> raw_;
+    std::unordered_map<std::string, PriceStatsRecord> stats_;
+
+    std::atomic<bool> active_;
+    std::atomic<bool> running_;
+    std::thread thread_;
+
+    std::atomic<uint64_t> hits_;
+    std::atomic<uint64_t> misses_;
+    std::atomic<uint64_t> invalidations_;
+    std::atomic<uint64_t> flushes_;
+};
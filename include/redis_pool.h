@@ -0,0 +1,112 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// 前向声明，避免包含 hiredis 头文件
+struct redisContext;
+
+/**
+ * Redis 连接池
+ * 固定数量的连接槽位，按需建立连接（懒连接）；借出时检查连接状态，
+ * 出错或空闲过久的连接先 PING，失败则重连。连接通过 Lease 借出，析构时自动归还；
+ * 归还时连接已出错（context->err）会被关闭，下次借出时重连。线程安全。
+ */
+class RedisPool {
+public:
+    // 借出的连接，只能移动；析构时归还给连接池
+    class Lease {
+    public:
+        Lease() : pool_(nullptr), context_(nullptr) {}
+        Lease(Lease&& other) noexcept : pool_(other.pool_), context_(other.context_) {
+            other.pool_ = nullptr;
+            other.context_ = nullptr;
+        }
+        Lease& operator=(Lease&& other) noexcept;
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+        ~Lease() { release(); }
+
+        redisContext* get() const { return context_; }
+        explicit operator bool() const { return context_ != nullptr; }
+
+        // 连接状态不可信（例如 pipeline 回复没有读完）时调用，归还时关闭连接
+        void invalidate();
+
+    private:
+        friend class RedisPool;
+        Lease(RedisPool* pool, redisContext* context) : pool_(pool), context_(context) {}
+        void release();
+
+        RedisPool* pool_;
+        redisContext* context_;
+    };
+
+    RedisPool(const std::string& host = "127.0.0.1", int port = 6379, const std::string& password = "",
+              size_t size = 4);
+    ~RedisPool();
+
+    RedisPool(const RedisPool&) = delete;
+    RedisPool& operator=(const RedisPool&) = delete;
+
+    /**
+     * 借出一个连接
+     * 所有连接都被占用时最多等待 timeout；连接建立失败或超时返回空 Lease
+     */
+    Lease acquire(std::chrono::milliseconds timeout = std::chrono::milliseconds(1000));
+
+    /**
+     * 逐个检查空闲连接：PING 失败的关闭重连，未建立的尝试补齐
+     * 每次只占用一个槽位，检查期间其余连接照常借出
+     * 由 DataSyncService::schedule_redis_health_check 定期调用
+     * @return 检查过且可用的连接数
+     */
+    size_t health_check();
+
+    // 最近一次建连或检查是否成功；不健康时每秒最多尝试重连一次，其余时候不发起网络请求
+    bool is_healthy();
+
+    size_t size() const { return size_; }
+    const std::string& host() const { return host_; }
+    int port() const { return port_; }
+    const std::string& password() const { return password_; }
+    size_t idle_count() const;
+    // 累计借出次数、等待过的借出次数、重连次数
+    uint64_t acquire_count() const { return acquire_count_; }
+    uint64_t wait_count() const { return wait_count_; }
+    uint64_t reconnect_count() const { return reconnect_count_; }
+
+    // 空闲超过该时间的连接借出前先 PING，默认 30 秒
+    void set_idle_check_after(std::chrono::milliseconds idle) { idle_check_after_ = idle; }
+
+private:
+    struct Slot {
+        redisContext* context = nullptr;  // nullptr 表示尚未连接或已关闭
+        std::chrono::steady_clock::time_point last_used;
+    };
+
+    redisContext* connect_one();
+    bool ping(redisContext* context);
+    void give_back(redisContext* context, bool broken);
+
+    std::string host_;
+    int port_;
+    std::string password_;
+    size_t size_;
+    std::chrono::milliseconds idle_check_after_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable available_;
+    std::vector<Slot> idle_;  // 空闲槽位（包括未连接的），借出时从尾部取
+
+    std::atomic<bool> healthy_;
+    std::atomic<int64_t> last_recover_ns_;  // 上次重连尝试（steady_clock 纳秒）
+    std::atomic<uint64_t> acquire_count_;
+    std::atomic<uint64_t> wait_count_;
+    std::atomic<uint64_t> reconnect_count_;
+};
@@ -2,18 +2,95 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <utility>
+#include <functional>
+#include <cstdint>
+#include <map>
+#include <mutex>
+
+#include <atomic>
+#include "redis_pool.h"
 
 // 前向声明，避免包含 hiredis 头文件
 struct redisContext;
+struct redisReply;
 
 // 重用 TimescaleDB 的数据结构
 struct RawRecord;
 struct PriceStatsRecord;
 
+class RedisClientCache;
+
+namespace market_codec {
+enum class ValueCodec;
+class InternTable;
+class JsonWriter;
+struct ValueSlice;
+}
+
+// key 命名和二级索引集合，RedisWriter 和 AsyncRedisWriter 共用。
+// 索引是数据 key 的集合，批量读取用 SSCAN + MGET，不再 KEYS 扫描整个 keyspace；
+// 集合本身不过期，成员对应的数据 key 过期后由读取时 MGET 得到 nil 再顺带清理
+namespace redis_keys {
+inline constexpr const char* RAW_INDEX = "crypto:idx:raw";
+inline constexpr const char* RAW_EXCHANGE_INDEX_PREFIX = "crypto:idx:raw:exchange:";
+inline constexpr const char* RAW_SYMBOL_INDEX_PREFIX = "crypto:idx:raw:symbol:";
+inline constexpr const char* STATS_INDEX = "crypto:idx:stats";
+
+// 二进制编码的 intern 表：名字 → id、id → 名字，以及 id 分配计数器
+inline constexpr const char* INTERN_IDS_KEY = "crypto:intern:ids";
+inline constexpr const char* INTERN_NAMES_KEY = "crypto:intern:names";
+inline constexpr const char* INTERN_NEXT_KEY = "crypto:intern:next";
+
+inline std::string raw_key(const std::string& exchange, const std::string& symbol) {
+    return "crypto:raw:" + exchange + ":" + symbol;
+}
+
+inline std::string price_stats_key(const std::string& symbol) {
+    return "crypto:stats:" + symbol;
+}
+
+// 按币种的 tick 流，所有交易所的记录按写入顺序排列
+inline std::string tick_stream_key(const std::string& symbol) {
+    return "crypto:stream:raw:" + symbol;
+}
+
+// tick 流条目只有一个字段，值为记录的 JSON
+inline constexpr const char* TICK_FIELD = "data";
+
+// 变更通知的默认频道和消息内容："raw:<exchange>:<symbol>" 或 "stats:<symbol>"
+inline constexpr const char* CHANGE_CHANNEL = "crypto:changes";
+
+inline std::string raw_change_payload(const std::string& exchange, const std::string& symbol) {
+    return "raw:" + exchange + ":" + symbol;
+}
+
+inline std::string price_stats_change_payload(const std::string& symbol) {
+    return "stats:" + symbol;
+}
+} // namespace redis_keys
+
+// 批量写入的分阶段耗时（微秒）
+struct RedisWriteTiming {
+    double serialize_us = 0.0;  // 序列化 + 追加到 pipeline 缓冲区
+    double flush_us = 0.0;      // 发送 pipeline 并读取全部回复
+};
+
+/**
+ * Redis 读写
+ * 每次操作从连接池借出一个连接，用完归还；多个线程可以同时读写，
+ * 只要连接池有空闲连接就不会互相等待。配置方法（set_codec 等）应在并发使用前调用。
+ */
 class RedisWriter {
 public:
-    RedisWriter(const std::string& host = "127.0.0.1", int port = 6379, const std::string& password = "");
+    // 自建连接池，pool_size 为连接数
+    RedisWriter(const std::string& host = "127.0.0.1", int port = 6379, const std::string& password = "",
+                size_t pool_size = 1);
+    // 与其他 RedisWriter 共享连接池
+    explicit RedisWriter(std::shared_ptr<RedisPool> pool);
     ~RedisWriter();
+    
+    std::shared_ptr<RedisPool> pool() const { return pool_; }
 
     // 连接状态检查
     bool is_connected() const;
@@ -22,37 +99,57 @@ public:
     // 写入单条 raw 记录
     bool write_raw_record(const RawRecord& record);
     
-    // 批量写入 raw 记录
-    bool write_raw_records(const std::vector<RawRecord>& records);
+    // 批量写入 raw 记录，timing 非空时累加分阶段耗时
+    bool write_raw_records(const std::vector<RawRecord>& records, RedisWriteTiming* timing = nullptr);
     
     // 写入单条 price stats 记录
     bool write_price_stats_record(const PriceStatsRecord& record);
     
-    // 批量写入 price stats 记录
-    bool write_price_stats_records(const std::vector<PriceStatsRecord>& records);
+    // 批量写入 price stats 记录，timing 非空时累加分阶段耗时
+    bool write_price_stats_records(const std::vector<PriceStatsRecord>& records, RedisWriteTiming* timing = nullptr);
+    
+    // 批量刷新已有 key 的过期时间（不重写数据），
+    // missing 返回 key 已不存在（过期或被删除）的下标，调用方需要重写这些记录
+    bool refresh_raw_ttl(const std::vector<std::pair<std::string, std::string>>& instruments,
+                         std::vector<size_t>& missing);
+    bool refresh_price_stats_ttl(const std::vector<std::string>& symbols, std::vector<size_t>& missing);
     
     // === 读取操作 ===
     // 读取单条 raw 记录
     bool read_raw_record(const std::string& exchange, const std::string& symbol, RawRecord& record);
     
+    // 批量读取走写入时维护的索引集合（crypto:idx:*）：SSCAN 分批取 key，每批一次 MGET。
+    // 索引不存在时退回 SCAN MATCH，都不会像 KEYS 一样阻塞 Redis
+    
     // 读取所有 raw 记录
     std::vector<RawRecord> read_all_raw_records();
     
     // 读取特定交易所的所有记录
     std::vector<RawRecord> read_raw_records_by_exchange(const std::string& exchange);
     
+    // 读取特定币种在所有交易所的记录
+    std::vector<RawRecord> read_raw_records_by_symbol(const std::string& symbol);
+    
     // 读取单条 price stats 记录
     bool read_price_stats_record(const std::string& symbol, PriceStatsRecord& record);
     
     // 读取所有 price stats 记录
     std::vector<PriceStatsRecord> read_all_price_stats_records();
     
+    // 批量读取：一次 MGET（一个往返）取回全部 key。结果按下标写入调用方的 records，
+    // records 不够长时才扩容，重复使用同一个缓冲区时不再分配；found[i] 表示第 i 个是否读到。
+    // 返回读到的条数，连接或命令失败返回 0
+    size_t read_raw_records(const std::vector<std::pair<std::string, std::string>>& instruments,
+                            std::vector<RawRecord>& records, std::vector<bool>& found);
+    size_t read_price_stats_records(const std::vector<std::string>& symbols,
+                                    std::vector<PriceStatsRecord>& records, std::vector<bool>& found);
+    
     // === 查询操作 ===
     // 检查 key 是否存在
     bool exists_raw_record(const std::string& exchange, const std::string& symbol);
     bool exists_price_stats_record(const std::string& symbol);
     
-    // 获取所有 raw 记录的 keys
+    // 获取所有 raw 记录的 keys（SCAN 游标遍历）
     std::vector<std::string> get_all_raw_keys();
     
     // 获取所有 price stats 记录的 keys
@@ -64,27 +161,165 @@ public:
     // === 管理操作 ===
     // 设置过期时间（秒）
     void set_expire_time(int seconds) { expire_time_ = seconds; }
+    int get_expire_time() const { return expire_time_; }
     
-    // 清理操作
+    // 按 key 前缀选择值的编码（见 market_data_codec.h），最长前缀优先，未配置的 key 使用 JSON。
+    // 例如 set_codec("crypto:raw:", ValueCodec::BINARY)；读取时按值的首字节自动识别格式，
+    // 切换编码不影响已写入的数据
+    void set_codec(const std::string& key_prefix, market_codec::ValueCodec codec);
+    
+    // 编码配置和 intern 表，AsyncRedisWriter::share_codec 用它们和本对象保持同一种格式
+    const std::vector<std::pair<std::string, market_codec::ValueCodec>>& codecs() const { return codecs_; }
+    std::shared_ptr<market_codec::InternTable> intern_table() const { return interned_; }
+    
+    // === 行情流（Redis Streams） ===
+    // latest-value key 只保留最新值，轮询慢于行情的消费者会漏掉中间的更新；
+    // tick 流按写入顺序保留每一条记录，供需要完整序列的指标（波动率、VWAP 等）使用
+    
+    /**
+     * 开启 tick 流：每条写入的 raw 记录同时 XADD 到 crypto:stream:raw:<symbol>，
+     * 在同一个 pipeline 里发送，用 MAXLEN ~ max_len 近似裁剪
+     * @param max_len 每个流保留的大约条数，0 表示关闭（默认）
+     */
+    void set_tick_stream_max_len(size_t max_len) { tick_stream_max_len_ = max_len; }
+    size_t get_tick_stream_max_len() const { return tick_stream_max_len_; }
+    
+    /**
+     * 读取 symbol 在 last_id 之后的 tick（XREAD），按流中的顺序追加到 ticks（条目 id, 记录）
+     * 读到数据后 last_id 更新为最后一条的 id，下次传回即可接着读；
+     * last_id 为 "$" 时先解析成流当前的最后一条，之后只读新写入的 tick
+     * @param block_ms > 0 时没有新数据最多阻塞这么久（期间占用一个连接），否则立即返回
+     * @return 命令失败返回 false；超时没有数据返回 true，ticks 不变
+     */
+    bool read_ticks(const std::string& symbol, std::string& last_id,
+                    std::vector<std::pair<std::string, RawRecord>>& ticks,
+                    size_t count = 100, int block_ms = 0);
+    
+    /**
+     * 创建消费组（XGROUP CREATE ... MKSTREAM），组已存在时也返回 true
+     * @param start_id "$" 只消费之后的 tick，"0" 从流中最早的 tick 开始
+     */
+    bool create_tick_group(const std::string& symbol, const std::string& group,
+                           const std::string& start_id = "$");
+    
+    /**
+     * 以 consumer 身份从消费组读取 tick（XREADGROUP），同组的多个消费者分摊 tick
+     * @param start_id ">" 读取未分配过的新 tick；"0" 重读本消费者已领取但未确认的 tick（重启后恢复用）
+     * 处理完成后用 ack_ticks 确认
+     */
+    bool read_tick_group(const std::string& symbol, const std::string& group, const std::string& consumer,
+                         std::vector<std::pair<std::string, RawRecord>>& ticks,
+                         size_t count = 100, int block_ms = 0, const std::string& start_id = ">");
+    
+    // 确认已处理的 tick（XACK）
+    bool ack_ticks(const std::string& symbol, const std::string& group, const std::vector<std::string>& ids);
+    
+    // === 客户端缓存 ===
+    /**
+     * 开启 RESP3 客户端缓存（见 redis_client_cache.h）：read_raw_record / read_price_stats_record
+     * 及其批量版本先查进程内缓存，Redis 推送失效消息前不再访问 Redis。
+     * 应在并发使用前调用；Redis 6 以前不支持，返回 false，读取照常走 Redis
+     */
+    bool enable_client_cache(size_t max_entries = 100000);
+    
+    // 未开启时为 nullptr；命中率等指标见 RedisClientCache::stats()
+    RedisClientCache* client_cache() const { return client_cache_.get(); }
+    
+    // === 原子快照 ===
+    // write_raw_records / write_price_stats_records 是两个独立的 pipeline，读者可能看到
+    // 新的统计和旧的 raw（或相反）。快照模式把一个同步周期的全部记录交给一个 Lua 脚本一次提交：
+    // 脚本内更新 latest-value key 和当前状态哈希，本周期的字段另存为版本增量 crypto:snapshot:d:<n>，
+    // 每隔 base_interval 个版本把状态复制成基础快照 crypto:snapshot:b:<n>，版本号单调递增。
+    // latest-value key 过期的字段同时从状态里删除，状态不会无限增长。
+    // 需要 Redis 6.2+（COPY）；脚本访问的数据 key 不在 KEYS 里，不支持集群模式。
+    
+    /**
+     * 原子提交一个周期的记录，version 非空时返回新快照的版本号
+     * 索引、tick 流和变更通知在快照提交后再发送，订阅者收到通知时快照已经可读
+     */
+    bool write_snapshot(const std::vector<RawRecord>& raw_records, const std::vector<PriceStatsRecord>& stats_records,
+                        uint64_t* version = nullptr, RedisWriteTiming* timing = nullptr);
+    
+    /**
+     * 一次调用读取一个完整快照（在一个 Lua 脚本里完成，不会读到两个版本的混合）
+     * 最新版本直接读状态哈希；历史版本由最近的基础快照加上之后的增量重建
+     * @param version 要读取的版本，0 表示最新
+     * @param snapshot_version 实际读到的版本
+     * @return 还没有快照或该版本已过期时返回 false
+     */
+    bool read_snapshot(uint64_t version, uint64_t& snapshot_version,
+                       std::vector<RawRecord>& raw_records, std::vector<PriceStatsRecord>& stats_records);
+    
+    // 版本增量的保留时间（秒），默认 300；基础快照保留两倍时间
+    void set_snapshot_retention(int seconds) { snapshot_retention_ = seconds; }
+    // 每隔多少个版本写一次基础快照，默认 20。越大单次提交越便宜，读取历史版本要应用的增量越多
+    void set_snapshot_base_interval(int versions) { snapshot_base_interval_ = versions > 0 ? versions : 1; }
+    
+    // === 变更通知（Pub/Sub） ===
+    /**
+     * 设置变更通知频道：每条写入的记录在同一个 pipeline 里 PUBLISH 一条轻量事件
+     * （见 redis_keys::raw_change_payload），订阅端据此只唤醒关心该品种的会话。
+     * PUBLISH 排在 SETEX 之后，订阅者收到通知时新值已经可读。空字符串表示关闭（默认）
+     */
+    void set_change_channel(const std::string& channel) { change_channel_ = channel; }
+    const std::string& get_change_channel() const { return change_channel_; }
+    
+    // 清理操作：SCAN 分批删除数据 key，并删除对应的索引集合
     bool clear_raw_data();
     bool clear_price_stats_data();
 
 private:
-    redisContext* context_;
-    int expire_time_;  // 数据过期时间，默认1小时
-    
-    // 内部辅助方法
-    bool connect();
-    void disconnect();
-    std::string serialize_raw_record(const RawRecord& record);
-    std::string serialize_price_stats_record(const PriceStatsRecord& record);
-    RawRecord deserialize_raw_record(const std::string& json_str);
-    PriceStatsRecord deserialize_price_stats_record(const std::string& json_str);
+    std::shared_ptr<RedisPool> pool_;
+    std::atomic<int> expire_time_;  // 数据过期时间，默认1小时
+    std::atomic<size_t> tick_stream_max_len_;  // tick 流长度上限，0 表示不写流
+    std::string change_channel_;               // 变更通知频道，空表示不发布
+    std::atomic<int> snapshot_retention_;      // 版本增量保留秒数
+    std::atomic<int> snapshot_base_interval_;  // 基础快照间隔（版本数）
+    
+    // Lua 脚本源码地址 → 服务端 SHA1，首次使用时 SCRIPT LOAD
+    std::map<const char*, std::string> script_shas_;
+    std::mutex script_mutex_;
+    
+    // 值编码：按 key 前缀选择；二进制格式的 exchange/symbol intern id 持久化在 Redis 哈希里
+    std::vector<std::pair<std::string, market_codec::ValueCodec>> codecs_;
+    std::shared_ptr<market_codec::InternTable> interned_;
+    std::unique_ptr<RedisClientCache> client_cache_;
+    
+    // 内部辅助方法，ctx 为调用方借出的连接
+    market_codec::ValueCodec codec_for(const std::string& key) const;
+    bool intern(redisContext* ctx, const std::string& name, uint32_t& id);
+    const std::string* resolve_name(redisContext* ctx, uint32_t id);
+    void intern_names(redisContext* ctx, const std::vector<RawRecord>& records);
+    void intern_names(redisContext* ctx, const std::vector<PriceStatsRecord>& records);
+    size_t append_raw_sets(redisContext* ctx, const std::vector<RawRecord>& records);
+    size_t append_price_stats_sets(redisContext* ctx, const std::vector<PriceStatsRecord>& records);
+    market_codec::ValueSlice encode_raw_value(const std::string& key, const RawRecord& record,
+                                                     market_codec::JsonWriter& out) const;
+    market_codec::ValueSlice encode_price_stats_value(const std::string& key, const PriceStatsRecord& record,
+                                                             market_codec::JsonWriter& out) const;
+    std::string script_sha(redisContext* ctx, const char* source, bool reload);
+    redisReply* eval_script(redisContext* ctx, const char* source, const std::vector<std::string>& args);
+    bool clear_snapshots(redisContext* ctx);
+    bool decode_raw_value(redisContext* ctx, const char* data, size_t len, RawRecord& record);
+    bool decode_price_stats_value(redisContext* ctx, const char* data, size_t len, PriceStatsRecord& record);
     std::string get_raw_key(const std::string& exchange, const std::string& symbol);
     std::string get_price_stats_key(const std::string& symbol);
+    bool expire_keys(redisContext* ctx, const std::vector<std::string>& keys, std::vector<size_t>& missing);
     
-    // 连接参数
-    std::string host_;
-    int port_;
-    std::string password_;
+    // 索引和游标遍历
+    size_t append_raw_index(redisContext* ctx, const std::vector<RawRecord>& records);
+    size_t append_price_stats_index(redisContext* ctx, const std::vector<PriceStatsRecord>& records);
+    size_t append_tick_streams(redisContext* ctx, const std::vector<RawRecord>& records);
+    size_t append_change_events(redisContext* ctx, const std::vector<RawRecord>& records);
+    size_t append_change_events(redisContext* ctx, const std::vector<PriceStatsRecord>& records);
+    bool drain_replies(redisContext* ctx, size_t count, const char* what);
+    bool scan_keys(redisContext* ctx, const std::string& index_key, const std::string& pattern,
+                   const std::function<void(const std::vector<std::string>&)>& on_batch);
+    bool mget(redisContext* ctx, const std::vector<std::string>& keys, std::vector<std::string>& values,
+              std::vector<size_t>& missing);
+    std::vector<std::string> still_missing(redisContext* ctx, const std::vector<std::string>& keys);
+    void prune_raw_index(redisContext* ctx, const std::vector<std::string>& candidates);
+    void prune_price_stats_index(redisContext* ctx, const std::vector<std::string>& candidates);
+    std::vector<RawRecord> read_raw_records_indexed(const std::string& index_key, const std::string& pattern);
+    bool delete_matching(redisContext* ctx, const std::string& pattern);
 };
\ No newline at end of file
@@ -3,31 +3,167 @@
 #include <functional>
 #include <chrono>
 #include <vector>
+#include <deque>
+#include <queue>
 #include <thread>
 #include <mutex>
 #include <condition_variable>
 #include <atomic>
+#include <cstdint>
+
+#include "latency_histogram.h"
 
 using namespace std;
 
+// 任务到点时上一次执行还没结束的处理方式
+enum class OverrunPolicy {
+    Skip,      // 丢弃这次触发
+    Coalesce,  // 合并成一次，上一次结束后立即补跑
+    Queue      // 逐次排队补跑（有上限），同一任务仍然串行执行
+};
+
+// 触发时间的计算方式
+enum class ScheduleMode {
+    FixedRate,  // 对齐到 addTask 时的起点：第 k 次在 epoch + k * interval，迟到不累积
+    FixedDelay  // 上一次执行结束后再等 interval，不会与自己重叠
+};
+
+// 单个任务的运行统计（微秒）
+// 抖动 = 调度线程实际醒来 - 计划触发时间；延迟 = 工作线程开始执行 - 计划触发时间（含排队）
+struct SchedulerTaskStats {
+    uint64_t runs = 0;
+    uint64_t overruns = 0;    // 到点时上一次还在执行的次数
+    uint64_t skipped = 0;     // 因 Skip 或排队已满被丢弃的触发
+    uint64_t coalesced = 0;   // 被合并掉的触发
+    uint64_t missedSlots = 0; // FixedRate 下调度线程醒来时已经错过、直接跳过的整周期
+    double jitterP50Us = 0.0;
+    double jitterP99Us = 0.0;
+    double jitterMaxUs = 0.0;
+    double latencyP50Us = 0.0;
+    double latencyP99Us = 0.0;
+    double latencyMaxUs = 0.0;
+    double lastDurationUs = 0.0;
+};
+
 struct SchedulerTask{
     function<void()>taskFn;
-    chrono::milliseconds interval; 
+    chrono::milliseconds interval;
     chrono::steady_clock::time_point nextRunTime;
+    OverrunPolicy policy = OverrunPolicy::Skip;
+    ScheduleMode mode = ScheduleMode::FixedRate;
+    chrono::steady_clock::time_point epoch;  // FixedRate 的对齐起点
+    uint64_t slot = 0;                        // FixedRate 下 nextRunTime = epoch + slot * interval
+
+    // 以下由 Scheduler 在 mtx 下维护
+    uint64_t token = 0;       // 全局唯一，防止旧句柄作用到复用了同一 id 的新任务
+    uint64_t generation = 0;  // 每次取消、暂停、改间隔加一，堆里旧代的条目出堆时丢弃
+    bool cancelled = false;
+    bool paused = false;
+    bool inFlight = false;
+    deque<chrono::steady_clock::time_point> pendingRuns;  // 等待补跑的计划触发时间
+    SchedulerTaskStats stats;
+    RollingHistogram jitterUs{256};
+    RollingHistogram latencyUs{256};
+};
+
+class Scheduler;
+
+/**
+ * addTask 返回的任务句柄，可拷贝。不能比创建它的 Scheduler 活得更久；
+ * 任务被取消或 Scheduler::stop() 之后，句柄上的操作都返回 false。
+ */
+class SchedulerTaskHandle{
+    public:
+        SchedulerTaskHandle() : scheduler(nullptr), taskId(0), token(0) {}
+        bool valid() const { return scheduler != nullptr; }
+        size_t id() const { return taskId; }
+
+        // 正在执行的那一次会跑完，之后不再触发
+        bool cancel();
+        // 暂停期间不触发；恢复后从恢复时刻重新开始计时
+        bool pause();
+        bool resume();
+        // 立即生效：下一次触发为 上一个计划触发点 + 新间隔，已经过了就马上触发
+        bool setInterval(int interval_ms);
+        bool getStats(SchedulerTaskStats& stats) const;
+    private:
+        friend class Scheduler;
+        SchedulerTaskHandle(Scheduler* owner, size_t id, uint64_t taskToken)
+            : scheduler(owner), taskId(id), token(taskToken) {}
+        Scheduler* scheduler;
+        size_t taskId;
+        uint64_t token;
 };
 
+/**
+ * 定时任务调度器
+ * 调度线程按最小堆取最早到期的任务，交给固定数量的工作线程执行；
+ * 同一任务同一时刻最多只在一个线程上执行，慢任务的重叠触发按 OverrunPolicy 处理，
+ * 线程数不随负载增长。FixedRate 任务的触发时间由起点和周期数算出，调度迟到不会累积成漂移。
+ * 取消、暂停、改间隔都是给任务换一代并按需压入一个新条目（O(log n)），旧条目出堆时按代号丢弃。
+ * 取消的任务槽位在执行结束后回收复用，代号延续递增，复用后旧条目仍然会被丢弃。
+ */
 class Scheduler{
     public:
-        Scheduler();
+        explicit Scheduler(size_t workerCount = 2);
         ~Scheduler();
         void start();
         void stop();
-        void addTask(const function<void()>& task, int interval_ms);
+        // 返回的句柄用于取消、暂停、改间隔和查询统计
+        SchedulerTaskHandle addTask(const function<void()>& task, int interval_ms,
+                                    OverrunPolicy policy = OverrunPolicy::Skip,
+                                    ScheduleMode mode = ScheduleMode::FixedRate);
+        size_t workerCount() const { return workerCountValue; }
+
+        // 以下在 start() 前调用
+        // 把调度线程绑定到指定 CPU，-1 表示不绑定
+        void setSchedulerCpu(int cpu) { schedulerCpu = cpu; }
+        // 高精度等待：条件变量睡到触发前 spinUs，剩余时间自旋，减少内核唤醒带来的抖动
+        void setHighResolutionWait(bool enabled, int spinUs = 200) {
+            highResolutionWait = enabled;
+            spinMicros = spinUs;
+        }
     private:
+        friend class SchedulerTaskHandle;
+
+        struct HeapEntry {
+            chrono::steady_clock::time_point due;
+            size_t taskId;
+            uint64_t generation;
+            bool operator>(const HeapEntry& other) const { return due > other.due; }
+        };
+        struct Job {
+            size_t taskId;
+            chrono::steady_clock::time_point due;
+        };
+
         void run();
-        vector<SchedulerTask>tasks;
+        void workerLoop();
+        void dispatch(size_t taskId, chrono::steady_clock::time_point due);
+        void scheduleNext(size_t taskId, chrono::steady_clock::time_point now);
+        void pinSchedulerThread();
+        void pushEntry(size_t taskId);
+        void releaseTask(size_t taskId);
+        SchedulerTask* findTask(size_t taskId, uint64_t token);
+        bool cancelTask(size_t taskId, uint64_t token);
+        bool pauseTask(size_t taskId, uint64_t token);
+        bool resumeTask(size_t taskId, uint64_t token);
+        bool setTaskInterval(size_t taskId, uint64_t token, int interval_ms);
+        bool getTaskStats(size_t taskId, uint64_t token, SchedulerTaskStats& stats);
+
+        size_t workerCountValue;
+        int schedulerCpu;
+        bool highResolutionWait;
+        int spinMicros;
+        uint64_t nextToken;
+        deque<SchedulerTask>tasks;  // deque 追加不移动已有元素，工作线程可以在锁外引用 taskFn
+        vector<size_t> freeIds;     // 已取消且不在执行中的槽位，addTask 优先复用，tasks 只随同时存在的任务数增长
+        priority_queue<HeapEntry, vector<HeapEntry>, greater<HeapEntry>> dueHeap;
+        deque<Job> jobs;
         thread schedulerThread;
+        vector<thread> workers;
         mutex mtx;
         condition_variable cv;
+        condition_variable jobCv;
         atomic<bool> running;
 };
@@ -6,4 +6,7 @@ struct StrategyResult {
     double profit = 0.0;
     int trades = 0;
     std::vector<std::string> logs;
+
+    bool skipped_stale = false;  // 数据超过最大允许延迟，本次没有做决策
+    double data_age_ms = 0.0;    // 读到数据时距交易所时间戳的毫秒数
 };
@@ -1,6 +1,9 @@
 #pragma once
 #include <string>
 #include <vector>
+#include <unordered_map>
+#include <utility>
+#include <functional>
 
 struct RawRecord {
     int id;
@@ -27,16 +30,97 @@ struct PriceStatsRecord {
     long latest_timestamp;
 };
 
+// 最近一次读取的分阶段耗时（微秒）
+struct ReadTiming {
+    double query_us = 0.0;   // 服务端执行 + 结果传输
+    double decode_us = 0.0;  // 二进制解码 + 高水位过滤
+};
+
+// 流式读取的统计信息
+struct RangeStreamStats {
+    long rows = 0;              // 交给回调的行数
+    long skipped = 0;           // 主键列为 NULL 或列长度不符而跳过的行数
+    double elapsed_ms = 0.0;    // 总耗时
+    double rows_per_sec = 0.0;  // 吞吐
+    bool completed = false;     // 是否读完整个区间（回调提前终止或出错时为 false）
+};
+
 class TimescaleDBReader {
 public:
-    TimescaleDBReader(const std::string& conninfo);
+    // 流式读取回调，返回 false 提前结束
+    using RawRecordCallback = std::function<bool(const RawRecord&)>;
+
+    // shard_count > 1 时只读取 (hashtext(symbol) & 0x7fffffff) % shard_count == shard_index 的 symbol，
+    // 影响 read_latest_* / read_incremental_*；定向读取和历史区间读取不受影响
+    TimescaleDBReader(const std::string& conninfo, int shard_index = 0, int shard_count = 1);
     ~TimescaleDBReader();
 
-    // 读取每个交易所、每个币种的最新 raw 记录
+    // 读取每个交易所、每个币种的最新 raw 记录（全表扫描，同时重建高水位）
     std::vector<RawRecord> read_latest_raw();
-    // 读取每个币种的最新 price 统计记录
+    // 读取每个币种的最新 price 统计记录（全表扫描，同时重建高水位）
     std::vector<PriceStatsRecord> read_latest_price_stats();
 
+    // === 增量读取 ===
+    // 只返回比各 (exchange, symbol) 高水位更新的记录；
+    // 查询带时间下界，TimescaleDB 可以跳过旧 chunk。没有高水位时退化为全量读取。
+    std::vector<RawRecord> read_incremental_raw();
+    // 只返回比各 symbol 高水位更新的统计记录
+    std::vector<PriceStatsRecord> read_incremental_price_stats();
+    // 只读取指定 (exchange, symbol) 的新记录，用于 NOTIFY 驱动的定向同步
+    std::vector<RawRecord> read_latest_raw_for(const std::vector<std::pair<std::string, std::string>>& keys);
+
+    // 清空高水位，下一次增量读取会做一次全量重同步
+    void reset_watermarks();
+
+    // === 历史区间流式读取 ===
+    // 按时间顺序流式读取 [start_ts, end_ts) 内的 raw 记录，逐行交给回调。
+    // 使用 libpq 单行模式，内存占用与区间大小无关；exchanges / symbols 为空表示不过滤。
+    // 回调拿到的记录在返回后会被复用，需要保留时自行拷贝。
+    bool stream_raw_range(long start_ts, long end_ts,
+                          const std::vector<std::string>& exchanges,
+                          const std::vector<std::string>& symbols,
+                          const RawRecordCallback& callback,
+                          RangeStreamStats* stats = nullptr);
+
+    // 并行读取 [start_ts, end_ts)：按 hypertable chunk 边界切分子区间，
+    // 在最多 connections 个独立连接上并发查询，结果按时间顺序合并到 out。
+    // 额外的连接在第一次调用时建立，之后复用。
+    bool fetch_raw_range_parallel(long start_ts, long end_ts,
+                                  const std::vector<std::string>& exchanges,
+                                  const std::vector<std::string>& symbols,
+                                  std::vector<RawRecord>& out,
+                                  int connections = 4);
+
+    // 最近一次 read_* 调用的分阶段耗时
+    const ReadTiming& last_read_timing() const { return last_read_timing_; }
+
+    // 增量查询的回看窗口（与 timestamp 列同单位，默认 60000 即 60 秒），
+    // 用于兜住稍晚落库、时间戳落后于全局高水位的记录
+    void set_incremental_lookback(long lookback) { lookback_ = lookback; }
+
 private:
+    std::string conninfo_;
+    std::string shard_filter_; // 分片过滤条件，不分片时为空
     void* conn_; // PGconn*
-}; 
\ No newline at end of file
+    std::vector<void*> pool_conns_; // 并行读取用的额外连接
+
+    // 高水位：key 为 "exchange:symbol"（raw）或 symbol（stats）
+    std::unordered_map<std::string, long> raw_watermarks_;
+    std::unordered_map<std::string, long> stats_watermarks_;
+    long raw_high_water_;
+    long stats_high_water_;
+    long lookback_;
+    ReadTiming last_read_timing_;
+
+    // 内部辅助方法
+    bool ensure_connection();
+    void* exec_prepared(const char* stmt_name, int n_params, const char* const* values,
+                        const int* lengths, const int* formats); // PGresult*
+    void* exec_prepared(const char* stmt_name, const long* param);
+    std::vector<RawRecord> decode_raw_result(void* res);
+    std::vector<std::pair<long, long>> plan_chunk_ranges(long start_ts, long end_ts, int fallback_pieces);
+    std::vector<RawRecord> query_raw(const char* stmt_name, const long* param);
+    std::vector<PriceStatsRecord> query_price_stats(const char* stmt_name, const long* param);
+    bool advance_raw_watermark(const RawRecord& rec);
+    bool advance_stats_watermark(const PriceStatsRecord& rec);
+};
@@ -6,10 +6,21 @@
 #include <memory>
 #include <thread>
 #include <chrono>
+#include <map>
+#include <set>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
 
 // 你项目中核心模块的头文件
 #include "redis_writer.h"
 #include "data_sync_service.h"
+#include "market_data_cache.h"
+#include "freshness_tracker.h"
+#include "redis_change_subscriber.h"
+#include "redis_client_cache.h"
+#include "scheduler.hpp"
+#include "work_stealing_pool.h"
 #include "market_making_strategy.h"
 #include "arbitrage_strategy.h"
 
@@ -41,23 +52,44 @@ struct ClientRequest {
     // 新增止盈 / 止损百分比（默认 10% / 5%）
     double take_profit_ratio = 0.10;  // 止盈（如 0.10 表示 +10%）
     double stop_loss_ratio = 0.05;    // 止损（如 0.05 表示 -5%）
+
+    // 行情超过该延迟（毫秒）时策略跳过本次决策，0 表示不限制
+    long max_staleness_ms = 0;
 };
 
 // 会话结构
 struct TradingSession {
     std::string session_id;
     ClientRequest request;
-    EngineStatus status;
+    std::atomic<EngineStatus> status;
 
     std::unique_ptr<MarketMakingStrategy> market_making_strategy;
     std::unique_ptr<ArbitrageStrategy> arbitrage_strategy;
 
-    double total_profit;
+    double total_profit;   // 两者只在持有 run_mutex 时读写
     int executed_trades;
     std::vector<std::string> log;
+    std::mutex log_mutex;  // log 由工作线程追加、HTTP 线程读取
 
     std::chrono::system_clock::time_point created_at;
-    std::chrono::system_clock::time_point last_update;
+    std::atomic<std::chrono::system_clock::time_point> last_update;  // 工作线程写入，分发线程清理时读取
+
+    // MIXED 会话同时属于套利组和做市组，执行时持有该锁，保证同一会话不与自己并发
+    std::mutex run_mutex;
+};
+
+// 品种组：同一轮里关心同一品种的会话共用一次行情读取。
+// 套利组按 symbol（价格统计），做市组按 (exchange, symbol)（raw 行情）
+struct InstrumentGroup {
+    bool arbitrage = false;
+    std::string exchange;  // 套利组为空
+    std::string symbol;
+    std::vector<std::shared_ptr<TradingSession>> sessions;  // 运行中的成员，受 sessions_mutex_ 保护
+
+    // 执行调度：同一组同一时刻只在一个线程上执行
+    std::atomic<bool> in_flight{false};
+    std::atomic<bool> rerun{false};  // 有新的触发，执行结束后再跑一次
+    SchedulerTaskHandle timer;       // 兜底定时触发，受 sessions_mutex_ 保护
 };
 
 // 引擎统计信息结构
@@ -93,14 +125,51 @@ public:
     bool remove_trading_session(const std::string& session_id);
 
     std::vector<std::string> get_active_sessions() const;
-    TradingSession* get_session(const std::string& session_id);
+    std::shared_ptr<TradingSession> get_session(const std::string& session_id);
+
+    // 每个 symbol 从交易所到策略决策各阶段的延迟分布
+    std::map<std::string, FreshnessTracker::SymbolSummary> get_freshness_summary() const;
+
+    // 策略读取 Redis 的客户端缓存命中情况，缓存未开启时返回 false
+    bool get_redis_cache_stats(RedisClientCache::Stats& stats) const;
+
+    // 运行中调整定时全量同步的间隔，引擎未启动时返回 false
+    bool set_sync_interval(int interval_ms);
 
 private:
-    // 主循环
+    // 订阅线程收集、分发线程取走的行情变更
+    struct PendingChanges {
+        std::set<std::pair<std::string, std::string>> raw;  // (exchange, symbol)
+        std::set<std::string> raw_symbols;                  // raw 变更涉及的 symbol
+        std::set<std::string> stats;                        // 统计记录变更的 symbol
+        
+        bool empty() const { return raw.empty() && stats.empty(); }
+    };
+    
+    // 分发循环：把受变更影响的品种组提交到线程池
     void trading_loop();
-    void execute_trading_session(TradingSession* session);
-    void execute_arbitrage_session(TradingSession* session);
-    void execute_market_making_session(TradingSession* session);
+    void on_market_changes(const std::vector<MarketChangeEvent>& events);
+    void on_subscriber_state(bool connected);
+    int group_timer_interval_ms() const;
+    
+    // 品种组；join_groups / leave_groups 由调用方持有 sessions_mutex_
+    void join_groups(const std::shared_ptr<TradingSession>& session,
+                     std::vector<std::shared_ptr<InstrumentGroup>>& created,
+                     std::vector<std::shared_ptr<InstrumentGroup>>& joined);
+    void leave_groups(const std::shared_ptr<TradingSession>& session);
+    void arm_group(const std::shared_ptr<InstrumentGroup>& group);
+    void submit_group(const std::shared_ptr<InstrumentGroup>& group);
+    void run_group(const std::shared_ptr<InstrumentGroup>& group);
+    
+    // 会话执行：行情由所在的组读好后传入，两者只传其一
+    void execute_trading_session(const std::shared_ptr<TradingSession>& session,
+                                 const ArbitrageStrategy::PriceStatsData* price_stats,
+                                 const MarketMakingStrategy::MarketData* market_data);
+    void fail_session(const std::shared_ptr<TradingSession>& session);
+    void execute_arbitrage_session(TradingSession* session, const ArbitrageStrategy::PriceStatsData& price_stats);
+    void execute_market_making_session(TradingSession* session, const MarketMakingStrategy::MarketData& market_data);
+    std::string check_profit_limits(TradingSession* session);
+    std::shared_ptr<TradingSession> find_session(const std::string& session_id) const;
 
     // 会话管理
     bool validate_client_request(const ClientRequest& request) const;
@@ -119,9 +188,30 @@ private:
     int max_sessions_;
 
     std::shared_ptr<RedisWriter> redis_client_;
+    std::shared_ptr<MarketDataCache> market_cache_;  // 同步服务发布、策略读取
+    std::shared_ptr<FreshnessTracker> freshness_tracker_;  // 同步服务和策略共同记录
     std::unique_ptr<DataSyncService> data_sync_service_;
-    std::unordered_map<std::string, std::unique_ptr<TradingSession>> trading_sessions_;
+    std::unique_ptr<RedisChangeSubscriber> change_subscriber_;
+    std::unordered_map<std::string, std::shared_ptr<TradingSession>> trading_sessions_;
+    mutable std::mutex sessions_mutex_;  // 保护会话表和品种组表；执行中的任务持有会话和组的 shared_ptr
+    std::map<std::string, std::shared_ptr<InstrumentGroup>> arbitrage_groups_;  // symbol -> 组
+    std::map<std::pair<std::string, std::string>, std::shared_ptr<InstrumentGroup>> market_making_groups_;  // (exchange, symbol) -> 组
+    bool groups_active_;  // start_engine 重建品种组后为 true，stop_engine 开始时置 false；受 sessions_mutex_ 保护
 
     EngineStats stats_;
+    std::mutex stats_mutex_;
     std::unique_ptr<std::thread> engine_thread_;
+    
+    // 品种组在工作窃取线程池上执行，由变更事件或每个组的定时器触发；每轮读一次行情，再依次执行组内会话，
+    // Redis 读取和解析随品种数增长，不随会话数增长。
+    // 订阅连接可用时定时器按 idle_heartbeat_ms_ 兜底（止盈止损、错过的通知），否则（包括断线重连期间）
+    // 按 trading_interval_ms_ 轮询；连接状态变化时调整所有组的定时器
+    std::unique_ptr<WorkStealingPool> session_pool_;
+    std::unique_ptr<Scheduler> session_timers_;
+    
+    // 事件驱动：订阅线程写入 pending_changes_ 并唤醒分发循环，只提交行情有变化的品种组
+    std::mutex wake_mutex_;
+    std::condition_variable wake_cv_;
+    PendingChanges pending_changes_;
+    int idle_heartbeat_ms_;
 };
@@ -0,0 +1,64 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * 工作窃取线程池
+ * 每个工作线程有自己的双端队列：本线程提交的任务压到队尾并从队尾取（LIFO，缓存友好），
+ * 外部线程提交的任务轮流分给各个队列；自己的队列空了就从其他队列的队首窃取（FIFO）。
+ * 一个慢任务只占住一个线程，其余任务会被别的线程偷走继续执行。
+ */
+class WorkStealingPool {
+public:
+    using Task = std::function<void()>;
+
+    struct Stats {
+        uint64_t executed = 0;
+        uint64_t stolen = 0;  // 从其他线程队列偷来执行的任务数
+    };
+
+    // thread_count 为 0 时取 CPU 核数
+    explicit WorkStealingPool(size_t thread_count = 0);
+    ~WorkStealingPool();
+
+    void start();
+    // 等正在执行的任务结束；队列里还没开始的任务直接丢弃
+    void stop();
+
+    // 未启动或已停止时返回 false
+    bool submit(Task task);
+
+    size_t thread_count() const { return queues_.size(); }
+    Stats stats() const;
+
+private:
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void worker_loop(size_t index);
+    bool pop_local(size_t index, Task& task);
+    bool steal(size_t thief, Task& task);
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues_;
+    std::vector<std::thread> threads_;
+    std::atomic<bool> running_;
+    std::atomic<size_t> next_queue_;  // 外部提交的轮转位置
+
+    // 空闲线程在这里睡眠；pending_ 为所有队列中的任务总数
+    std::mutex idle_mutex_;
+    std::condition_variable idle_cv_;
+    std::atomic<size_t> pending_;
+
+    std::atomic<uint64_t> executed_;
+    std::atomic<uint64_t> stolen_;
+};
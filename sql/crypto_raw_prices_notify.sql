@@ -0,0 +1,17 @@
+-- crypto_raw_prices 写入通知
+-- 每插入一行就在 crypto_raw_prices_changed 频道上 NOTIFY 一次 "exchange:symbol"，
+-- DataSyncService 据此只同步受影响的 key（见 DataSyncService::start_push_sync）。
+-- 同一事务内相同 payload 的 NOTIFY 会被 PostgreSQL 合并，批量插入不会放大通知数量。
+
+CREATE OR REPLACE FUNCTION notify_crypto_raw_prices_changed() RETURNS trigger AS $$
+BEGIN
+    PERFORM pg_notify('crypto_raw_prices_changed', NEW.exchange || ':' || NEW.symbol);
+    RETURN NULL;
+END;
+$$ LANGUAGE plpgsql;
+
+DROP TRIGGER IF EXISTS crypto_raw_prices_notify ON crypto_raw_prices;
+
+CREATE TRIGGER crypto_raw_prices_notify
+    AFTER INSERT ON crypto_raw_prices
+    FOR EACH ROW EXECUTE FUNCTION notify_crypto_raw_prices_changed();
@@ -5,8 +5,14 @@
 #include <algorithm>
 
 ArbitrageStrategy::ArbitrageStrategy(std::shared_ptr<RedisWriter> redis_client,
-                                     const std::string& symbol)
-    : redis_client_(redis_client), symbol_(symbol){
+                                     const std::string& symbol,
+                                     std::shared_ptr<MarketDataCache> market_cache)
+    : redis_client_(redis_client), market_cache_(market_cache), stats_slot_(nullptr), symbol_(symbol),
+      max_staleness_ms_(0) {
+    
+    if (market_cache_) {
+        stats_slot_ = market_cache_->stats_slot(symbol_);
+    }
     
     if (symbol == "BTC/USDT") {
         min_profit_bps_ = 20.0;
@@ -37,18 +43,20 @@ double ArbitrageStrategy::get_exchange_fee(const std::string& exchange) {
 }
 
 StrategyResult ArbitrageStrategy::run_once() {
+    return run_once(get_price_stats());
+}
+
+StrategyResult ArbitrageStrategy::run_once(const PriceStatsData& data) {
     StrategyResult result;
+    const PriceStatsRecord& stats_record = data.stats;
 
     std::ostringstream header;
     header << "\n=== Arbitrage Opportunity Scan ===";
     std::cout << header.str() << std::endl;
     result.logs.push_back(header.str());
 
-    PriceStatsRecord stats_record;
-    bool success = redis_client_->read_price_stats_record(symbol_, stats_record);
-    
-    if (!success) {
-        std::string msg1 = "Failed to read price stats from Redis for " + symbol_;
+    if (!data.is_valid) {
+        std::string msg1 = "Failed to read price stats for " + symbol_;
         std::string msg2 = "Make sure DataSyncService is running and syncing price stats";
 
         std::cout << msg1 << std::endl;
@@ -58,6 +66,17 @@ StrategyResult ArbitrageStrategy::run_once() {
         result.logs.push_back(msg2);
         return result;
     }
+    
+    result.data_age_ms = data.read_at_ms - stats_record.latest_timestamp;
+    if (max_staleness_ms_ > 0 && result.data_age_ms > max_staleness_ms_) {
+        std::ostringstream stale;
+        stale << "Price stats for " << symbol_ << " are stale (" << static_cast<long>(result.data_age_ms)
+              << "ms old, max " << max_staleness_ms_ << "ms), skipping this scan";
+        std::cout << stale.str() << std::endl;
+        result.logs.push_back(stale.str());
+        result.skipped_stale = true;
+        return result;
+    }
 
     std::ostringstream oss;
     oss << "Price Stats for " << symbol_ << ":\n"
@@ -70,6 +89,7 @@ StrategyResult ArbitrageStrategy::run_once() {
     result.logs.push_back(oss.str());
 
     ArbitrageOpportunity opportunity = analyze_price_stats_arbitrage(stats_record);
+    record_freshness(stats_record, data.published_at_ms, data.read_at_ms, wall_clock_ms());
 
     std::ostringstream summary;
     if (opportunity.is_profitable) {
@@ -95,6 +115,35 @@ StrategyResult ArbitrageStrategy::run_once() {
 
 
 
+ArbitrageStrategy::PriceStatsData ArbitrageStrategy::get_price_stats() {
+    PriceStatsData data;
+    data.is_valid = read_price_stats(data.stats, data.published_at_ms);
+    data.read_at_ms = wall_clock_ms();
+    return data;
+}
+
+// 优先读进程内缓存，缓存还没有数据时回退到 Redis（此时没有发布时间，published_at_ms 为 0）
+bool ArbitrageStrategy::read_price_stats(PriceStatsRecord& stats, double& published_at_ms) {
+    StatsQuote quote;
+    if (stats_slot_ && stats_slot_->load(quote)) {
+        MarketDataCache::from_quote(quote, symbol_, stats);
+        published_at_ms = quote.published_at_ms;
+        return true;
+    }
+    published_at_ms = 0.0;
+    return redis_client_ && redis_client_->read_price_stats_record(symbol_, stats);
+}
+
+void ArbitrageStrategy::record_freshness(const PriceStatsRecord& stats, double published_at_ms,
+                                         double read_at_ms, double decided_at_ms) {
+    if (!freshness_tracker_) return;
+    if (published_at_ms > 0) {
+        freshness_tracker_->record(symbol_, FreshnessStage::WRITE_TO_STRATEGY, read_at_ms - published_at_ms);
+    }
+    freshness_tracker_->record(symbol_, FreshnessStage::READ_TO_DECISION, decided_at_ms - read_at_ms);
+    freshness_tracker_->record(symbol_, FreshnessStage::END_TO_END, decided_at_ms - stats.latest_timestamp);
+}
+
 ArbitrageStrategy::ArbitrageOpportunity ArbitrageStrategy::analyze_price_stats_arbitrage(const PriceStatsRecord& stats) {
     ArbitrageOpportunity opportunity;
     opportunity.is_profitable = false;
@@ -196,7 +245,7 @@ void ArbitrageStrategy::set_max_trade_size(double max_size) {
 }
 
 bool ArbitrageStrategy::is_healthy() const {
-    return redis_client_ && redis_client_->is_connected();
+    return market_cache_ || (redis_client_ && redis_client_->is_connected());
 }
 
 void ArbitrageStrategy::print_status() const {
@@ -204,7 +253,8 @@ void ArbitrageStrategy::print_status() const {
     std::cout << "  Symbol: " << symbol_ << std::endl;
     std::cout << "  Min Profit: " << min_profit_bps_ << " bps" << std::endl;
     std::cout << "  Max Trade Size: $" << max_trade_size_ << std::endl;
-    std::cout << "  Redis Connected: " << (is_healthy() ? "YES" : "NO") << std::endl;
+    std::cout << "  Redis Connected: " << (redis_client_ && redis_client_->is_connected() ? "YES" : "NO") << std::endl;
+    std::cout << "  Market Cache: " << (market_cache_ ? "YES" : "NO") << std::endl;
 }
 
 std::string ArbitrageStrategy::get_redis_key(const std::string& exchange) const {
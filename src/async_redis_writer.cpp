@@ -0,0 +1,639 @@
+#include "async_redis_writer.h"
+#include "redis_writer.h"        // redis_keys
+#include "timescaledb_reader.h"  // 为了使用数据结构
+#include "market_data_codec.h"
+#include <hiredis/hiredis.h>
+#include <hiredis/async.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <memory>
+
+namespace {
+
+const int RECONNECT_INTERVAL_MS = 1000;
+const int MAX_EVENTS = 8;
+
+int64_t steady_ms() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+bool reply_ok(const redisReply* reply) {
+    return reply != nullptr && reply->type != REDIS_REPLY_ERROR;
+}
+
+// 一批命令共享的完成状态：最后一个回复到达时回调一次
+struct BatchState {
+    size_t remaining;
+    bool success = true;
+    AsyncRedisWriter::DoneCallback done;
+};
+
+AsyncRedisWriter::ReplyCallback count_reply(const std::shared_ptr<BatchState>& state) {
+    return [state](redisReply* reply) {
+        if (!reply_ok(reply)) state->success = false;
+        if (--state->remaining == 0 && state->done) state->done(state->success);
+    };
+}
+
+// 每个索引集合一条 SADD，和 RedisWriter 的索引维护一致
+template <typename Command>
+void add_index_commands(const std::map<std::string, std::vector<std::string>>& index_members,
+                        std::vector<Command>& commands) {
+    for (const auto& [index_key, members] : index_members) {
+        Command cmd;
+        cmd.args.reserve(members.size() + 2);
+        cmd.args.push_back("SADD");
+        cmd.args.push_back(index_key);
+        cmd.args.insert(cmd.args.end(), members.begin(), members.end());
+        commands.push_back(std::move(cmd));
+    }
+}
+
+// 二进制值里的 intern id 换成名字；调用前 resolve_ids 已经补齐本地表
+bool fill_raw(const market_codec::InternTable& table, const market_codec::RawBinary& bin, RawRecord& record) {
+    const std::string* exchange = table.find_name(bin.exchange_id);
+    const std::string* symbol = table.find_name(bin.symbol_id);
+    if (!exchange || !symbol) return false;
+
+    record.id = bin.id;
+    record.exchange = *exchange;
+    record.symbol = *symbol;
+    record.last = bin.last;
+    record.bid = bin.bid;
+    record.ask = bin.ask;
+    record.high = bin.high;
+    record.low = bin.low;
+    record.volume = bin.volume;
+    record.timestamp = bin.timestamp;
+    return true;
+}
+
+bool fill_price_stats(const market_codec::InternTable& table, const market_codec::PriceStatsBinary& bin,
+                      PriceStatsRecord& record) {
+    const std::string* symbol = table.find_name(bin.symbol_id);
+    const std::string* highest_exchange = table.find_name(bin.highest_exchange_id);
+    const std::string* lowest_exchange = table.find_name(bin.lowest_exchange_id);
+    if (!symbol || !highest_exchange || !lowest_exchange) return false;
+
+    record.id = bin.id;
+    record.symbol = *symbol;
+    record.highest_price = bin.highest_price;
+    record.highest_exchange = *highest_exchange;
+    record.lowest_price = bin.lowest_price;
+    record.lowest_exchange = *lowest_exchange;
+    record.record_count = bin.record_count;
+    record.earliest_timestamp = bin.earliest_timestamp;
+    record.latest_timestamp = bin.latest_timestamp;
+    return true;
+}
+
+} // namespace
+
+AsyncRedisWriter::AsyncRedisWriter(const std::string& host, int port, const std::string& password)
+    : host_(host), port_(port), password_(password), expire_time_(3600), tick_stream_max_len_(0),
+      interned_(std::make_shared<market_codec::InternTable>()),
+      context_(nullptr), registered_fd_(-1), want_read_(false), want_write_(false), next_reconnect_ms_(0),
+      epoll_fd_(-1), wake_fd_(-1), running_(false), connected_(false),
+      in_flight_(0), completed_count_(0), failed_count_(0) {}
+
+AsyncRedisWriter::~AsyncRedisWriter() {
+    stop();
+}
+
+void AsyncRedisWriter::share_codec(const RedisWriter& writer) {
+    codecs_ = writer.codecs();
+    interned_ = writer.intern_table();
+}
+
+bool AsyncRedisWriter::start() {
+    if (running_) return true;
+
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epoll_fd_ < 0 || wake_fd_ < 0) {
+        std::cerr << "AsyncRedisWriter: failed to create epoll/eventfd" << std::endl;
+        if (epoll_fd_ >= 0) close(epoll_fd_);
+        if (wake_fd_ >= 0) close(wake_fd_);
+        epoll_fd_ = wake_fd_ = -1;
+        return false;
+    }
+
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.fd = wake_fd_;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, &ev);
+
+    running_ = true;
+    loop_thread_ = std::thread(&AsyncRedisWriter::event_loop, this);
+    return true;
+}
+
+void AsyncRedisWriter::stop() {
+    {
+        // 与 submit 互斥：停止后入队的命令直接失败，不会留在队列里
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        if (!running_) return;
+        running_ = false;
+    }
+
+    uint64_t one = 1;
+    if (write(wake_fd_, &one, sizeof(one)) < 0) {
+        std::cerr << "AsyncRedisWriter: failed to wake event loop" << std::endl;
+    }
+    if (loop_thread_.joinable()) loop_thread_.join();
+
+    close(epoll_fd_);
+    close(wake_fd_);
+    epoll_fd_ = wake_fd_ = -1;
+}
+
+// === 事件循环 ===
+
+void AsyncRedisWriter::event_loop() {
+    connect_async();
+
+    epoll_event events[MAX_EVENTS];
+    while (running_) {
+        int timeout = -1;
+        if (context_ == nullptr) {
+            timeout = static_cast<int>(std::max<int64_t>(0, next_reconnect_ms_ - steady_ms()));
+        }
+
+        int n = epoll_wait(epoll_fd_, events, MAX_EVENTS, timeout);
+        if (n < 0 && errno != EINTR) {
+            std::cerr << "AsyncRedisWriter: epoll_wait failed, errno " << errno << std::endl;
+            break;
+        }
+
+        for (int i = 0; i < n; ++i) {
+            if (events[i].data.fd == wake_fd_) {
+                uint64_t count;
+                while (read(wake_fd_, &count, sizeof(count)) > 0) {}
+                drain_queue();
+                continue;
+            }
+            // 读写处理都可能释放连接（断开回调里置空 context_），每一步前重新检查
+            if (context_ && (events[i].events & (EPOLLIN | EPOLLERR | EPOLLHUP))) {
+                redisAsyncHandleRead(context_);
+            }
+            if (context_ && (events[i].events & EPOLLOUT)) {
+                redisAsyncHandleWrite(context_);
+            }
+        }
+
+        if (context_ == nullptr && running_ && steady_ms() >= next_reconnect_ms_) {
+            connect_async();
+        }
+    }
+
+    // redisAsyncFree 以空回复调用所有未完成命令的回调
+    if (context_) {
+        redisAsyncFree(context_);
+        context_ = nullptr;
+    }
+    connected_ = false;
+    fail_queue();
+}
+
+void AsyncRedisWriter::connect_async() {
+    next_reconnect_ms_ = steady_ms() + RECONNECT_INTERVAL_MS;
+
+    redisAsyncContext* ac = redisAsyncConnect(host_.c_str(), port_);
+    if (ac == nullptr || ac->err) {
+        if (ac) {
+            std::cerr << "Async Redis connection error: " << ac->errstr << std::endl;
+            redisAsyncFree(ac);
+        } else {
+            std::cerr << "Async Redis connection error: can't allocate redis context" << std::endl;
+        }
+        return;
+    }
+
+    // 先挂上事件回调，再设置连接回调（hiredis 在设置连接回调时注册第一个写事件）
+    context_ = ac;
+    ac->data = this;
+    ac->ev.data = this;
+    ac->ev.addRead = ev_add_read;
+    ac->ev.delRead = ev_del_read;
+    ac->ev.addWrite = ev_add_write;
+    ac->ev.delWrite = ev_del_write;
+    ac->ev.cleanup = ev_cleanup;
+    redisAsyncSetConnectCallback(ac, on_connect);
+    redisAsyncSetDisconnectCallback(ac, on_disconnect);
+
+    // 连接建立前发出的命令由 hiredis 缓存，AUTH 排在最前面
+    if (!password_.empty()) {
+        auto* done = new ReplyCallback([](redisReply* reply) {
+            if (!reply_ok(reply)) std::cerr << "Async Redis authentication failed" << std::endl;
+        });
+        in_flight_++;
+        if (redisAsyncCommand(ac, on_reply, done, "AUTH %s", password_.c_str()) != REDIS_OK) {
+            in_flight_--;
+            delete done;
+        }
+    }
+}
+
+void AsyncRedisWriter::drain_queue() {
+    std::vector<Command> commands;
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        commands.swap(queue_);
+    }
+
+    // 所有命令追加到同一个输出缓冲区，下一次可写事件一起发送
+    std::vector<const char*> argv;
+    std::vector<size_t> argvlen;
+    for (auto& cmd : commands) {
+        if (context_ == nullptr) {
+            failed_count_++;
+            if (cmd.done) cmd.done(nullptr);
+            continue;
+        }
+
+        argv.clear();
+        argvlen.clear();
+        for (const auto& arg : cmd.args) {
+            argv.push_back(arg.data());
+            argvlen.push_back(arg.size());
+        }
+
+        auto* done = new ReplyCallback(std::move(cmd.done));
+        in_flight_++;
+        if (redisAsyncCommandArgv(context_, on_reply, done, static_cast<int>(argv.size()),
+                                  argv.data(), argvlen.data()) != REDIS_OK) {
+            in_flight_--;
+            failed_count_++;
+            if (*done) (*done)(nullptr);
+            delete done;
+        }
+    }
+}
+
+void AsyncRedisWriter::fail_queue() {
+    std::vector<Command> commands;
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        commands.swap(queue_);
+    }
+    for (auto& cmd : commands) {
+        failed_count_++;
+        if (cmd.done) cmd.done(nullptr);
+    }
+}
+
+// 按 want_read_ / want_write_ 更新 redis socket 在 epoll 中的关注事件
+void AsyncRedisWriter::update_events() {
+    if (!want_read_ && !want_write_) {
+        if (registered_fd_ >= 0) {
+            epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, registered_fd_, nullptr);
+            registered_fd_ = -1;
+        }
+        return;
+    }
+    if (context_ == nullptr) return;
+
+    int fd = context_->c.fd;
+    epoll_event ev{};
+    ev.events = (want_read_ ? EPOLLIN : 0u) | (want_write_ ? EPOLLOUT : 0u);
+    ev.data.fd = fd;
+    if (registered_fd_ == fd) {
+        epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, fd, &ev);
+    } else {
+        if (registered_fd_ >= 0) epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, registered_fd_, nullptr);
+        epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev);
+        registered_fd_ = fd;
+    }
+}
+
+void AsyncRedisWriter::submit(std::vector<Command> commands) {
+    bool wake = false;
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        if (running_) {
+            // 队列非空说明已经唤醒过、事件循环还没取走，不必重复写 eventfd
+            wake = queue_.empty();
+            for (auto& cmd : commands) queue_.push_back(std::move(cmd));
+            commands.clear();
+        }
+    }
+
+    if (!commands.empty()) {
+        // 未启动或已停止
+        for (auto& cmd : commands) {
+            failed_count_++;
+            if (cmd.done) cmd.done(nullptr);
+        }
+        return;
+    }
+
+    if (wake) {
+        uint64_t one = 1;
+        if (write(wake_fd_, &one, sizeof(one)) < 0) {
+            std::cerr << "AsyncRedisWriter: failed to wake event loop" << std::endl;
+        }
+    }
+}
+
+// === hiredis 回调 ===
+
+void AsyncRedisWriter::on_reply(redisAsyncContext* ac, void* reply, void* privdata) {
+    auto* self = static_cast<AsyncRedisWriter*>(ac->data);
+    auto* done = static_cast<ReplyCallback*>(privdata);
+    auto* r = static_cast<redisReply*>(reply);
+
+    self->in_flight_--;
+    self->completed_count_++;
+    if (!reply_ok(r)) self->failed_count_++;
+
+    if (*done) (*done)(r);
+    delete done;
+}
+
+void AsyncRedisWriter::on_connect(const redisAsyncContext* ac, int status) {
+    auto* self = static_cast<AsyncRedisWriter*>(ac->data);
+    if (status != REDIS_OK) {
+        // 连接失败时 hiredis 随后释放 context，不会再调用断开回调
+        std::cerr << "Async Redis connection error: " << ac->errstr << std::endl;
+        self->context_ = nullptr;
+        self->connected_ = false;
+        return;
+    }
+    self->connected_ = true;
+    std::cout << "Async Redis connected" << std::endl;
+}
+
+void AsyncRedisWriter::on_disconnect(const redisAsyncContext* ac, int status) {
+    auto* self = static_cast<AsyncRedisWriter*>(ac->data);
+    if (status != REDIS_OK) {
+        std::cerr << "Async Redis disconnected: " << ac->errstr << std::endl;
+    }
+    self->context_ = nullptr;
+    self->connected_ = false;
+    self->next_reconnect_ms_ = steady_ms() + RECONNECT_INTERVAL_MS;
+}
+
+void AsyncRedisWriter::ev_add_read(void* privdata) {
+    auto* self = static_cast<AsyncRedisWriter*>(privdata);
+    self->want_read_ = true;
+    self->update_events();
+}
+
+void AsyncRedisWriter::ev_del_read(void* privdata) {
+    auto* self = static_cast<AsyncRedisWriter*>(privdata);
+    self->want_read_ = false;
+    self->update_events();
+}
+
+void AsyncRedisWriter::ev_add_write(void* privdata) {
+    auto* self = static_cast<AsyncRedisWriter*>(privdata);
+    self->want_write_ = true;
+    self->update_events();
+}
+
+void AsyncRedisWriter::ev_del_write(void* privdata) {
+    auto* self = static_cast<AsyncRedisWriter*>(privdata);
+    self->want_write_ = false;
+    self->update_events();
+}
+
+void AsyncRedisWriter::ev_cleanup(void* privdata) {
+    auto* self = static_cast<AsyncRedisWriter*>(privdata);
+    self->want_read_ = false;
+    self->want_write_ = false;
+    self->update_events();
+}
+
+// === 编解码 ===
+
+std::string AsyncRedisWriter::encode_raw_value(const std::string& key, const RawRecord& record) const {
+    uint32_t exchange_id, symbol_id;
+    if (market_codec::select_codec(codecs_, key) == market_codec::ValueCodec::BINARY &&
+        interned_->find_id(record.exchange, exchange_id) && interned_->find_id(record.symbol, symbol_id)) {
+        std::string value(market_codec::RAW_BINARY_SIZE, '\0');
+        value.resize(market_codec::encode_raw(record, exchange_id, symbol_id, &value[0]));
+        return value;
+    }
+    return market_codec::encode_raw_json(record);
+}
+
+std::string AsyncRedisWriter::encode_price_stats_value(const std::string& key, const PriceStatsRecord& record) const {
+    uint32_t symbol_id, highest_id, lowest_id;
+    if (market_codec::select_codec(codecs_, key) == market_codec::ValueCodec::BINARY &&
+        interned_->find_id(record.symbol, symbol_id) &&
+        interned_->find_id(record.highest_exchange, highest_id) &&
+        interned_->find_id(record.lowest_exchange, lowest_id)) {
+        std::string value(market_codec::PRICE_STATS_BINARY_SIZE, '\0');
+        value.resize(market_codec::encode_price_stats(record, symbol_id, highest_id, lowest_id, &value[0]));
+        return value;
+    }
+    return market_codec::encode_price_stats_json(record);
+}
+
+void AsyncRedisWriter::resolve_ids(const std::vector<uint32_t>& ids, DoneCallback done) {
+    std::vector<std::string> args{"HMGET", redis_keys::INTERN_NAMES_KEY};
+    std::vector<uint32_t> missing;
+    for (uint32_t id : ids) {
+        if (interned_->find_name(id) == nullptr) {
+            missing.push_back(id);
+            args.push_back(std::to_string(id));
+        }
+    }
+    if (missing.empty()) {
+        done(true);
+        return;
+    }
+
+    std::vector<Command> commands;
+    commands.push_back(Command{std::move(args),
+        [interned = interned_, missing = std::move(missing), done = std::move(done)](redisReply* reply) {
+            bool success = reply != nullptr && reply->type == REDIS_REPLY_ARRAY && reply->elements == missing.size();
+            for (size_t i = 0; success && i < missing.size(); ++i) {
+                const redisReply* name = reply->element[i];
+                if (name->type != REDIS_REPLY_STRING) {
+                    success = false;
+                    break;
+                }
+                interned->insert(missing[i], std::string(name->str, name->len));
+            }
+            done(success);
+        }});
+    submit(std::move(commands));
+}
+
+// === 写入操作 ===
+
+void AsyncRedisWriter::write_raw_records(const std::vector<RawRecord>& records, DoneCallback done) {
+    if (records.empty()) {
+        if (done) done(true);
+        return;
+    }
+
+    std::vector<Command> commands;
+    commands.reserve(records.size() * 3 + 3);
+    std::string expire = std::to_string(expire_time_.load());
+    size_t max_len = tick_stream_max_len_;
+    std::string max_len_arg = std::to_string(max_len);
+    std::map<std::string, std::vector<std::string>> index_members;
+    std::vector<Command> events;
+    for (const auto& record : records) {
+        std::string key = redis_keys::raw_key(record.exchange, record.symbol);
+        if (max_len > 0) {
+            // 与 RedisWriter 相同：流里总是 JSON，MAXLEN ~ 近似裁剪
+            events.push_back(Command{{"XADD", redis_keys::tick_stream_key(record.symbol), "MAXLEN", "~", max_len_arg,
+                                      "*", redis_keys::TICK_FIELD, market_codec::encode_raw_json(record)}, nullptr});
+        }
+        if (!change_channel_.empty()) {
+            events.push_back(Command{{"PUBLISH", change_channel_,
+                                      redis_keys::raw_change_payload(record.exchange, record.symbol)}, nullptr});
+        }
+        commands.push_back(Command{{"SETEX", key, expire, encode_raw_value(key, record)}, nullptr});
+        index_members[redis_keys::RAW_EXCHANGE_INDEX_PREFIX + record.exchange].push_back(key);
+        index_members[redis_keys::RAW_SYMBOL_INDEX_PREFIX + record.symbol].push_back(key);
+        index_members[redis_keys::RAW_INDEX].push_back(std::move(key));
+    }
+    add_index_commands(index_members, commands);
+    // 排在 SETEX 之后，订阅者收到通知时新值已经可读
+    std::move(events.begin(), events.end(), std::back_inserter(commands));
+
+    auto state = std::make_shared<BatchState>();
+    state->remaining = commands.size();
+    state->done = std::move(done);
+    for (auto& cmd : commands) cmd.done = count_reply(state);
+    submit(std::move(commands));
+}
+
+std::future<bool> AsyncRedisWriter::write_raw_records(const std::vector<RawRecord>& records) {
+    auto promise = std::make_shared<std::promise<bool>>();
+    std::future<bool> result = promise->get_future();
+    write_raw_records(records, [promise](bool success) { promise->set_value(success); });
+    return result;
+}
+
+void AsyncRedisWriter::write_price_stats_records(const std::vector<PriceStatsRecord>& records, DoneCallback done) {
+    if (records.empty()) {
+        if (done) done(true);
+        return;
+    }
+
+    std::vector<Command> commands;
+    commands.reserve(records.size() * 2 + 1);
+    std::string expire = std::to_string(expire_time_.load());
+    std::map<std::string, std::vector<std::string>> index_members;
+    for (const auto& record : records) {
+        std::string key = redis_keys::price_stats_key(record.symbol);
+        commands.push_back(Command{{"SETEX", key, expire, encode_price_stats_value(key, record)}, nullptr});
+        index_members[redis_keys::STATS_INDEX].push_back(std::move(key));
+    }
+    add_index_commands(index_members, commands);
+    if (!change_channel_.empty()) {
+        for (const auto& record : records) {
+            commands.push_back(Command{{"PUBLISH", change_channel_,
+                                        redis_keys::price_stats_change_payload(record.symbol)}, nullptr});
+        }
+    }
+
+    auto state = std::make_shared<BatchState>();
+    state->remaining = commands.size();
+    state->done = std::move(done);
+    for (auto& cmd : commands) cmd.done = count_reply(state);
+    submit(std::move(commands));
+}
+
+std::future<bool> AsyncRedisWriter::write_price_stats_records(const std::vector<PriceStatsRecord>& records) {
+    auto promise = std::make_shared<std::promise<bool>>();
+    std::future<bool> result = promise->get_future();
+    write_price_stats_records(records, [promise](bool success) { promise->set_value(success); });
+    return result;
+}
+
+// === 读取操作 ===
+
+void AsyncRedisWriter::read_raw_record(const std::string& exchange, const std::string& symbol, RawCallback done) {
+    std::vector<Command> commands;
+    commands.push_back(Command{{"GET", redis_keys::raw_key(exchange, symbol)},
+        [this, done = std::move(done)](redisReply* reply) {
+            RawRecord record{};
+            if (reply == nullptr || reply->type != REDIS_REPLY_STRING) {
+                done(false, record);
+                return;
+            }
+            if (!market_codec::is_binary(reply->str, reply->len)) {
+                done(market_codec::decode_raw_json(reply->str, reply->len, record), record);
+                return;
+            }
+            market_codec::RawBinary bin;
+            if (!market_codec::decode_raw(reply->str, reply->len, bin)) {
+                done(false, record);
+                return;
+            }
+            resolve_ids({bin.exchange_id, bin.symbol_id}, [this, bin, done](bool resolved) {
+                RawRecord record{};
+                bool success = resolved && fill_raw(*interned_, bin, record);
+                done(success, record);
+            });
+        }});
+    submit(std::move(commands));
+}
+
+std::future<bool> AsyncRedisWriter::read_raw_record(const std::string& exchange, const std::string& symbol,
+                                                    RawRecord& record) {
+    auto promise = std::make_shared<std::promise<bool>>();
+    std::future<bool> result = promise->get_future();
+    read_raw_record(exchange, symbol, [promise, &record](bool success, const RawRecord& value) {
+        if (success) record = value;
+        promise->set_value(success);
+    });
+    return result;
+}
+
+void AsyncRedisWriter::read_price_stats_record(const std::string& symbol, PriceStatsCallback done) {
+    std::vector<Command> commands;
+    commands.push_back(Command{{"GET", redis_keys::price_stats_key(symbol)},
+        [this, done = std::move(done)](redisReply* reply) {
+            PriceStatsRecord record{};
+            if (reply == nullptr || reply->type != REDIS_REPLY_STRING) {
+                done(false, record);
+                return;
+            }
+            if (!market_codec::is_binary(reply->str, reply->len)) {
+                done(market_codec::decode_price_stats_json(reply->str, reply->len, record), record);
+                return;
+            }
+            market_codec::PriceStatsBinary bin;
+            if (!market_codec::decode_price_stats(reply->str, reply->len, bin)) {
+                done(false, record);
+                return;
+            }
+            resolve_ids({bin.symbol_id, bin.highest_exchange_id, bin.lowest_exchange_id}, [this, bin, done](bool resolved) {
+                PriceStatsRecord record{};
+                bool success = resolved && fill_price_stats(*interned_, bin, record);
+                done(success, record);
+            });
+        }});
+    submit(std::move(commands));
+}
+
+std::future<bool> AsyncRedisWriter::read_price_stats_record(const std::string& symbol, PriceStatsRecord& record) {
+    auto promise = std::make_shared<std::promise<bool>>();
+    std::future<bool> result = promise->get_future();
+    read_price_stats_record(symbol, [promise, &record](bool success, const PriceStatsRecord& value) {
+        if (success) record = value;
+        promise->set_value(success);
+    });
+    return result;
+}
+
+void AsyncRedisWriter::command(std::vector<std::string> args, ReplyCallback done) {
+    std::vector<Command> commands;
+    commands.push_back(Command{std::move(args), std::move(done)});
+    submit(std::move(commands));
+}
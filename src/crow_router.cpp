@@ -14,6 +14,7 @@ void setup_routes(crow::SimpleApp& app, EngineAPI& engine_api) {
         r.target_profit = body["target_profit"].d();
         r.take_profit_ratio = body.has("take_profit_ratio") ? body["take_profit_ratio"].d() : 0.1;
         r.stop_loss_ratio = body.has("stop_loss_ratio") ? body["stop_loss_ratio"].d() : 0.05;
+        r.max_staleness_ms = body.has("max_staleness_ms") ? body["max_staleness_ms"].i() : 0;
         std::string mode = body["mode"].s();
 
         if (mode == "ARBITRAGE") r.mode = TradingMode::ARBITRAGE;
@@ -42,6 +43,18 @@ void setup_routes(crow::SimpleApp& app, EngineAPI& engine_api) {
         return crow::response(200, "Session stopped");
     });
 
+    // 运行中调整定时同步间隔：{"interval_ms": 1000}
+    CROW_ROUTE(app, "/sync_interval").methods("POST"_method)
+    ([&engine_api](const crow::request& req) {
+        auto body = crow::json::load(req.body);
+        if (!body || !body.has("interval_ms")) return crow::response(400, "Invalid JSON");
+
+        if (!engine_api.set_sync_interval(static_cast<int>(body["interval_ms"].i()))) {
+            return crow::response(500, "Failed to change sync interval");
+        }
+        return crow::response(200, "Sync interval changed");
+    });
+
     CROW_ROUTE(app, "/sessions").methods("GET"_method)
     ([&engine_api]() {
         auto sessions = engine_api.get_all_sessions();
@@ -58,7 +71,42 @@ void setup_routes(crow::SimpleApp& app, EngineAPI& engine_api) {
         if (!session) return crow::response(404, "Session not found");
 
         crow::json::wvalue result;
+        std::lock_guard<std::mutex> lock(session->log_mutex);
         result["log"] = crow::json::wvalue::list(session->log.begin(), session->log.end());
         return crow::response(result);
     });
+
+    // 各 symbol 从交易所时间戳到策略决策每个阶段的延迟分布（毫秒）
+    CROW_ROUTE(app, "/freshness").methods("GET"_method)
+    ([&engine_api]() {
+        crow::json::wvalue result;
+        for (const auto& [symbol, stages] : engine_api.get_freshness_summary()) {
+            for (size_t i = 0; i < FRESHNESS_STAGE_COUNT; ++i) {
+                auto& stage = result[symbol][freshness_stage_name(static_cast<FreshnessStage>(i))];
+                stage["count"] = stages[i].count;
+                stage["p50_ms"] = stages[i].p50;
+                stage["p99_ms"] = stages[i].p99;
+                stage["max_ms"] = stages[i].max;
+                stage["mean_ms"] = stages[i].mean;
+            }
+        }
+        return crow::response(result);
+    });
+
+    // Redis 客户端缓存命中率
+    CROW_ROUTE(app, "/redis_cache").methods("GET"_method)
+    ([&engine_api]() {
+        RedisClientCache::Stats stats;
+        if (!engine_api.get_redis_cache_stats(stats)) {
+            return crow::response(404, "Client-side cache not enabled");
+        }
+        crow::json::wvalue result;
+        result["hits"] = stats.hits;
+        result["misses"] = stats.misses;
+        result["hit_rate"] = stats.hit_rate();
+        result["invalidations"] = stats.invalidations;
+        result["flushes"] = stats.flushes;
+        result["entries"] = stats.entries;
+        return crow::response(result);
+    });
 }
@@ -1,13 +1,66 @@
 #include "data_sync_service.h"
 #include <iostream>
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <iterator>
+
+namespace {
+
+void hash_combine(uint64_t& h, uint64_t v) {
+    h ^= v + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+}
+
+void hash_combine(uint64_t& h, double v) {
+    uint64_t bits;
+    std::memcpy(&bits, &v, sizeof(bits));
+    hash_combine(h, bits);
+}
+
+uint64_t content_hash(const RawRecord& r) {
+    uint64_t h = 0;
+    hash_combine(h, static_cast<uint64_t>(r.id));
+    hash_combine(h, r.last);
+    hash_combine(h, r.bid);
+    hash_combine(h, r.ask);
+    hash_combine(h, r.high);
+    hash_combine(h, r.low);
+    hash_combine(h, r.volume);
+    return h;
+}
+
+uint64_t content_hash(const PriceStatsRecord& r) {
+    uint64_t h = 0;
+    hash_combine(h, static_cast<uint64_t>(r.id));
+    hash_combine(h, r.highest_price);
+    hash_combine(h, static_cast<uint64_t>(std::hash<std::string>()(r.highest_exchange)));
+    hash_combine(h, r.lowest_price);
+    hash_combine(h, static_cast<uint64_t>(std::hash<std::string>()(r.lowest_exchange)));
+    hash_combine(h, static_cast<uint64_t>(r.record_count));
+    hash_combine(h, static_cast<uint64_t>(r.earliest_timestamp));
+    return h;
+}
+
+} // namespace
 
 DataSyncService::DataSyncService(const std::string& db_conninfo,
                                 const std::string& redis_host,
                                 int redis_port,
-                                const std::string& redis_password) {
+                                const std::string& redis_password)
+    : db_conninfo_(db_conninfo),
+      redis_host_(redis_host),
+      redis_port_(redis_port),
+      redis_password_(redis_password),
+      shard_round_(0),
+      shards_pending_(0),
+      shards_stopping_(false),
+      full_resync_requested_(false),
+      snapshot_mode_(false),
+      full_resync_interval_(60),
+      cycles_since_full_resync_(0) {
     
-    db_reader_ = std::make_unique<TimescaleDBReader>(db_conninfo);
-    redis_writer_ = std::make_unique<RedisWriter>(redis_host, redis_port, redis_password);
+    primary_.db_reader = std::make_unique<TimescaleDBReader>(db_conninfo);
+    primary_.redis_writer = std::make_unique<RedisWriter>(redis_host, redis_port, redis_password);
     scheduler_ = std::make_unique<Scheduler>();
     
     reset_stats();
@@ -16,21 +69,35 @@ DataSyncService::DataSyncService(const std::string& db_conninfo,
 }
 
 DataSyncService::~DataSyncService() {
+    stop_push_sync();
     stop_scheduler();
+    disable_sharding();
 }
 
 bool DataSyncService::is_healthy() const {
-    return redis_writer_->is_connected();
+    return primary_.redis_writer->is_connected();
 }
 
 void DataSyncService::reset_stats() {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    stats_ = SyncStats();
     stats_.raw_records_synced = 0;
     stats_.price_stats_records_synced = 0;
     stats_.total_sync_count = 0;
     stats_.failed_sync_count = 0;
+    stats_.push_sync_count = 0;
+    stats_.raw_records_skipped = 0;
+    stats_.price_stats_records_skipped = 0;
+    stats_.ttl_refresh_count = 0;
     stats_.last_sync_time = std::chrono::system_clock::now();
 }
 
+DataSyncService::SyncStats DataSyncService::get_stats() const {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    return stats_;
+}
+
+// 调用方持有 stats_mutex_
 void DataSyncService::update_stats(bool success, int raw_count, int stats_count) {
     stats_.total_sync_count++;
     if (success) {
@@ -42,94 +109,537 @@ void DataSyncService::update_stats(bool success, int raw_count, int stats_count)
     stats_.last_sync_time = std::chrono::system_clock::now();
 }
 
-bool DataSyncService::sync_raw_data() {
-    if (!is_healthy()) {
-        std::cerr << "Service not healthy, skipping raw data sync" << std::endl;
+void DataSyncService::request_full_resync() {
+    full_resync_requested_ = true;
+}
+
+// 本轮是否需要全量重同步（手动请求、写入失败或到了周期）
+bool DataSyncService::take_full_resync() {
+    bool periodic = full_resync_interval_ > 0 && cycles_since_full_resync_ >= full_resync_interval_;
+    if (full_resync_requested_.exchange(false) || periodic) {
+        std::cout << "Full resync: resetting TimescaleDB watermarks" << std::endl;
+        cycles_since_full_resync_ = 0;
+        return true;
+    }
+    cycles_since_full_resync_++;
+    return false;
+}
+
+void DataSyncService::set_market_data_cache(std::shared_ptr<MarketDataCache> cache) {
+    std::lock_guard<std::mutex> lock(sync_mutex_);
+    market_cache_ = std::move(cache);
+}
+
+void DataSyncService::set_freshness_tracker(std::shared_ptr<FreshnessTracker> tracker) {
+    std::lock_guard<std::mutex> lock(sync_mutex_);
+    freshness_tracker_ = std::move(tracker);
+}
+
+void DataSyncService::add_read_timing(SyncBatch& batch, const ReadTiming& timing) {
+    batch.read.query_us += timing.query_us;
+    batch.read.decode_us += timing.decode_us;
+}
+
+// 去掉与上次写入指纹相同的记录
+void DataSyncService::drop_unchanged(SyncContext& ctx, SyncBatch& batch) {
+    auto raw_end = std::remove_if(batch.raw.begin(), batch.raw.end(), [&ctx](const RawRecord& r) {
+        auto it = ctx.raw_fingerprints.find({r.exchange, r.symbol});
+        return it != ctx.raw_fingerprints.end() &&
+               it->second.timestamp == r.timestamp && it->second.content_hash == content_hash(r);
+    });
+    batch.raw_skipped += std::distance(raw_end, batch.raw.end());
+    batch.raw.erase(raw_end, batch.raw.end());
+    
+    auto stats_end = std::remove_if(batch.stats.begin(), batch.stats.end(), [&ctx](const PriceStatsRecord& r) {
+        auto it = ctx.stats_fingerprints.find(r.symbol);
+        return it != ctx.stats_fingerprints.end() &&
+               it->second.timestamp == r.latest_timestamp && it->second.content_hash == content_hash(r);
+    });
+    batch.stats_skipped += std::distance(stats_end, batch.stats.end());
+    batch.stats.erase(stats_end, batch.stats.end());
+}
+
+// 距上次写入超过半个过期时间的 key 只做一次 EXPIRE，不重新序列化。
+// key 已经不存在（Redis 重启、被删除）时清掉指纹并请求全量重同步，由下一轮重写
+bool DataSyncService::refresh_due_ttls(SyncContext& ctx, SyncBatch& batch) {
+    auto now = std::chrono::steady_clock::now();
+    auto refresh_after = std::chrono::seconds(ctx.redis_writer->get_expire_time() / 2);
+    
+    std::vector<std::pair<std::string, std::string>> raw_due;
+    for (const auto& [key, fp] : ctx.raw_fingerprints) {
+        if (now - fp.last_written >= refresh_after) raw_due.push_back(key);
+    }
+    std::vector<std::string> stats_due;
+    for (const auto& [symbol, fp] : ctx.stats_fingerprints) {
+        if (now - fp.last_written >= refresh_after) stats_due.push_back(symbol);
+    }
+    if (raw_due.empty() && stats_due.empty()) return true;
+    
+    auto flush_start = std::chrono::steady_clock::now();
+    std::vector<size_t> missing;
+    bool success = true;
+    
+    if (!raw_due.empty()) {
+        success = ctx.redis_writer->refresh_raw_ttl(raw_due, missing) && success;
+        for (const auto& key : raw_due) ctx.raw_fingerprints[key].last_written = now;
+        for (size_t i : missing) ctx.raw_fingerprints.erase(raw_due[i]);
+        if (!missing.empty()) full_resync_requested_ = true;
+        batch.ttl_refreshed += raw_due.size() - missing.size();
+    }
+    if (!stats_due.empty()) {
+        success = ctx.redis_writer->refresh_price_stats_ttl(stats_due, missing) && success;
+        for (const auto& symbol : stats_due) ctx.stats_fingerprints[symbol].last_written = now;
+        for (size_t i : missing) ctx.stats_fingerprints.erase(stats_due[i]);
+        if (!missing.empty()) full_resync_requested_ = true;
+        batch.ttl_refreshed += stats_due.size() - missing.size();
+    }
+    
+    batch.write.flush_us += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - flush_start).count();
+    return success;
+}
+
+void DataSyncService::remember_written(SyncContext& ctx, const SyncBatch& batch) {
+    auto now = std::chrono::steady_clock::now();
+    for (const auto& r : batch.raw) {
+        ctx.raw_fingerprints[{r.exchange, r.symbol}] = Fingerprint{r.timestamp, content_hash(r), now};
+    }
+    for (const auto& r : batch.stats) {
+        ctx.stats_fingerprints[r.symbol] = Fingerprint{r.latest_timestamp, content_hash(r), now};
+    }
+}
+
+// 只把变化了的记录先发布到进程内缓存，再写 Redis；Redis 写失败时高水位已经推进，
+// 请求一次全量重同步，保证 Redis 最终补齐
+bool DataSyncService::deliver_batch(SyncContext& ctx, SyncBatch& batch) {
+    drop_unchanged(ctx, batch);
+    
+    if (market_cache_) {
+        market_cache_->publish_raw(batch.raw, batch.read_at_ms);
+        market_cache_->publish_price_stats(batch.stats, batch.read_at_ms);
+    }
+    
+    if (!ctx.redis_writer->is_connected()) {
+        if (!batch.raw.empty() || !batch.stats.empty()) {
+            std::cerr << "Redis not connected, records only published to cache" << std::endl;
+            full_resync_requested_ = true;
+            return false;
+        }
+        return true;
+    }
+    
+    bool ttl_success = refresh_due_ttls(ctx, batch);
+    
+    bool success;
+    if (snapshot_mode_) {
+        // raw 和 stats 在同一个脚本里提交，读者不会看到只更新了一半的周期
+        success = ctx.redis_writer->write_snapshot(batch.raw, batch.stats, nullptr, &batch.write);
+        if (!success) std::cerr << "Failed to write snapshot to Redis" << std::endl;
+    } else {
+        bool raw_success = batch.raw.empty() || ctx.redis_writer->write_raw_records(batch.raw, &batch.write);
+        bool stats_success = batch.stats.empty() || ctx.redis_writer->write_price_stats_records(batch.stats, &batch.write);
+        
+        if (!raw_success) std::cerr << "Failed to write raw records to Redis" << std::endl;
+        if (!stats_success) std::cerr << "Failed to write price stats records to Redis" << std::endl;
+        success = raw_success && stats_success;
+    }
+    if (success) {
+        remember_written(ctx, batch);
+        if (freshness_tracker_) {
+            double written_at_ms = wall_clock_ms();
+            freshness_tracker_->record_sync(batch.raw, batch.read_at_ms, written_at_ms);
+            freshness_tracker_->record_sync(batch.stats, batch.read_at_ms, written_at_ms);
+        }
+    } else {
+        full_resync_requested_ = true;
+    }
+    return success && ttl_success;
+}
+
+void DataSyncService::record_batch(const SyncBatch& batch, bool success, double total_us) {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    update_stats(success, batch.raw.size(), batch.stats.size());
+    stats_.raw_records_skipped += batch.raw_skipped;
+    stats_.price_stats_records_skipped += batch.stats_skipped;
+    stats_.ttl_refresh_count += batch.ttl_refreshed;
+    stats_.query_us.record(batch.read.query_us);
+    stats_.decode_us.record(batch.read.decode_us);
+    stats_.serialize_us.record(batch.write.serialize_us);
+    stats_.flush_us.record(batch.write.flush_us);
+    stats_.total_us.record(total_us);
+}
+
+// 读 → 转换 → 写 的单次流水线，每个查询只执行一次
+bool DataSyncService::sync_context(SyncContext& ctx, bool include_raw, bool include_stats, SyncBatch& batch) {
+    if (!ctx.redis_writer->is_connected() && !market_cache_) {
+        std::cerr << "Service not healthy, skipping sync" << std::endl;
+        // 本轮可能已经消费了全量请求，留到 Redis 恢复后再做
+        full_resync_requested_ = true;
         return false;
     }
     
     try {
-        std::cout << "Reading latest raw data from TimescaleDB..." << std::endl;
-        auto raw_records = db_reader_->read_latest_raw();
-        
-        if (raw_records.empty()) {
-            std::cout << "No raw data found" << std::endl;
-            return true;
+        // 1. 查询 + 解码
+        if (include_raw) {
+            batch.raw = ctx.db_reader->read_incremental_raw();
+            add_read_timing(batch, ctx.db_reader->last_read_timing());
         }
-        
-        std::cout << "Found " << raw_records.size() << " raw records, writing to Redis..." << std::endl;
-        bool success = redis_writer_->write_raw_records(raw_records);
-        
-        if (success) {
-            std::cout << "Successfully synced " << raw_records.size() << " raw records" << std::endl;
-        } else {
-            std::cerr << "Failed to write raw records to Redis" << std::endl;
+        if (include_stats) {
+            batch.stats = ctx.db_reader->read_incremental_price_stats();
+            add_read_timing(batch, ctx.db_reader->last_read_timing());
         }
+        batch.read_at_ms = wall_clock_ms();
         
-        return success;
+        // 2. 发布缓存 + 序列化 + Redis pipeline
+        return deliver_batch(ctx, batch);
         
     } catch (const std::exception& e) {
-        std::cerr << "Error syncing raw data: " << e.what() << std::endl;
-        return false;
+        std::cerr << "Error in sync pipeline: " << e.what() << std::endl;
+        full_resync_requested_ = true;
     }
+    return false;
 }
 
-bool DataSyncService::sync_price_stats_data() {
-    if (!is_healthy()) {
-        std::cerr << "Service not healthy, skipping price stats sync" << std::endl;
-        return false;
+void DataSyncService::log_batch(const SyncBatch& batch, bool success, double total_us, bool include_raw, bool include_stats) {
+    std::cout << "=== Sync completed in " << static_cast<long>(total_us / 1000) << "ms ===" << std::endl;
+    if (include_raw) {
+        std::cout << "Raw records: " << batch.raw.size() << " (" << (success ? "success" : "failed") << ")" << std::endl;
+    }
+    if (include_stats) {
+        std::cout << "Stats records: " << batch.stats.size() << " (" << (success ? "success" : "failed") << ")" << std::endl;
     }
+    std::cout << "Skipped unchanged: " << batch.raw_skipped << " raw / " << batch.stats_skipped
+              << " stats, TTL refreshed: " << batch.ttl_refreshed << std::endl;
+    std::cout << "Stages (us): query=" << static_cast<long>(batch.read.query_us)
+              << " decode=" << static_cast<long>(batch.read.decode_us)
+              << " serialize=" << static_cast<long>(batch.write.serialize_us)
+              << " flush=" << static_cast<long>(batch.write.flush_us) << std::endl;
+}
+
+bool DataSyncService::run_pipeline(bool include_raw, bool include_stats) {
+    auto start_time = std::chrono::steady_clock::now();
+    SyncBatch batch;
+    bool success = sync_context(primary_, include_raw, include_stats, batch);
     
-    try {
-        std::cout << "Reading latest price stats from TimescaleDB..." << std::endl;
-        auto stats_records = db_reader_->read_latest_price_stats();
+    double total_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start_time).count();
+    record_batch(batch, success, total_us);
+    log_batch(batch, success, total_us, include_raw, include_stats);
+    
+    return success;
+}
+
+// 一轮分片同步：唤醒所有分片线程并等它们都完成，调用方持有 sync_mutex_
+bool DataSyncService::run_sharded(bool include_raw, bool include_stats, bool full_resync) {
+    auto start_time = std::chrono::steady_clock::now();
+    {
+        std::lock_guard<std::mutex> lock(shard_mutex_);
+        round_ = ShardRound{include_raw, include_stats, full_resync};
+        shards_pending_ = static_cast<int>(shards_.size());
+        shard_round_++;
+    }
+    shard_cv_.notify_all();
+    {
+        std::unique_lock<std::mutex> lock(shard_mutex_);
+        shard_done_cv_.wait(lock, [this] { return shards_pending_ == 0; });
+    }
+    double total_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start_time).count();
+    
+    // 分片并行执行，阶段耗时取最慢的分片；记录数求和
+    bool success = true;
+    int raw_count = 0;
+    int stats_count = 0;
+    SyncBatch summary;
+    for (const auto& shard : shards_) {
+        success = success && shard->success;
+        raw_count += shard->batch.raw.size();
+        stats_count += shard->batch.stats.size();
+        summary.raw_skipped += shard->batch.raw_skipped;
+        summary.stats_skipped += shard->batch.stats_skipped;
+        summary.ttl_refreshed += shard->batch.ttl_refreshed;
+        summary.read.query_us = std::max(summary.read.query_us, shard->batch.read.query_us);
+        summary.read.decode_us = std::max(summary.read.decode_us, shard->batch.read.decode_us);
+        summary.write.serialize_us = std::max(summary.write.serialize_us, shard->batch.write.serialize_us);
+        summary.write.flush_us = std::max(summary.write.flush_us, shard->batch.write.flush_us);
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        update_stats(success, raw_count, stats_count);
+        stats_.raw_records_skipped += summary.raw_skipped;
+        stats_.price_stats_records_skipped += summary.stats_skipped;
+        stats_.ttl_refresh_count += summary.ttl_refreshed;
+        stats_.query_us.record(summary.read.query_us);
+        stats_.decode_us.record(summary.read.decode_us);
+        stats_.serialize_us.record(summary.write.serialize_us);
+        stats_.flush_us.record(summary.write.flush_us);
+        stats_.total_us.record(total_us);
         
-        if (stats_records.empty()) {
-            std::cout << "No price stats data found" << std::endl;
-            return true;
+        stats_.shards.resize(shards_.size());
+        for (size_t i = 0; i < shards_.size(); ++i) {
+            const auto& shard = *shards_[i];
+            auto& shard_stats = stats_.shards[i];
+            if (shard.success) {
+                shard_stats.raw_records_synced += shard.batch.raw.size();
+                shard_stats.price_stats_records_synced += shard.batch.stats.size();
+            } else {
+                shard_stats.failed_sync_count++;
+            }
+            shard_stats.total_us.record(shard.total_us);
         }
-        
-        std::cout << "Found " << stats_records.size() << " price stats records, writing to Redis..." << std::endl;
-        bool success = redis_writer_->write_price_stats_records(stats_records);
-        
-        if (success) {
-            std::cout << "Successfully synced " << stats_records.size() << " price stats records" << std::endl;
-        } else {
-            std::cerr << "Failed to write price stats records to Redis" << std::endl;
+    }
+    
+    std::cout << "=== Sharded sync completed in " << static_cast<long>(total_us / 1000) << "ms across "
+              << shards_.size() << " shards ===" << std::endl;
+    std::cout << "Raw records: " << raw_count << ", Stats records: " << stats_count
+              << " (" << (success ? "success" : "failed") << ")" << std::endl;
+    std::cout << "Skipped unchanged: " << summary.raw_skipped << " raw / " << summary.stats_skipped
+              << " stats, TTL refreshed: " << summary.ttl_refreshed << std::endl;
+    
+    // 结果已经汇总，释放记录
+    for (auto& shard : shards_) shard->batch = SyncBatch();
+    
+    return success;
+}
+
+void DataSyncService::shard_loop(SyncShard& shard, uint64_t seen_round) {
+    while (true) {
+        ShardRound round;
+        {
+            std::unique_lock<std::mutex> lock(shard_mutex_);
+            shard_cv_.wait(lock, [&] { return shards_stopping_ || shard_round_ != seen_round; });
+            if (shards_stopping_) return;
+            seen_round = shard_round_;
+            round = round_;
         }
         
-        return success;
+        if (round.full_resync) shard.context.db_reader->reset_watermarks();
         
-    } catch (const std::exception& e) {
-        std::cerr << "Error syncing price stats: " << e.what() << std::endl;
-        return false;
+        auto start_time = std::chrono::steady_clock::now();
+        SyncBatch batch;
+        bool success = sync_context(shard.context, round.include_raw, round.include_stats, batch);
+        double total_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start_time).count();
+        
+        std::lock_guard<std::mutex> lock(shard_mutex_);
+        shard.batch = std::move(batch);
+        shard.success = success;
+        shard.total_us = total_us;
+        if (--shards_pending_ == 0) shard_done_cv_.notify_all();
     }
 }
 
+bool DataSyncService::enable_sharding(int shard_count) {
+    if (shard_count <= 1) {
+        disable_sharding();
+        return true;
+    }
+    
+    std::lock_guard<std::mutex> lock(sync_mutex_);
+    
+    // 先建好新分片的连接，全部成功才停掉旧分片并替换；失败时原来的模式和分片不受影响
+    std::vector<std::unique_ptr<SyncShard>> shards;
+    for (int i = 0; i < shard_count; ++i) {
+        auto shard = std::make_unique<SyncShard>();
+        shard->context.db_reader = std::make_unique<TimescaleDBReader>(db_conninfo_, i, shard_count);
+        shard->context.redis_writer = std::make_unique<RedisWriter>(redis_host_, redis_port_, redis_password_);
+        if (!shard->context.redis_writer->is_connected()) {
+            std::cerr << "Failed to connect Redis for shard " << i << ", keeping current sync mode" << std::endl;
+            return false;
+        }
+        shard->context.redis_writer->set_expire_time(primary_.redis_writer->get_expire_time());
+        shard->context.redis_writer->set_tick_stream_max_len(primary_.redis_writer->get_tick_stream_max_len());
+        shard->context.redis_writer->set_change_channel(primary_.redis_writer->get_change_channel());
+        for (const auto& [prefix, codec] : redis_codecs_) {
+            shard->context.redis_writer->set_codec(prefix, codec);
+        }
+        shards.push_back(std::move(shard));
+    }
+    
+    stop_shards();
+    
+    // 新分片的高水位为空，第一轮自然是全量同步
+    shards_ = std::move(shards);
+    uint64_t current_round;
+    {
+        std::lock_guard<std::mutex> shard_lock(shard_mutex_);
+        current_round = shard_round_;
+    }
+    for (auto& shard : shards_) {
+        SyncShard* raw_shard = shard.get();
+        shard->worker = std::thread([this, raw_shard, current_round]() { shard_loop(*raw_shard, current_round); });
+    }
+    {
+        std::lock_guard<std::mutex> stats_lock(stats_mutex_);
+        stats_.shards.assign(shards_.size(), ShardStats());
+    }
+    
+    std::cout << "Sharded sync enabled with " << shard_count << " shards" << std::endl;
+    return true;
+}
+
+void DataSyncService::disable_sharding() {
+    std::lock_guard<std::mutex> lock(sync_mutex_);
+    if (shards_.empty()) return;
+    stop_shards();
+    {
+        std::lock_guard<std::mutex> stats_lock(stats_mutex_);
+        stats_.shards.clear();
+    }
+    std::cout << "Sharded sync disabled" << std::endl;
+}
+
+// 调用方持有 sync_mutex_，此时没有进行中的分片轮次
+void DataSyncService::stop_shards() {
+    if (shards_.empty()) return;
+    {
+        std::lock_guard<std::mutex> lock(shard_mutex_);
+        shards_stopping_ = true;
+    }
+    shard_cv_.notify_all();
+    for (auto& shard : shards_) {
+        if (shard->worker.joinable()) shard->worker.join();
+    }
+    shards_.clear();
+    std::lock_guard<std::mutex> lock(shard_mutex_);
+    shards_stopping_ = false;
+}
+
+bool DataSyncService::sync_raw_data() {
+    std::lock_guard<std::mutex> lock(sync_mutex_);
+    std::cout << "Reading new raw data from TimescaleDB..." << std::endl;
+    if (!shards_.empty()) return run_sharded(true, false, false);
+    return run_pipeline(true, false);
+}
+
+bool DataSyncService::sync_price_stats_data() {
+    std::lock_guard<std::mutex> lock(sync_mutex_);
+    std::cout << "Reading new price stats from TimescaleDB..." << std::endl;
+    if (!shards_.empty()) return run_sharded(false, true, false);
+    return run_pipeline(false, true);
+}
+
 bool DataSyncService::sync_once() {
+    std::lock_guard<std::mutex> lock(sync_mutex_);
     std::cout << "=== Starting data sync ===" << std::endl;
     
-    auto start_time = std::chrono::high_resolution_clock::now();
+    // 启动时高水位为空，自然是一次全量同步；之后只读增量
+    bool full_resync = take_full_resync();
+    if (!shards_.empty()) return run_sharded(true, true, full_resync);
+    
+    if (full_resync) primary_.db_reader->reset_watermarks();
+    return run_pipeline(true, true);
+}
+
+bool DataSyncService::sync_keys(const std::vector<std::pair<std::string, std::string>>& keys) {
+    std::lock_guard<std::mutex> lock(sync_mutex_);
+    if (!is_healthy() && !market_cache_) {
+        std::cerr << "Service not healthy, skipping targeted sync" << std::endl;
+        return false;
+    }
+    
+    auto start_time = std::chrono::steady_clock::now();
+    SyncBatch batch;
+    bool success = false;
+    
+    try {
+        // 分片模式下 key 的高水位和指纹在分片上，必须由拥有它的分片写入
+        success = shards_.empty() ? sync_keys_context(primary_, keys, batch) : sync_keys_sharded(keys, batch);
+    } catch (const std::exception& e) {
+        std::cerr << "Error in targeted sync: " << e.what() << std::endl;
+    }
+    
+    double total_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start_time).count();
+    record_batch(batch, success, total_us);
+    {
+        std::lock_guard<std::mutex> stats_lock(stats_mutex_);
+        stats_.push_sync_count++;
+    }
     
-    // 获取数据量用于统计
-    auto raw_records = db_reader_->read_latest_raw();
-    auto stats_records = db_reader_->read_latest_price_stats();
+    std::cout << "[Push] Synced " << batch.raw.size() << " raw / " << batch.stats.size()
+              << " stats records for " << keys.size() << " keys in " << static_cast<long>(total_us / 1000) << "ms" << std::endl;
     
-    bool raw_success = sync_raw_data();
-    bool stats_success = sync_price_stats_data();
+    return success;
+}
+
+bool DataSyncService::sync_keys_context(SyncContext& ctx, const std::vector<std::pair<std::string, std::string>>& keys,
+                                        SyncBatch& batch) {
+    batch.raw = ctx.db_reader->read_latest_raw_for(keys);
+    add_read_timing(batch, ctx.db_reader->last_read_timing());
     
-    bool overall_success = raw_success && stats_success;
+    // 统计表由采集端随 raw 一起更新，增量查询在安静时几乎没有代价
+    batch.stats = ctx.db_reader->read_incremental_price_stats();
+    add_read_timing(batch, ctx.db_reader->last_read_timing());
+    batch.read_at_ms = wall_clock_ms();
     
-    auto end_time = std::chrono::high_resolution_clock::now();
-    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
+    return deliver_batch(ctx, batch);
+}
+
+// 调用方持有 sync_mutex_，分片线程此时空闲，可以在当前线程使用分片的连接。
+// 指纹里有这个 key 的分片就是它的拥有者；还没写过的 key 发给所有分片，分片查询的 symbol 哈希过滤只让拥有者读到
+bool DataSyncService::sync_keys_sharded(const std::vector<std::pair<std::string, std::string>>& keys, SyncBatch& batch) {
+    std::vector<std::vector<std::pair<std::string, std::string>>> routed(shards_.size());
+    for (const auto& key : keys) {
+        bool owned = false;
+        for (size_t i = 0; i < shards_.size() && !owned; ++i) {
+            if (shards_[i]->context.raw_fingerprints.count(key)) {
+                routed[i].push_back(key);
+                owned = true;
+            }
+        }
+        if (!owned) {
+            for (auto& shard_keys : routed) shard_keys.push_back(key);
+        }
+    }
     
-    update_stats(overall_success, raw_records.size(), stats_records.size());
+    // 依次执行，阶段耗时和记录数累加到一个批次里
+    bool success = true;
+    for (size_t i = 0; i < shards_.size(); ++i) {
+        if (routed[i].empty()) continue;
+        SyncBatch shard_batch;
+        success = sync_keys_context(shards_[i]->context, routed[i], shard_batch) && success;
+        
+        batch.raw.insert(batch.raw.end(), shard_batch.raw.begin(), shard_batch.raw.end());
+        batch.stats.insert(batch.stats.end(), shard_batch.stats.begin(), shard_batch.stats.end());
+        batch.raw_skipped += shard_batch.raw_skipped;
+        batch.stats_skipped += shard_batch.stats_skipped;
+        batch.ttl_refreshed += shard_batch.ttl_refreshed;
+        add_read_timing(batch, shard_batch.read);
+        batch.write.serialize_us += shard_batch.write.serialize_us;
+        batch.write.flush_us += shard_batch.write.flush_us;
+    }
+    return success;
+}
+
+bool DataSyncService::start_push_sync(const std::string& channel) {
+    if (is_push_sync_running()) return true;
+    
+    listener_ = std::make_unique<PgNotificationListener>(db_conninfo_, channel);
+    bool started = listener_->start([this](const std::vector<std::string>& payloads) {
+        // payload 格式为 "exchange:symbol"（symbol 本身不含冒号）
+        std::vector<std::pair<std::string, std::string>> keys;
+        keys.reserve(payloads.size());
+        for (const auto& payload : payloads) {
+            auto pos = payload.find(':');
+            if (pos == std::string::npos) continue;
+            keys.emplace_back(payload.substr(0, pos), payload.substr(pos + 1));
+        }
+        if (!keys.empty()) sync_keys(keys);
+    });
     
-    std::cout << "=== Sync completed in " << duration.count() << "ms ===" << std::endl;
-    std::cout << "Raw records: " << raw_records.size() << " (" << (raw_success ? "success" : "failed") << ")" << std::endl;
-    std::cout << "Stats records: " << stats_records.size() << " (" << (stats_success ? "success" : "failed") << ")" << std::endl;
+    if (!started) {
+        std::cerr << "Failed to start push sync, falling back to polling only" << std::endl;
+        listener_.reset();
+        return false;
+    }
     
-    return overall_success;
+    std::cout << "Push sync started on channel " << channel << std::endl;
+    return true;
+}
+
+void DataSyncService::stop_push_sync() {
+    if (listener_) {
+        std::cout << "Stopping push sync..." << std::endl;
+        listener_->stop();
+        listener_.reset();
+    }
 }
 
 void DataSyncService::start_scheduler() {
@@ -150,11 +660,70 @@ void DataSyncService::schedule_sync_task(int interval_ms) {
         sync_once();
     };
     
-    scheduler_->addTask(sync_task, interval_ms);
+    // 固定频率：触发点对齐到起点，下游看到等间隔的更新；
+    // 一次同步超过间隔时，后续触发合并成一次，上一次结束后立即补跑
+    // 重复调用时替换之前的任务，而不是叠加
+    sync_task_.cancel();
+    sync_task_ = scheduler_->addTask(sync_task, interval_ms, OverrunPolicy::Coalesce, ScheduleMode::FixedRate);
     std::cout << "Scheduled full sync task every " << interval_ms << "ms" << std::endl;
 }
 
+void DataSyncService::schedule_redis_health_check(std::shared_ptr<RedisPool> pool, int interval_ms) {
+    if (!pool) return;
+    
+    auto health_task = [pool]() {
+        size_t usable = pool->health_check();
+        if (usable == 0) {
+            std::cerr << "[Scheduled] Redis pool health check: no usable connections" << std::endl;
+        }
+    };
+    
+    redis_health_task_.cancel();
+    redis_health_task_ = scheduler_->addTask(health_task, interval_ms);
+    std::cout << "Scheduled Redis pool health check every " << interval_ms << "ms" << std::endl;
+}
+
+bool DataSyncService::set_sync_interval(int interval_ms) {
+    if (!sync_task_.setInterval(interval_ms)) return false;
+    std::cout << "Full sync interval changed to " << interval_ms << "ms" << std::endl;
+    return true;
+}
+
+void DataSyncService::set_scheduler_timing(int cpu, bool high_resolution) {
+    scheduler_->setSchedulerCpu(cpu);
+    scheduler_->setHighResolutionWait(high_resolution);
+}
+
+bool DataSyncService::get_sync_schedule_stats(SchedulerTaskStats& stats) const {
+    return sync_task_.getStats(stats);
+}
+
 void DataSyncService::set_redis_expire_time(int seconds) {
-    redis_writer_->set_expire_time(seconds);
+    std::lock_guard<std::mutex> lock(sync_mutex_);
+    primary_.redis_writer->set_expire_time(seconds);
+    for (auto& shard : shards_) shard->context.redis_writer->set_expire_time(seconds);
     std::cout << "Set Redis expire time to " << seconds << " seconds" << std::endl;
-}
\ No newline at end of file
+}
+void DataSyncService::set_tick_stream_max_len(size_t max_len) {
+    std::lock_guard<std::mutex> lock(sync_mutex_);
+    primary_.redis_writer->set_tick_stream_max_len(max_len);
+    for (auto& shard : shards_) shard->context.redis_writer->set_tick_stream_max_len(max_len);
+    if (max_len > 0) {
+        std::cout << "Tick streams enabled, MAXLEN ~" << max_len << std::endl;
+    } else {
+        std::cout << "Tick streams disabled" << std::endl;
+    }
+}
+
+void DataSyncService::set_change_channel(const std::string& channel) {
+    std::lock_guard<std::mutex> lock(sync_mutex_);
+    primary_.redis_writer->set_change_channel(channel);
+    for (auto& shard : shards_) shard->context.redis_writer->set_change_channel(channel);
+}
+
+void DataSyncService::set_redis_codec(const std::string& key_prefix, market_codec::ValueCodec codec) {
+    std::lock_guard<std::mutex> lock(sync_mutex_);
+    redis_codecs_.emplace_back(key_prefix, codec);
+    primary_.redis_writer->set_codec(key_prefix, codec);
+    for (auto& shard : shards_) shard->context.redis_writer->set_codec(key_prefix, codec);
+}
@@ -28,10 +28,22 @@ std::vector<std::string> EngineAPI::get_all_sessions() {
     return engine_.get_active_sessions();
 }
 
-TradingSession* EngineAPI::get_session(const std::string& session_id) {
+std::shared_ptr<TradingSession> EngineAPI::get_session(const std::string& session_id) {
     return engine_.get_session(session_id);
 }
 
+std::map<std::string, FreshnessTracker::SymbolSummary> EngineAPI::get_freshness_summary() const {
+    return engine_.get_freshness_summary();
+}
+
+bool EngineAPI::get_redis_cache_stats(RedisClientCache::Stats& stats) const {
+    return engine_.get_redis_cache_stats(stats);
+}
+
+bool EngineAPI::set_sync_interval(int interval_ms) {
+    return engine_.set_sync_interval(interval_ms);
+}
+
 TradingEngineManager& EngineAPI::get_engine() {
     return engine_;
 }
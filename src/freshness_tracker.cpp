@@ -0,0 +1,69 @@
+#include "freshness_tracker.h"
+
+const char* freshness_stage_name(FreshnessStage stage) {
+    switch (stage) {
+        case FreshnessStage::EXCHANGE_TO_READ: return "exchange_to_read";
+        case FreshnessStage::READ_TO_WRITE: return "read_to_write";
+        case FreshnessStage::WRITE_TO_STRATEGY: return "write_to_strategy";
+        case FreshnessStage::READ_TO_DECISION: return "read_to_decision";
+        case FreshnessStage::END_TO_END: return "end_to_end";
+    }
+    return "unknown";
+}
+
+FreshnessTracker::FreshnessTracker(size_t window) : window_(window) {}
+
+FreshnessTracker::StageHistograms& FreshnessTracker::histograms_for(const std::string& symbol) {
+    auto it = histograms_.find(symbol);
+    if (it == histograms_.end()) {
+        StageHistograms histograms;
+        histograms.fill(RollingHistogram(window_));
+        it = histograms_.emplace(symbol, std::move(histograms)).first;
+    }
+    return it->second;
+}
+
+void FreshnessTracker::record(const std::string& symbol, FreshnessStage stage, double latency_ms) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    histograms_for(symbol)[static_cast<size_t>(stage)].record(latency_ms);
+}
+
+void FreshnessTracker::record_sync(const std::vector<RawRecord>& records, double read_at_ms, double written_at_ms) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& r : records) {
+        auto& histograms = histograms_for(r.symbol);
+        histograms[static_cast<size_t>(FreshnessStage::EXCHANGE_TO_READ)].record(read_at_ms - r.timestamp);
+        histograms[static_cast<size_t>(FreshnessStage::READ_TO_WRITE)].record(written_at_ms - read_at_ms);
+    }
+}
+
+void FreshnessTracker::record_sync(const std::vector<PriceStatsRecord>& records, double read_at_ms, double written_at_ms) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& r : records) {
+        auto& histograms = histograms_for(r.symbol);
+        histograms[static_cast<size_t>(FreshnessStage::EXCHANGE_TO_READ)].record(read_at_ms - r.latest_timestamp);
+        histograms[static_cast<size_t>(FreshnessStage::READ_TO_WRITE)].record(written_at_ms - read_at_ms);
+    }
+}
+
+std::map<std::string, FreshnessTracker::SymbolSummary> FreshnessTracker::summary() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::map<std::string, SymbolSummary> result;
+    for (const auto& [symbol, histograms] : histograms_) {
+        auto& out = result[symbol];
+        for (size_t i = 0; i < FRESHNESS_STAGE_COUNT; ++i) {
+            const auto& h = histograms[i];
+            out[i].count = h.total_count();
+            out[i].p50 = h.p50();
+            out[i].p99 = h.p99();
+            out[i].max = h.max();
+            out[i].mean = h.mean();
+        }
+    }
+    return result;
+}
+
+void FreshnessTracker::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    histograms_.clear();
+}
@@ -0,0 +1,158 @@
+#include "market_data_cache.h"
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+
+namespace {
+
+std::string raw_key(const std::string& exchange, const std::string& symbol) {
+    return exchange + ":" + symbol;
+}
+
+double now_ms() {
+    return std::chrono::duration<double, std::milli>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+void copy_name(char (&dst)[32], const std::string& src) {
+    size_t n = std::min(src.size(), sizeof(dst) - 1);
+    std::memcpy(dst, src.data(), n);
+    dst[n] = '\0';
+}
+
+} // namespace
+
+MarketDataCache::RawSlot* MarketDataCache::get_or_create_raw(const std::string& exchange, const std::string& symbol) {
+    std::string key = raw_key(exchange, symbol);
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        auto it = raw_slots_.find(key);
+        if (it != raw_slots_.end()) return it->second.get();
+    }
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    auto& slot = raw_slots_[key];
+    if (!slot) slot = std::make_unique<RawSlot>();
+    return slot.get();
+}
+
+MarketDataCache::StatsSlot* MarketDataCache::get_or_create_stats(const std::string& symbol) {
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        auto it = stats_slots_.find(symbol);
+        if (it != stats_slots_.end()) return it->second.get();
+    }
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    auto& slot = stats_slots_[symbol];
+    if (!slot) slot = std::make_unique<StatsSlot>();
+    return slot.get();
+}
+
+RawQuote MarketDataCache::to_quote(const RawRecord& record) {
+    RawQuote quote;
+    quote.id = record.id;
+    quote.last = record.last;
+    quote.bid = record.bid;
+    quote.ask = record.ask;
+    quote.high = record.high;
+    quote.low = record.low;
+    quote.volume = record.volume;
+    quote.timestamp = record.timestamp;
+    quote.read_at_ms = 0.0;
+    quote.published_at_ms = 0.0;
+    return quote;
+}
+
+StatsQuote MarketDataCache::to_quote(const PriceStatsRecord& record) {
+    StatsQuote quote;
+    quote.id = record.id;
+    quote.highest_price = record.highest_price;
+    copy_name(quote.highest_exchange, record.highest_exchange);
+    quote.lowest_price = record.lowest_price;
+    copy_name(quote.lowest_exchange, record.lowest_exchange);
+    quote.record_count = record.record_count;
+    quote.earliest_timestamp = record.earliest_timestamp;
+    quote.latest_timestamp = record.latest_timestamp;
+    quote.read_at_ms = 0.0;
+    quote.published_at_ms = 0.0;
+    return quote;
+}
+
+void MarketDataCache::from_quote(const RawQuote& quote, const std::string& exchange,
+                                 const std::string& symbol, RawRecord& record) {
+    record.id = quote.id;
+    record.exchange = exchange;
+    record.symbol = symbol;
+    record.last = quote.last;
+    record.bid = quote.bid;
+    record.ask = quote.ask;
+    record.high = quote.high;
+    record.low = quote.low;
+    record.volume = quote.volume;
+    record.timestamp = quote.timestamp;
+}
+
+void MarketDataCache::from_quote(const StatsQuote& quote, const std::string& symbol, PriceStatsRecord& record) {
+    record.id = quote.id;
+    record.symbol = symbol;
+    record.highest_price = quote.highest_price;
+    record.highest_exchange = quote.highest_exchange;
+    record.lowest_price = quote.lowest_price;
+    record.lowest_exchange = quote.lowest_exchange;
+    record.record_count = quote.record_count;
+    record.earliest_timestamp = quote.earliest_timestamp;
+    record.latest_timestamp = quote.latest_timestamp;
+}
+
+void MarketDataCache::publish_raw(const RawRecord& record, double read_at_ms) {
+    RawQuote quote = to_quote(record);
+    quote.read_at_ms = read_at_ms;
+    quote.published_at_ms = now_ms();
+    get_or_create_raw(record.exchange, record.symbol)->store(quote);
+}
+
+void MarketDataCache::publish_raw(const std::vector<RawRecord>& records, double read_at_ms) {
+    for (const auto& record : records) publish_raw(record, read_at_ms);
+}
+
+void MarketDataCache::publish_price_stats(const PriceStatsRecord& record, double read_at_ms) {
+    StatsQuote quote = to_quote(record);
+    quote.read_at_ms = read_at_ms;
+    quote.published_at_ms = now_ms();
+    get_or_create_stats(record.symbol)->store(quote);
+}
+
+void MarketDataCache::publish_price_stats(const std::vector<PriceStatsRecord>& records, double read_at_ms) {
+    for (const auto& record : records) publish_price_stats(record, read_at_ms);
+}
+
+const MarketDataCache::RawSlot* MarketDataCache::raw_slot(const std::string& exchange, const std::string& symbol) {
+    return get_or_create_raw(exchange, symbol);
+}
+
+const MarketDataCache::StatsSlot* MarketDataCache::stats_slot(const std::string& symbol) {
+    return get_or_create_stats(symbol);
+}
+
+bool MarketDataCache::read_raw(const std::string& exchange, const std::string& symbol, RawRecord& record) {
+    RawQuote quote;
+    if (!raw_slot(exchange, symbol)->load(quote)) return false;
+    from_quote(quote, exchange, symbol, record);
+    return true;
+}
+
+bool MarketDataCache::read_price_stats(const std::string& symbol, PriceStatsRecord& record) {
+    StatsQuote quote;
+    if (!stats_slot(symbol)->load(quote)) return false;
+    from_quote(quote, symbol, record);
+    return true;
+}
+
+size_t MarketDataCache::raw_slot_count() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return raw_slots_.size();
+}
+
+size_t MarketDataCache::stats_slot_count() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return stats_slots_.size();
+}
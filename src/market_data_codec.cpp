@@ -0,0 +1,277 @@
+#include "market_data_codec.h"
+#include <algorithm>
+#include <charconv>
+#include <mutex>
+#include <nlohmann/json.hpp>
+using json = nlohmann::json;
+
+namespace market_codec {
+
+size_t encode_raw(const RawRecord& record, uint32_t exchange_id, uint32_t symbol_id, char* out) {
+    char* p = out;
+    *p++ = static_cast<char>(BINARY_VERSION);
+    *p++ = static_cast<char>(TYPE_RAW);
+    put_u32(p, exchange_id);
+    put_u32(p, symbol_id);
+    put_u32(p, static_cast<uint32_t>(record.id));
+    put_f64(p, record.last);
+    put_f64(p, record.bid);
+    put_f64(p, record.ask);
+    put_f64(p, record.high);
+    put_f64(p, record.low);
+    put_f64(p, record.volume);
+    put_u64(p, static_cast<uint64_t>(record.timestamp));
+    return p - out;
+}
+
+size_t encode_price_stats(const PriceStatsRecord& record, uint32_t symbol_id,
+                          uint32_t highest_exchange_id, uint32_t lowest_exchange_id, char* out) {
+    char* p = out;
+    *p++ = static_cast<char>(BINARY_VERSION);
+    *p++ = static_cast<char>(TYPE_PRICE_STATS);
+    put_u32(p, symbol_id);
+    put_u32(p, static_cast<uint32_t>(record.id));
+    put_f64(p, record.highest_price);
+    put_u32(p, highest_exchange_id);
+    put_f64(p, record.lowest_price);
+    put_u32(p, lowest_exchange_id);
+    put_u32(p, static_cast<uint32_t>(record.record_count));
+    put_u64(p, static_cast<uint64_t>(record.earliest_timestamp));
+    put_u64(p, static_cast<uint64_t>(record.latest_timestamp));
+    return p - out;
+}
+
+bool decode_raw(const char* data, size_t len, RawBinary& out) {
+    if (len != RAW_BINARY_SIZE || !is_binary(data, len) || static_cast<uint8_t>(data[1]) != TYPE_RAW) {
+        return false;
+    }
+    const char* p = data + 2;
+    out.exchange_id = get_u32(p);
+    out.symbol_id = get_u32(p);
+    out.id = static_cast<int32_t>(get_u32(p));
+    out.last = get_f64(p);
+    out.bid = get_f64(p);
+    out.ask = get_f64(p);
+    out.high = get_f64(p);
+    out.low = get_f64(p);
+    out.volume = get_f64(p);
+    out.timestamp = static_cast<int64_t>(get_u64(p));
+    return true;
+}
+
+bool decode_price_stats(const char* data, size_t len, PriceStatsBinary& out) {
+    if (len != PRICE_STATS_BINARY_SIZE || !is_binary(data, len) ||
+        static_cast<uint8_t>(data[1]) != TYPE_PRICE_STATS) {
+        return false;
+    }
+    const char* p = data + 2;
+    out.symbol_id = get_u32(p);
+    out.id = static_cast<int32_t>(get_u32(p));
+    out.highest_price = get_f64(p);
+    out.highest_exchange_id = get_u32(p);
+    out.lowest_price = get_f64(p);
+    out.lowest_exchange_id = get_u32(p);
+    out.record_count = static_cast<int32_t>(get_u32(p));
+    out.earliest_timestamp = static_cast<int64_t>(get_u64(p));
+    out.latest_timestamp = static_cast<int64_t>(get_u64(p));
+    return true;
+}
+
+namespace {
+
+// 字面量部分（键名、引号、逗号、花括号）的长度上限
+constexpr size_t RAW_JSON_LITERAL_MAX = 128;
+constexpr size_t PRICE_STATS_JSON_LITERAL_MAX = 192;
+
+template <size_t N>
+inline char* put_literal(char* p, const char (&literal)[N]) {
+    std::memcpy(p, literal, N - 1);
+    return p + N - 1;
+}
+
+inline char* put_string(char* p, const std::string& value) {
+    std::memcpy(p, value.data(), value.size());
+    return p + value.size();
+}
+
+template <typename Int>
+inline char* put_int(char* p, Int value) {
+    return std::to_chars(p, p + JSON_INT_MAX, value).ptr;
+}
+
+// 与 std::fixed + setprecision(8) 相同：四舍五入到 8 位小数，nan / inf 输出同名小写
+inline char* put_double(char* p, double value) {
+    return std::to_chars(p, p + JSON_DOUBLE_MAX, value, std::chars_format::fixed, JSON_PRECISION).ptr;
+}
+
+} // namespace
+
+size_t raw_json_max_size(const RawRecord& record) {
+    return RAW_JSON_LITERAL_MAX + record.exchange.size() + record.symbol.size() +
+           6 * JSON_DOUBLE_MAX + 2 * JSON_INT_MAX;
+}
+
+size_t price_stats_json_max_size(const PriceStatsRecord& record) {
+    return PRICE_STATS_JSON_LITERAL_MAX + record.symbol.size() + record.highest_exchange.size() +
+           record.lowest_exchange.size() + 2 * JSON_DOUBLE_MAX + 4 * JSON_INT_MAX;
+}
+
+size_t write_raw_json(const RawRecord& record, char* out) {
+    char* p = out;
+    p = put_literal(p, "{\"id\":");
+    p = put_int(p, record.id);
+    p = put_literal(p, ",\"exchange\":\"");
+    p = put_string(p, record.exchange);
+    p = put_literal(p, "\",\"symbol\":\"");
+    p = put_string(p, record.symbol);
+    p = put_literal(p, "\",\"last\":");
+    p = put_double(p, record.last);
+    p = put_literal(p, ",\"bid\":");
+    p = put_double(p, record.bid);
+    p = put_literal(p, ",\"ask\":");
+    p = put_double(p, record.ask);
+    p = put_literal(p, ",\"high\":");
+    p = put_double(p, record.high);
+    p = put_literal(p, ",\"low\":");
+    p = put_double(p, record.low);
+    p = put_literal(p, ",\"volume\":");
+    p = put_double(p, record.volume);
+    p = put_literal(p, ",\"timestamp\":");
+    p = put_int(p, record.timestamp);
+    *p++ = '}';
+    return p - out;
+}
+
+size_t write_price_stats_json(const PriceStatsRecord& record, char* out) {
+    char* p = out;
+    p = put_literal(p, "{\"id\":");
+    p = put_int(p, record.id);
+    p = put_literal(p, ",\"symbol\":\"");
+    p = put_string(p, record.symbol);
+    p = put_literal(p, "\",\"highest_price\":");
+    p = put_double(p, record.highest_price);
+    p = put_literal(p, ",\"highest_exchange\":\"");
+    p = put_string(p, record.highest_exchange);
+    p = put_literal(p, "\",\"lowest_price\":");
+    p = put_double(p, record.lowest_price);
+    p = put_literal(p, ",\"lowest_exchange\":\"");
+    p = put_string(p, record.lowest_exchange);
+    p = put_literal(p, "\",\"record_count\":");
+    p = put_int(p, record.record_count);
+    p = put_literal(p, ",\"earliest_timestamp\":");
+    p = put_int(p, record.earliest_timestamp);
+    p = put_literal(p, ",\"latest_timestamp\":");
+    p = put_int(p, record.latest_timestamp);
+    *p++ = '}';
+    return p - out;
+}
+
+std::string encode_raw_json(const RawRecord& record) {
+    std::string value(raw_json_max_size(record), '\0');
+    value.resize(write_raw_json(record, value.data()));
+    return value;
+}
+
+std::string encode_price_stats_json(const PriceStatsRecord& record) {
+    std::string value(price_stats_json_max_size(record), '\0');
+    value.resize(write_price_stats_json(record, value.data()));
+    return value;
+}
+
+bool decode_raw_json(const char* data, size_t len, RawRecord& record) {
+    auto j = json::parse(data, data + len, nullptr, false);
+    if (j.is_discarded()) return false;
+
+    record.id        = j.value("id", 0);
+    record.exchange  = j.value("exchange", "");
+    record.symbol    = j.value("symbol", "");
+    record.last      = j.value("last", 0.0);
+    record.bid       = j.value("bid", 0.0);
+    record.ask       = j.value("ask", 0.0);
+    record.high      = j.value("high", 0.0);
+    record.low       = j.value("low", 0.0);
+    record.volume    = j.value("volume", 0.0);
+    record.timestamp = j.value("timestamp", 0LL);
+
+    return true;
+}
+
+bool decode_price_stats_json(const char* data, size_t len, PriceStatsRecord& record) {
+    auto j = json::parse(data, data + len, nullptr, false);
+    if (j.is_discarded()) return false;
+
+    record.id                 = j.value("id", 0);
+    record.symbol             = j.value("symbol", "");
+    record.highest_price      = j.value("highest_price", 0.0);
+    record.highest_exchange   = j.value("highest_exchange", "");
+    record.lowest_price       = j.value("lowest_price", 0.0);
+    record.lowest_exchange    = j.value("lowest_exchange", "");
+    record.record_count       = j.value("record_count", 0);
+    record.earliest_timestamp = j.value("earliest_timestamp", 0LL);
+    record.latest_timestamp   = j.value("latest_timestamp", 0LL);
+
+    return true;
+}
+
+ValueCodec select_codec(const std::vector<std::pair<std::string, ValueCodec>>& prefixes, const std::string& key) {
+    ValueCodec codec = ValueCodec::JSON;
+    size_t best = 0;
+    for (const auto& [prefix, prefix_codec] : prefixes) {
+        if (prefix.size() >= best && key.compare(0, prefix.size(), prefix) == 0) {
+            best = prefix.size();
+            codec = prefix_codec;
+        }
+    }
+    return codec;
+}
+
+char* JsonWriter::reserve(size_t len) {
+    if (size_ + len > buffer_.size()) {
+        buffer_.resize(std::max(buffer_.size() * 2, size_ + len));
+    }
+    return buffer_.data() + size_;
+}
+
+ValueSlice JsonWriter::append_raw(const RawRecord& record) {
+    char* p = reserve(raw_json_max_size(record));
+    ValueSlice slice{size_, write_raw_json(record, p)};
+    size_ += slice.len;
+    return slice;
+}
+
+ValueSlice JsonWriter::append_price_stats(const PriceStatsRecord& record) {
+    char* p = reserve(price_stats_json_max_size(record));
+    ValueSlice slice{size_, write_price_stats_json(record, p)};
+    size_ += slice.len;
+    return slice;
+}
+
+ValueSlice JsonWriter::append_bytes(const char* bytes, size_t len) {
+    char* p = reserve(len);
+    std::memcpy(p, bytes, len);
+    ValueSlice slice{size_, len};
+    size_ += len;
+    return slice;
+}
+
+bool InternTable::find_id(const std::string& name, uint32_t& id) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto it = ids_.find(name);
+    if (it == ids_.end()) return false;
+    id = it->second;
+    return true;
+}
+
+const std::string* InternTable::find_name(uint32_t id) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto it = names_.find(id);
+    return it == names_.end() ? nullptr : &it->second;
+}
+
+void InternTable::insert(uint32_t id, const std::string& name) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    ids_.emplace(name, id);
+    names_.emplace(id, name);
+}
+
+} // namespace market_codec
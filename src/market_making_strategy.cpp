@@ -6,8 +6,14 @@
 
 MarketMakingStrategy::MarketMakingStrategy(std::shared_ptr<RedisWriter> redis_client,
                                            const std::string& symbol,
-                                           const std::string& exchange)
-    : redis_client_(redis_client), symbol_(symbol), exchange_(exchange){
+                                           const std::string& exchange,
+                                           std::shared_ptr<MarketDataCache> market_cache)
+    : redis_client_(redis_client), market_cache_(market_cache), raw_slot_(nullptr),
+      symbol_(symbol), exchange_(exchange), max_staleness_ms_(0) {
+    
+    if (market_cache_) {
+        raw_slot_ = market_cache_->raw_slot(exchange_, symbol_);
+    }
     
     // 根据币种设置默认参数
     if (symbol == "BTC/USDT") {
@@ -33,6 +39,10 @@ MarketMakingStrategy::MarketMakingStrategy(std::shared_ptr<RedisWriter> redis_cl
 }
 
 StrategyResult MarketMakingStrategy::run_once() {
+    return run_once(get_market_data());
+}
+
+StrategyResult MarketMakingStrategy::run_once(const MarketData& market_data) {
     StrategyResult result;
 
     std::ostringstream header;
@@ -40,14 +50,24 @@ StrategyResult MarketMakingStrategy::run_once() {
     std::cout << header.str() << std::endl;
     result.logs.push_back(header.str());
 
-    // 1. 获取市场数据
-    auto market_data = get_market_data();
+    // 1. 检查市场数据
     if (!market_data.is_valid) {
         std::string err = "No valid market data available";
         std::cout << err << std::endl;
         result.logs.push_back(err);
         return result;
     }
+    
+    result.data_age_ms = market_data.read_at_ms - market_data.timestamp;
+    if (max_staleness_ms_ > 0 && result.data_age_ms > max_staleness_ms_) {
+        std::ostringstream stale;
+        stale << "Market data is stale (" << static_cast<long>(result.data_age_ms) << "ms old, max "
+              << max_staleness_ms_ << "ms), skipping this run";
+        std::cout << stale.str() << std::endl;
+        result.logs.push_back(stale.str());
+        result.skipped_stale = true;
+        return result;
+    }
 
     std::ostringstream info;
     info << "Market Data: Bid=" << market_data.bid
@@ -67,6 +87,7 @@ StrategyResult MarketMakingStrategy::run_once() {
     // 3. 计算报价
     double bid_price, ask_price;
     calculate_quotes(fair_value, bid_price, ask_price);
+    record_freshness(market_data, wall_clock_ms());
 
     // 4. 显示报价
     std::ostringstream quote;
@@ -96,7 +117,20 @@ StrategyResult MarketMakingStrategy::run_once() {
 
 MarketMakingStrategy::MarketData MarketMakingStrategy::get_market_data() {
     MarketData data;
-    data.is_valid = false;
+    
+    // 优先读进程内缓存，不经过网络
+    RawQuote quote;
+    if (raw_slot_ && raw_slot_->load(quote)) {
+        data.bid = quote.bid;
+        data.ask = quote.ask;
+        data.last = quote.last;
+        data.is_valid = true;
+        data.timestamp = quote.timestamp;
+        data.published_at_ms = quote.published_at_ms;
+        data.read_at_ms = wall_clock_ms();
+        std::cout << "Read market data from in-process cache, Timestamp: " << quote.timestamp << std::endl;
+        return data;
+    }
     
     try {
         std::string redis_key = get_redis_key();
@@ -110,6 +144,8 @@ MarketMakingStrategy::MarketData MarketMakingStrategy::get_market_data() {
             data.ask = record.ask;
             data.last = record.last;
             data.is_valid = true;
+            data.timestamp = record.timestamp;
+            data.read_at_ms = wall_clock_ms();
             
             std::cout << "Successfully read market data from Redis" << std::endl;
             std::cout << "   Exchange: " << record.exchange 
@@ -163,6 +199,15 @@ void MarketMakingStrategy::calculate_quotes(double fair_value, double& bid_price
 //     }
 // }
 
+void MarketMakingStrategy::record_freshness(const MarketData& data, double decided_at_ms) {
+    if (!freshness_tracker_) return;
+    if (data.published_at_ms > 0) {
+        freshness_tracker_->record(symbol_, FreshnessStage::WRITE_TO_STRATEGY, data.read_at_ms - data.published_at_ms);
+    }
+    freshness_tracker_->record(symbol_, FreshnessStage::READ_TO_DECISION, decided_at_ms - data.read_at_ms);
+    freshness_tracker_->record(symbol_, FreshnessStage::END_TO_END, decided_at_ms - data.timestamp);
+}
+
 void MarketMakingStrategy::set_spread_bps(double spread_bps) {
     spread_bps_ = spread_bps;
     std::cout << "Spread updated to: " << spread_bps << " bps" << std::endl;
@@ -174,7 +219,7 @@ void MarketMakingStrategy::set_order_size(double size) {
 }
 
 bool MarketMakingStrategy::is_healthy() const {
-    return redis_client_ && redis_client_->is_connected();
+    return market_cache_ || (redis_client_ && redis_client_->is_connected());
 }
 
 void MarketMakingStrategy::print_status() const {
@@ -183,7 +228,8 @@ void MarketMakingStrategy::print_status() const {
     std::cout << "  Exchange: " << exchange_ << std::endl;
     std::cout << "  Spread: " << spread_bps_ << " bps" << std::endl;
     std::cout << "  Order Size: " << order_size_ << std::endl;
-    std::cout << "  Redis Connected: " << (is_healthy() ? "YES" : "NO") << std::endl;
+    std::cout << "  Redis Connected: " << (redis_client_ && redis_client_->is_connected() ? "YES" : "NO") << std::endl;
+    std::cout << "  Market Cache: " << (market_cache_ ? "YES" : "NO") << std::endl;
 }
 
 std::string MarketMakingStrategy::get_redis_key() const {
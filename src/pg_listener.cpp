@@ -0,0 +1,124 @@
+#include "pg_listener.h"
+#include <libpq-fe.h>
+#include <poll.h>
+#include <iostream>
+#include <unordered_set>
+#include <chrono>
+
+namespace {
+// poll 超时，决定 stop() 的最长响应时间
+const int POLL_TIMEOUT_MS = 200;
+// 断线后的重连间隔
+const int RECONNECT_DELAY_MS = 1000;
+}
+
+PgNotificationListener::PgNotificationListener(const std::string& conninfo, const std::string& channel)
+    : conninfo_(conninfo), channel_(channel), conn_(nullptr), running_(false) {}
+
+PgNotificationListener::~PgNotificationListener() {
+    stop();
+}
+
+bool PgNotificationListener::connect() {
+    PGconn* conn = PQconnectdb(conninfo_.c_str());
+    if (PQstatus(conn) != CONNECTION_OK) {
+        std::cerr << "Listener connection to database failed: " << PQerrorMessage(conn) << std::endl;
+        PQfinish(conn);
+        return false;
+    }
+
+    char* ident = PQescapeIdentifier(conn, channel_.c_str(), channel_.size());
+    std::string sql = std::string("LISTEN ") + (ident ? ident : channel_.c_str());
+    if (ident) PQfreemem(ident);
+
+    PGresult* res = PQexec(conn, sql.c_str());
+    bool ok = PQresultStatus(res) == PGRES_COMMAND_OK;
+    if (!ok) {
+        std::cerr << "LISTEN " << channel_ << " failed: " << PQerrorMessage(conn) << std::endl;
+    }
+    PQclear(res);
+    if (!ok) {
+        PQfinish(conn);
+        return false;
+    }
+
+    conn_ = conn;
+    std::cout << "Listening on PostgreSQL channel: " << channel_ << std::endl;
+    return true;
+}
+
+void PgNotificationListener::disconnect() {
+    if (conn_) {
+        PQfinish((PGconn*)conn_);
+        conn_ = nullptr;
+    }
+}
+
+bool PgNotificationListener::start(Callback callback) {
+    if (running_) return true;
+    if (!connect()) return false;
+
+    callback_ = std::move(callback);
+    running_ = true;
+    thread_ = std::thread(&PgNotificationListener::run, this);
+    return true;
+}
+
+void PgNotificationListener::stop() {
+    if (!running_) return;
+    running_ = false;
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    disconnect();
+}
+
+void PgNotificationListener::run() {
+    std::vector<std::string> batch;
+    std::unordered_set<std::string> seen;
+
+    while (running_) {
+        if (!conn_ || PQstatus((PGconn*)conn_) != CONNECTION_OK) {
+            // 断线重连；重连前错过的通知由轮询心跳兜底
+            disconnect();
+            if (!connect()) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(RECONNECT_DELAY_MS));
+                continue;
+            }
+        }
+
+        PGconn* conn = (PGconn*)conn_;
+        pollfd pfd;
+        pfd.fd = PQsocket(conn);
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+
+        int ready = poll(&pfd, 1, POLL_TIMEOUT_MS);
+        if (ready <= 0) continue;
+
+        if (!PQconsumeInput(conn)) {
+            std::cerr << "Listener lost connection: " << PQerrorMessage(conn) << std::endl;
+            disconnect();
+            continue;
+        }
+
+        // 取出已经到达的全部通知，合并成一批
+        batch.clear();
+        seen.clear();
+        while (PGnotify* notify = PQnotifies(conn)) {
+            std::string payload = notify->extra ? notify->extra : "";
+            if (seen.insert(payload).second) {
+                batch.push_back(std::move(payload));
+            }
+            PQfreemem(notify);
+        }
+
+        if (!batch.empty() && callback_) {
+            try {
+                callback_(batch);
+            } catch (const std::exception& e) {
+                std::cerr << "Error handling notifications: " << e.what() << std::endl;
+            }
+        }
+    }
+}
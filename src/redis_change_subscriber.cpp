@@ -0,0 +1,174 @@
+#include "redis_change_subscriber.h"
+#include <hiredis/hiredis.h>
+#include <poll.h>
+#include <iostream>
+#include <unordered_set>
+#include <chrono>
+
+namespace {
+// poll 超时，决定 stop() 的最长响应时间
+const int POLL_TIMEOUT_MS = 200;
+// 断线后的重连间隔
+const int RECONNECT_DELAY_MS = 1000;
+}
+
+RedisChangeSubscriber::RedisChangeSubscriber(const std::string& host, int port, const std::string& password,
+                                             const std::string& channel)
+    : host_(host), port_(port), password_(password), channel_(channel), context_(nullptr), running_(false), connected_(false) {}
+
+RedisChangeSubscriber::~RedisChangeSubscriber() {
+    stop();
+}
+
+bool RedisChangeSubscriber::parse_payload(const std::string& payload, MarketChangeEvent& event) {
+    if (payload.compare(0, 6, "stats:") == 0) {
+        event.is_stats = true;
+        event.exchange.clear();
+        event.symbol = payload.substr(6);
+        return !event.symbol.empty();
+    }
+    if (payload.compare(0, 4, "raw:") == 0) {
+        // exchange 不含冒号，symbol 取剩余部分
+        size_t sep = payload.find(':', 4);
+        if (sep == std::string::npos) return false;
+        event.is_stats = false;
+        event.exchange = payload.substr(4, sep - 4);
+        event.symbol = payload.substr(sep + 1);
+        return !event.exchange.empty() && !event.symbol.empty();
+    }
+    return false;
+}
+
+bool RedisChangeSubscriber::connect() {
+    redisContext* context = redisConnect(host_.c_str(), port_);
+    if (context == nullptr || context->err) {
+        std::cerr << "Subscriber connection to Redis failed: "
+                  << (context ? context->errstr : "can't allocate redis context") << std::endl;
+        if (context) redisFree(context);
+        return false;
+    }
+
+    if (!password_.empty()) {
+        redisReply* reply = (redisReply*)redisCommand(context, "AUTH %s", password_.c_str());
+        bool ok = reply && reply->type != REDIS_REPLY_ERROR;
+        if (reply) freeReplyObject(reply);
+        if (!ok) {
+            std::cerr << "Subscriber Redis authentication failed" << std::endl;
+            redisFree(context);
+            return false;
+        }
+    }
+
+    redisReply* reply = (redisReply*)redisCommand(context, "SUBSCRIBE %s", channel_.c_str());
+    bool ok = reply && reply->type == REDIS_REPLY_ARRAY;
+    if (reply) freeReplyObject(reply);
+    if (!ok) {
+        std::cerr << "SUBSCRIBE " << channel_ << " failed" << std::endl;
+        redisFree(context);
+        return false;
+    }
+
+    context_ = context;
+    std::cout << "Subscribed to Redis channel: " << channel_ << std::endl;
+    return true;
+}
+
+void RedisChangeSubscriber::disconnect() {
+    if (context_) {
+        redisFree(context_);
+        context_ = nullptr;
+    }
+}
+
+bool RedisChangeSubscriber::start(Callback callback, StateCallback state_callback) {
+    if (running_) return true;
+    if (!connect()) return false;
+
+    callback_ = std::move(callback);
+    state_callback_ = std::move(state_callback);
+    connected_ = true;
+    running_ = true;
+    thread_ = std::thread(&RedisChangeSubscriber::run, this);
+    return true;
+}
+
+void RedisChangeSubscriber::stop() {
+    if (!running_) return;
+    running_ = false;
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    disconnect();
+    connected_ = false;
+}
+
+// 只在状态变化时回调
+void RedisChangeSubscriber::set_connected(bool connected) {
+    if (connected_.exchange(connected) == connected) return;
+    if (!state_callback_) return;
+    try {
+        state_callback_(connected);
+    } catch (const std::exception& e) {
+        std::cerr << "Error handling subscriber state change: " << e.what() << std::endl;
+    }
+}
+
+void RedisChangeSubscriber::run() {
+    std::vector<MarketChangeEvent> batch;
+    std::unordered_set<std::string> seen;
+
+    while (running_) {
+        if (!context_ || context_->err) {
+            // 断线重连；断线期间错过的变更不会重放，由状态回调通知调用方轮询和补跑
+            disconnect();
+            set_connected(false);
+            if (!connect()) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(RECONNECT_DELAY_MS));
+                continue;
+            }
+            set_connected(true);
+        }
+
+        // 阻塞读超时会让 hiredis 连接进入错误状态，所以先 poll，可读后再读入缓冲区
+        pollfd pfd;
+        pfd.fd = context_->fd;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+
+        int ready = poll(&pfd, 1, POLL_TIMEOUT_MS);
+        if (ready <= 0) continue;
+
+        if (redisBufferRead(context_) != REDIS_OK) {
+            std::cerr << "Subscriber lost connection: " << context_->errstr << std::endl;
+            disconnect();
+            continue;
+        }
+
+        // 取出缓冲区里已经完整的全部消息，合并成一批
+        batch.clear();
+        seen.clear();
+        void* raw = nullptr;
+        while (redisGetReplyFromReader(context_, &raw) == REDIS_OK && raw != nullptr) {
+            redisReply* reply = static_cast<redisReply*>(raw);
+            raw = nullptr;
+            // ["message", channel, payload]
+            if (reply->type == REDIS_REPLY_ARRAY && reply->elements == 3 &&
+                reply->element[2]->type == REDIS_REPLY_STRING) {
+                std::string payload(reply->element[2]->str, reply->element[2]->len);
+                MarketChangeEvent event;
+                if (seen.insert(payload).second && parse_payload(payload, event)) {
+                    batch.push_back(std::move(event));
+                }
+            }
+            freeReplyObject(reply);
+        }
+
+        if (!batch.empty() && callback_) {
+            try {
+                callback_(batch);
+            } catch (const std::exception& e) {
+                std::cerr << "Error handling change events: " << e.what() << std::endl;
+            }
+        }
+    }
+}
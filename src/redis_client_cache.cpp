@@ -0,0 +1,227 @@
+#include "redis_client_cache.h"
+#include <hiredis/hiredis.h>
+#include <poll.h>
+#include <iostream>
+#include <chrono>
+#include <mutex>
+
+namespace {
+// poll 超时，决定 stop() 的最长响应时间
+const int POLL_TIMEOUT_MS = 200;
+// 断线后的重连间隔
+const int RECONNECT_DELAY_MS = 1000;
+}
+
+RedisClientCache::RedisClientCache(const std::string& host, int port, const std::string& password,
+                                   size_t max_entries)
+    : host_(host), port_(port), password_(password), max_entries_(max_entries), context_(nullptr),
+      epoch_(0), active_(false), running_(false),
+      hits_(0), misses_(0), invalidations_(0), flushes_(0) {}
+
+RedisClientCache::~RedisClientCache() {
+    stop();
+}
+
+bool RedisClientCache::connect() {
+    redisContext* context = redisConnect(host_.c_str(), port_);
+    if (context == nullptr || context->err) {
+        std::cerr << "Client cache connection to Redis failed: "
+                  << (context ? context->errstr : "can't allocate redis context") << std::endl;
+        if (context) redisFree(context);
+        return false;
+    }
+
+    // HELLO 3 切换到 RESP3，失效消息以 push 类型到达；有密码时在 HELLO 里一并认证
+    redisReply* reply = password_.empty()
+        ? (redisReply*)redisCommand(context, "HELLO 3")
+        : (redisReply*)redisCommand(context, "HELLO 3 AUTH default %s", password_.c_str());
+    bool ok = reply && reply->type != REDIS_REPLY_ERROR;
+    if (!ok) {
+        std::cerr << "Client cache: HELLO 3 failed"
+                  << (reply && reply->str ? std::string(": ") + reply->str : "") << std::endl;
+    }
+    if (reply) freeReplyObject(reply);
+    if (!ok) {
+        redisFree(context);
+        return false;
+    }
+
+    // 广播模式：不需要记录读过哪些 key，前缀下任何 key 被修改都会通知本连接
+    reply = (redisReply*)redisCommand(context,
+        "CLIENT TRACKING on BCAST PREFIX crypto:raw: PREFIX crypto:stats:");
+    ok = reply && reply->type != REDIS_REPLY_ERROR;
+    if (!ok) {
+        std::cerr << "Client cache: CLIENT TRACKING failed"
+                  << (reply && reply->str ? std::string(": ") + reply->str : "") << std::endl;
+    }
+    if (reply) freeReplyObject(reply);
+    if (!ok) {
+        redisFree(context);
+        return false;
+    }
+
+    context_ = context;
+    std::cout << "Redis client-side cache tracking enabled" << std::endl;
+    return true;
+}
+
+void RedisClientCache::disconnect() {
+    if (context_) {
+        redisFree(context_);
+        context_ = nullptr;
+    }
+}
+
+bool RedisClientCache::start() {
+    if (running_) return true;
+    if (!connect()) return false;
+
+    running_ = true;
+    active_ = true;
+    thread_ = std::thread(&RedisClientCache::run, this);
+    return true;
+}
+
+void RedisClientCache::stop() {
+    if (!running_) return;
+    running_ = false;
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    disconnect();
+    invalidate_all();
+}
+
+void RedisClientCache::invalidate_all() {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    epoch_++;
+    raw_.clear();
+    stats_.clear();
+    flushes_++;
+}
+
+// ["invalidate", [key, ...]]；key 列表为 nil 表示 FLUSHDB/FLUSHALL
+void RedisClientCache::handle_push(const redisReply* reply) {
+    if (reply->elements < 2 || reply->element[0]->type != REDIS_REPLY_STRING ||
+        std::string(reply->element[0]->str, reply->element[0]->len) != "invalidate") {
+        return;
+    }
+
+    const redisReply* keys = reply->element[1];
+    if (keys->type != REDIS_REPLY_ARRAY) {
+        invalidate_all();
+        return;
+    }
+
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    epoch_++;
+    for (size_t i = 0; i < keys->elements; ++i) {
+        std::string key(keys->element[i]->str, keys->element[i]->len);
+        raw_.erase(key);
+        stats_.erase(key);
+    }
+    invalidations_ += keys->elements;
+}
+
+void RedisClientCache::run() {
+    while (running_) {
+        if (!context_ || context_->err) {
+            // 断线期间收不到失效消息，缓存整体失效并停止命中，重新开启跟踪后恢复
+            active_ = false;
+            invalidate_all();
+            disconnect();
+            if (!connect()) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(RECONNECT_DELAY_MS));
+                continue;
+            }
+            active_ = true;
+        }
+
+        // 阻塞读超时会让 hiredis 连接进入错误状态，所以先 poll，可读后再读入缓冲区
+        pollfd pfd;
+        pfd.fd = context_->fd;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+
+        int ready = poll(&pfd, 1, POLL_TIMEOUT_MS);
+        if (ready <= 0) continue;
+
+        if (redisBufferRead(context_) != REDIS_OK) {
+            std::cerr << "Client cache lost connection: " << context_->errstr << std::endl;
+            disconnect();
+            continue;
+        }
+
+        void* raw = nullptr;
+        while (redisGetReplyFromReader(context_, &raw) == REDIS_OK && raw != nullptr) {
+            redisReply* reply = static_cast<redisReply*>(raw);
+            raw = nullptr;
+            if (reply->type == REDIS_REPLY_PUSH) {
+                handle_push(reply);
+            }
+            freeReplyObject(reply);
+        }
+    }
+    active_ = false;
+}
+
+bool RedisClientCache::get_raw(const std::string& key, RawRecord& record) {
+    if (active_) {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        auto it = raw_.find(key);
+        if (it != raw_.end()) {
+            record = it->second;
+            hits_++;
+            return true;
+        }
+    }
+    misses_++;
+    return false;
+}
+
+bool RedisClientCache::get_price_stats(const std::string& key, PriceStatsRecord& record) {
+    if (active_) {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        auto it = stats_.find(key);
+        if (it != stats_.end()) {
+            record = it->second;
+            hits_++;
+            return true;
+        }
+    }
+    misses_++;
+    return false;
+}
+
+uint64_t RedisClientCache::epoch() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return epoch_;
+}
+
+void RedisClientCache::put_raw(const std::string& key, const RawRecord& record, uint64_t epoch) {
+    if (!active_) return;
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    // 读取 Redis 期间有过失效，读到的值可能已经过时
+    if (epoch != epoch_) return;
+    if (raw_.size() + stats_.size() >= max_entries_ && raw_.find(key) == raw_.end()) return;
+    raw_[key] = record;
+}
+
+void RedisClientCache::put_price_stats(const std::string& key, const PriceStatsRecord& record, uint64_t epoch) {
+    if (!active_) return;
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    if (epoch != epoch_) return;
+    if (raw_.size() + stats_.size() >= max_entries_ && stats_.find(key) == stats_.end()) return;
+    stats_[key] = record;
+}
+
+RedisClientCache::Stats RedisClientCache::stats() const {
+    Stats stats;
+    stats.hits = hits_;
+    stats.misses = misses_;
+    stats.invalidations = invalidations_;
+    stats.flushes = flushes_;
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    stats.entries = raw_.size() + stats_.size();
+    return stats;
+}
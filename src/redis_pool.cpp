@@ -0,0 +1,195 @@
+#include "redis_pool.h"
+#include <hiredis/hiredis.h>
+#include <iostream>
+
+RedisPool::Lease& RedisPool::Lease::operator=(Lease&& other) noexcept {
+    if (this != &other) {
+        release();
+        pool_ = other.pool_;
+        context_ = other.context_;
+        other.pool_ = nullptr;
+        other.context_ = nullptr;
+    }
+    return *this;
+}
+
+void RedisPool::Lease::invalidate() {
+    if (pool_ && context_) {
+        pool_->give_back(context_, true);
+        pool_ = nullptr;
+        context_ = nullptr;
+    }
+}
+
+void RedisPool::Lease::release() {
+    if (pool_ && context_) {
+        pool_->give_back(context_, context_->err != 0);
+    }
+    pool_ = nullptr;
+    context_ = nullptr;
+}
+
+RedisPool::RedisPool(const std::string& host, int port, const std::string& password, size_t size)
+    : host_(host), port_(port), password_(password), size_(size > 0 ? size : 1),
+      idle_check_after_(std::chrono::seconds(30)),
+      healthy_(false), last_recover_ns_(0), acquire_count_(0), wait_count_(0), reconnect_count_(0) {
+    idle_.resize(size_);
+
+    // 先建立一个连接，确认服务可达；其余连接第一次借出时再建立
+    redisContext* first = connect_one();
+    if (first) {
+        idle_.back().context = first;
+        idle_.back().last_used = std::chrono::steady_clock::now();
+    }
+}
+
+RedisPool::~RedisPool() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& slot : idle_) {
+        if (slot.context) redisFree(slot.context);
+    }
+    idle_.clear();
+}
+
+redisContext* RedisPool::connect_one() {
+    redisContext* context = redisConnect(host_.c_str(), port_);
+
+    if (context == nullptr || context->err) {
+        if (context) {
+            std::cerr << "Redis connection error: " << context->errstr << std::endl;
+            redisFree(context);
+        } else {
+            std::cerr << "Redis connection error: can't allocate redis context" << std::endl;
+        }
+        healthy_ = false;
+        return nullptr;
+    }
+
+    // 如果有密码，进行认证
+    if (!password_.empty()) {
+        redisReply* reply = (redisReply*)redisCommand(context, "AUTH %s", password_.c_str());
+        if (reply == nullptr || reply->type == REDIS_REPLY_ERROR) {
+            std::cerr << "Redis authentication failed" << std::endl;
+            if (reply) freeReplyObject(reply);
+            redisFree(context);
+            healthy_ = false;
+            return nullptr;
+        }
+        freeReplyObject(reply);
+    }
+
+    healthy_ = true;
+    return context;
+}
+
+bool RedisPool::ping(redisContext* context) {
+    redisReply* reply = (redisReply*)redisCommand(context, "PING");
+    bool ok = reply && reply->type != REDIS_REPLY_ERROR && context->err == 0;
+    if (reply) freeReplyObject(reply);
+    return ok;
+}
+
+RedisPool::Lease RedisPool::acquire(std::chrono::milliseconds timeout) {
+    Slot slot;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (idle_.empty()) {
+            wait_count_++;
+            if (!available_.wait_for(lock, timeout, [this] { return !idle_.empty(); })) {
+                std::cerr << "Timed out waiting for a Redis connection" << std::endl;
+                return Lease();
+            }
+        }
+        slot = idle_.back();
+        idle_.pop_back();
+    }
+    acquire_count_++;
+
+    // 连接检查和重连都在锁外进行，不阻塞其他借出
+    auto now = std::chrono::steady_clock::now();
+    if (slot.context && (slot.context->err || now - slot.last_used >= idle_check_after_) && !ping(slot.context)) {
+        redisFree(slot.context);
+        slot.context = nullptr;
+    }
+    if (!slot.context) {
+        slot.context = connect_one();
+        if (!slot.context) {
+            give_back(nullptr, false);
+            return Lease();
+        }
+        reconnect_count_++;
+    }
+    return Lease(this, slot.context);
+}
+
+void RedisPool::give_back(redisContext* context, bool broken) {
+    if (context && broken) {
+        redisFree(context);
+        context = nullptr;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        idle_.push_back(Slot{context, std::chrono::steady_clock::now()});
+    }
+    available_.notify_one();
+}
+
+size_t RedisPool::health_check() {
+    // 一次只取一个空闲槽位检查，检查完立即归还，其余槽位照常可借；
+    // 借出中的连接归还时自然会被检查。从最久未用的头部取，归还到尾部，
+    // 所以最多检查开始时的空闲数个槽位，不会重复检查同一个
+    size_t to_check;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        to_check = idle_.size();
+    }
+
+    size_t checked = 0;
+    size_t usable = 0;
+    for (size_t i = 0; i < to_check; ++i) {
+        Slot slot;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (idle_.empty()) break;
+            slot = idle_.front();
+            idle_.erase(idle_.begin());
+        }
+
+        if (slot.context && !ping(slot.context)) {
+            redisFree(slot.context);
+            slot.context = nullptr;
+        }
+        if (!slot.context) {
+            slot.context = connect_one();
+            if (slot.context) reconnect_count_++;
+        }
+        checked++;
+        if (slot.context) usable++;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            idle_.push_back(Slot{slot.context, std::chrono::steady_clock::now()});
+        }
+        available_.notify_one();
+    }
+    if (checked > 0) healthy_ = usable > 0;
+    return usable;
+}
+
+bool RedisPool::is_healthy() {
+    if (healthy_) return true;
+
+    int64_t now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    int64_t last = last_recover_ns_;
+    if (now_ns - last < std::chrono::nanoseconds(std::chrono::seconds(1)).count()) return false;
+    if (!last_recover_ns_.compare_exchange_strong(last, now_ns)) return false;
+
+    // 借出时会重连，成功后 healthy_ 恢复
+    return static_cast<bool>(acquire(std::chrono::milliseconds(0)));
+}
+
+size_t RedisPool::idle_count() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return idle_.size();
+}
@@ -1,149 +1,507 @@
 #include "redis_writer.h"
 #include "timescaledb_reader.h"  // 为了使用数据结构
+#include "market_data_codec.h"
+#include "redis_client_cache.h"
 #include <hiredis/hiredis.h>
 #include <iostream>
-#include <sstream>
-#include <iomanip>
-#include <nlohmann/json.hpp>
-using json = nlohmann::json;
+#include <chrono>
+#include <map>
+#include <cstring>
 
-RedisWriter::RedisWriter(const std::string& host, int port, const std::string& password)
-    : context_(nullptr), expire_time_(3600), host_(host), port_(port), password_(password) {
-    connect();
+using market_codec::ValueCodec;
+
+namespace {
+
+using redis_keys::RAW_INDEX;
+using redis_keys::RAW_EXCHANGE_INDEX_PREFIX;
+using redis_keys::RAW_SYMBOL_INDEX_PREFIX;
+using redis_keys::STATS_INDEX;
+using redis_keys::TICK_FIELD;
+using redis_keys::INTERN_IDS_KEY;
+using redis_keys::INTERN_NAMES_KEY;
+using redis_keys::INTERN_NEXT_KEY;
+
+const char* RAW_KEY_PATTERN = "crypto:raw:*";
+const char* TICK_STREAM_PATTERN = "crypto:stream:raw:*";
+const char* STATS_KEY_PATTERN = "crypto:stats:*";
+
+// 原子快照：版本计数器、当前状态哈希、状态字段的写入时间（有序集合）、
+// 基础快照版本列表（有序集合），以及增量 d:<n> / 基础快照 b:<n> 的 key 前缀
+const char* SNAPSHOT_VERSION_KEY = "crypto:snapshot:version";
+const char* SNAPSHOT_STATE_KEY = "crypto:snapshot:state";
+const char* SNAPSHOT_UPDATED_KEY = "crypto:snapshot:updated";
+const char* SNAPSHOT_BASES_KEY = "crypto:snapshot:bases";
+const char* SNAPSHOT_PREFIX = "crypto:snapshot:";
+const char* SNAPSHOT_DELTAS_PATTERN = "crypto:snapshot:d:*";
+const char* SNAPSHOT_BASE_KEYS_PATTERN = "crypto:snapshot:b:*";
+
+// 基础快照列表只保留最近这么多个版本号
+const int SNAPSHOT_MAX_BASES = 64;
+
+// KEYS: 版本计数器, 状态哈希, 写入时间, 前缀, 基础快照列表
+// ARGV: 数据 TTL, 快照保留秒数, 当前时间（秒）, 基础快照间隔, 基础快照列表上限, key1, value1, key2, value2, ...
+// 整个脚本原子执行，读者要么看到整个周期的更新，要么都看不到。
+// 每个版本只把本周期的字段写进增量哈希；latest-value key 已过期的字段从状态里删除，
+// 在增量里记为空值（数据值不会为空）。每隔若干版本把状态复制成一个基础快照，
+// 所以单次提交是 O(本周期记录数)，复制全量状态的代价摊到多个版本上
+const char* SNAPSHOT_WRITE_SCRIPT = R"lua(
+local version = redis.call('INCR', KEYS[1])
+local ttl = tonumber(ARGV[1])
+local retention = tonumber(ARGV[2])
+local now = tonumber(ARGV[3])
+local delta = KEYS[4] .. 'd:' .. version
+for i = 6, #ARGV, 2 do
+    redis.call('SET', ARGV[i], ARGV[i + 1], 'EX', ttl)
+    redis.call('HSET', KEYS[2], ARGV[i], ARGV[i + 1])
+    redis.call('HSET', delta, ARGV[i], ARGV[i + 1])
+    redis.call('ZADD', KEYS[3], now, ARGV[i])
+end
+local expired = redis.call('ZRANGEBYSCORE', KEYS[3], '-inf', now - ttl)
+for _, field in ipairs(expired) do
+    redis.call('HDEL', KEYS[2], field)
+    redis.call('HSET', delta, field, '')
+end
+if #expired > 0 then
+    redis.call('ZREMRANGEBYSCORE', KEYS[3], '-inf', now - ttl)
+end
+redis.call('EXPIRE', delta, retention)
+local last_base = redis.call('ZREVRANGE', KEYS[5], 0, 0)
+if #last_base == 0 or version - tonumber(last_base[1]) >= tonumber(ARGV[4]) then
+    local base = KEYS[4] .. 'b:' .. version
+    redis.call('COPY', KEYS[2], base, 'REPLACE')
+    -- 基础快照要覆盖它之后一整个间隔的增量，保留两倍时间
+    redis.call('EXPIRE', base, retention * 2)
+    redis.call('ZADD', KEYS[5], version, version)
+    redis.call('ZREMRANGEBYRANK', KEYS[5], 0, -tonumber(ARGV[5]) - 1)
+end
+return version
+)lua";
+
+// KEYS: 版本计数器, 状态哈希, 前缀, 基础快照列表；ARGV: 版本号（0 表示最新）。
+// 返回 {版本号, {field, value, ...}}。最新版本直接读状态哈希；
+// 历史版本从不晚于它的最近一个基础快照开始依次应用增量，任一部分已过期时返回 false
+const char* SNAPSHOT_READ_SCRIPT = R"lua(
+local latest = redis.call('GET', KEYS[1])
+if not latest then return false end
+local version = tonumber(ARGV[1])
+if version == 0 or version == tonumber(latest) then
+    return {latest, redis.call('HGETALL', KEYS[2])}
+end
+if version > tonumber(latest) then return false end
+local base = redis.call('ZREVRANGEBYSCORE', KEYS[4], version, '-inf', 'LIMIT', 0, 1)
+if #base == 0 then return false end
+local snapshot = redis.call('HGETALL', KEYS[3] .. 'b:' .. base[1])
+if #snapshot == 0 then return false end
+local fields = {}
+for i = 1, #snapshot, 2 do
+    fields[snapshot[i]] = snapshot[i + 1]
+end
+for v = tonumber(base[1]) + 1, version do
+    local delta = redis.call('HGETALL', KEYS[3] .. 'd:' .. v)
+    if #delta == 0 then return false end
+    for i = 1, #delta, 2 do
+        if delta[i + 1] == '' then
+            fields[delta[i]] = nil
+        else
+            fields[delta[i]] = delta[i + 1]
+        end
+    end
+end
+local result = {}
+for field, value in pairs(fields) do
+    result[#result + 1] = field
+    result[#result + 1] = value
+end
+return {ARGV[1], result}
+)lua";
+
+// 每批 SCAN/SSCAN 的 COUNT 提示，也是 MGET / DEL 的批大小上限
+const int SCAN_BATCH = 500;
+
+double elapsed_us(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+}
+
+// 以参数数组发送命令，key 和值可以包含空格等任意字节
+redisReply* command_argv(redisContext* ctx, const std::vector<std::string>& args) {
+    std::vector<const char*> argv;
+    std::vector<size_t> argvlen;
+    argv.reserve(args.size());
+    argvlen.reserve(args.size());
+    for (const auto& arg : args) {
+        argv.push_back(arg.data());
+        argvlen.push_back(arg.size());
+    }
+    return (redisReply*)redisCommandArgv(ctx, argv.size(), argv.data(), argvlen.data());
 }
 
-RedisWriter::~RedisWriter() {
-    disconnect();
+void append_argv(redisContext* ctx, const std::vector<std::string>& args) {
+    std::vector<const char*> argv;
+    std::vector<size_t> argvlen;
+    argv.reserve(args.size());
+    argvlen.reserve(args.size());
+    for (const auto& arg : args) {
+        argv.push_back(arg.data());
+        argvlen.push_back(arg.size());
+    }
+    redisAppendCommandArgv(ctx, argv.size(), argv.data(), argvlen.data());
 }
 
-bool RedisWriter::connect() {
-    context_ = redisConnect(host_.c_str(), port_);
+// 把一批 key 按索引集合分组，每个集合一条 SADD
+void append_index_adds(redisContext* ctx, const std::map<std::string, std::vector<std::string>>& index_members,
+                       size_t& appended) {
+    for (const auto& [index_key, members] : index_members) {
+        std::vector<std::string> args;
+        args.reserve(members.size() + 2);
+        args.push_back("SADD");
+        args.push_back(index_key);
+        args.insert(args.end(), members.begin(), members.end());
+        append_argv(ctx, args);
+        appended++;
+    }
+}
+
+// 用本线程复用的 argv 缓冲区发送 MGET，只取 indices 指定的 key
+redisReply* mget_argv(redisContext* ctx, const std::vector<std::string>& keys, const std::vector<size_t>& indices) {
+    thread_local std::vector<const char*> argv;
+    thread_local std::vector<size_t> argvlen;
+    argv.clear();
+    argvlen.clear();
+    argv.push_back("MGET");
+    argvlen.push_back(4);
+    for (size_t i : indices) {
+        argv.push_back(keys[i].data());
+        argvlen.push_back(keys[i].size());
+    }
+    return (redisReply*)redisCommandArgv(ctx, argv.size(), argv.data(), argvlen.data());
+}
+
+// 解析 XREAD / XREADGROUP 的回复：[[stream, [[id, [field, value, ...]], ...]], ...]，超时为 nil
+bool parse_stream_reply(const redisReply* reply, std::vector<std::pair<std::string, RawRecord>>& ticks) {
+    if (reply->type == REDIS_REPLY_NIL) return true;
+    if (reply->type != REDIS_REPLY_ARRAY) return false;
     
-    if (context_ == nullptr || context_->err) {
-        if (context_) {
-            std::cerr << "Redis connection error: " << context_->errstr << std::endl;
-            redisFree(context_);
-            context_ = nullptr;
-        } else {
-            std::cerr << "Redis connection error: can't allocate redis context" << std::endl;
+    for (size_t s = 0; s < reply->elements; ++s) {
+        const redisReply* stream = reply->element[s];
+        if (stream->type != REDIS_REPLY_ARRAY || stream->elements < 2) continue;
+        const redisReply* entries = stream->element[1];
+        for (size_t e = 0; e < entries->elements; ++e) {
+            const redisReply* entry = entries->element[e];
+            if (entry->type != REDIS_REPLY_ARRAY || entry->elements < 2) continue;
+            // 已确认后被裁剪掉的待处理条目，字段为 nil
+            const redisReply* fields = entry->element[1];
+            if (fields->type != REDIS_REPLY_ARRAY) continue;
+            
+            for (size_t f = 0; f + 1 < fields->elements; f += 2) {
+                const redisReply* name = fields->element[f];
+                const redisReply* value = fields->element[f + 1];
+                if (std::string(name->str, name->len) != TICK_FIELD) continue;
+                
+                RawRecord record;
+                if (market_codec::decode_raw_json(value->str, value->len, record)) {
+                    ticks.emplace_back(std::string(entry->element[0]->str, entry->element[0]->len),
+                                       std::move(record));
+                } else {
+                    std::cerr << "Failed to decode tick " << std::string(entry->element[0]->str) << std::endl;
+                }
+                break;
+            }
         }
+    }
+    return true;
+}
+
+} // namespace
+
+RedisWriter::RedisWriter(const std::string& host, int port, const std::string& password, size_t pool_size)
+    : RedisWriter(std::make_shared<RedisPool>(host, port, password, pool_size)) {}
+
+RedisWriter::RedisWriter(std::shared_ptr<RedisPool> pool)
+    : pool_(std::move(pool)), expire_time_(3600), tick_stream_max_len_(0), snapshot_retention_(300), snapshot_base_interval_(20),
+      interned_(std::make_shared<market_codec::InternTable>()) {
+    if (pool_->is_healthy()) {
+        std::cout << "Connected to Redis successfully" << std::endl;
+    }
+}
+
+RedisWriter::~RedisWriter() = default;
+
+bool RedisWriter::is_connected() const {
+    return pool_->is_healthy();
+}
+
+bool RedisWriter::enable_client_cache(size_t max_entries) {
+    if (client_cache_) return true;
+    auto cache = std::make_unique<RedisClientCache>(pool_->host(), pool_->port(), pool_->password(), max_entries);
+    if (!cache->start()) {
+        std::cerr << "Client-side cache unavailable (requires Redis 6+ with RESP3)" << std::endl;
         return false;
     }
+    client_cache_ = std::move(cache);
+    return true;
+}
+
+std::string RedisWriter::get_raw_key(const std::string& exchange, const std::string& symbol) {
+    return redis_keys::raw_key(exchange, symbol);
+}
+
+std::string RedisWriter::get_price_stats_key(const std::string& symbol) {
+    return redis_keys::price_stats_key(symbol);
+}
+
+void RedisWriter::set_codec(const std::string& key_prefix, ValueCodec codec) {
+    for (auto& entry : codecs_) {
+        if (entry.first == key_prefix) {
+            entry.second = codec;
+            return;
+        }
+    }
+    codecs_.emplace_back(key_prefix, codec);
+}
+
+ValueCodec RedisWriter::codec_for(const std::string& key) const {
+    return market_codec::select_codec(codecs_, key);
+}
+
+// 名字 → id：先查本地表，再查 Redis，都没有时分配新 id。
+// 多个写入者同时分配时以 HSETNX 成功的那个为准，落败方丢弃自己拿到的 id
+bool RedisWriter::intern(redisContext* ctx, const std::string& name, uint32_t& id) {
+    if (interned_->find_id(name, id)) return true;
     
-    // 如果有密码，进行认证
-    if (!password_.empty()) {
-        redisReply* reply = (redisReply*)redisCommand(context_, "AUTH %s", password_.c_str());
-        if (reply == nullptr || reply->type == REDIS_REPLY_ERROR) {
-            std::cerr << "Redis authentication failed" << std::endl;
+    redisReply* reply = (redisReply*)redisCommand(ctx, "HGET %s %b", INTERN_IDS_KEY, name.data(), name.size());
+    if (reply && reply->type == REDIS_REPLY_STRING) {
+        id = static_cast<uint32_t>(std::stoul(std::string(reply->str, reply->len)));
+        freeReplyObject(reply);
+        interned_->insert(id, name);
+        return true;
+    }
+    if (reply) freeReplyObject(reply);
+    
+    reply = (redisReply*)redisCommand(ctx, "INCR %s", INTERN_NEXT_KEY);
+    if (reply == nullptr || reply->type != REDIS_REPLY_INTEGER) {
+        std::cerr << "Failed to allocate intern id for " << name << std::endl;
+        if (reply) freeReplyObject(reply);
+        return false;
+    }
+    std::string candidate = std::to_string(reply->integer);
+    freeReplyObject(reply);
+    
+    reply = (redisReply*)redisCommand(ctx, "HSETNX %s %b %s", INTERN_IDS_KEY, name.data(), name.size(), candidate.c_str());
+    bool won = reply && reply->type == REDIS_REPLY_INTEGER && reply->integer == 1;
+    if (reply) freeReplyObject(reply);
+    if (!won) {
+        reply = (redisReply*)redisCommand(ctx, "HGET %s %b", INTERN_IDS_KEY, name.data(), name.size());
+        if (reply == nullptr || reply->type != REDIS_REPLY_STRING) {
             if (reply) freeReplyObject(reply);
-            disconnect();
             return false;
         }
+        candidate.assign(reply->str, reply->len);
         freeReplyObject(reply);
     }
     
-    std::cout << "Connected to Redis successfully" << std::endl;
+    reply = (redisReply*)redisCommand(ctx, "HSETNX %s %s %b", INTERN_NAMES_KEY, candidate.c_str(), name.data(), name.size());
+    if (reply) freeReplyObject(reply);
+    
+    id = static_cast<uint32_t>(std::stoul(candidate));
+    interned_->insert(id, name);
     return true;
 }
 
-void RedisWriter::disconnect() {
-    if (context_) {
-        redisFree(context_);
-        context_ = nullptr;
+// id → 名字，本地没有时查 Redis；未知 id 返回 nullptr
+const std::string* RedisWriter::resolve_name(redisContext* ctx, uint32_t id) {
+    if (const std::string* name = interned_->find_name(id)) return name;
+    
+    redisReply* reply = (redisReply*)redisCommand(ctx, "HGET %s %u", INTERN_NAMES_KEY, id);
+    if (reply == nullptr || reply->type != REDIS_REPLY_STRING) {
+        if (reply) freeReplyObject(reply);
+        return nullptr;
     }
+    interned_->insert(id, std::string(reply->str, reply->len));
+    freeReplyObject(reply);
+    return interned_->find_name(id);
 }
 
-bool RedisWriter::is_connected() const {
-    return context_ != nullptr && context_->err == 0;
+// 新名字的 id 分配需要同步访问 Redis，必须在追加 pipeline 之前完成
+void RedisWriter::intern_names(redisContext* ctx, const std::vector<RawRecord>& records) {
+    uint32_t id;
+    for (const auto& record : records) {
+        if (codec_for(get_raw_key(record.exchange, record.symbol)) != ValueCodec::BINARY) continue;
+        intern(ctx, record.exchange, id);
+        intern(ctx, record.symbol, id);
+    }
 }
 
-std::string RedisWriter::get_raw_key(const std::string& exchange, const std::string& symbol) {
-    return "crypto:raw:" + exchange + ":" + symbol;
+void RedisWriter::intern_names(redisContext* ctx, const std::vector<PriceStatsRecord>& records) {
+    uint32_t id;
+    for (const auto& record : records) {
+        if (codec_for(get_price_stats_key(record.symbol)) != ValueCodec::BINARY) continue;
+        intern(ctx, record.symbol, id);
+        intern(ctx, record.highest_exchange, id);
+        intern(ctx, record.lowest_exchange, id);
+    }
 }
 
-std::string RedisWriter::get_price_stats_key(const std::string& symbol) {
-    return "crypto:stats:" + symbol;
-}
-
-std::string RedisWriter::serialize_raw_record(const RawRecord& record) {
-    std::ostringstream oss;
-    oss << std::fixed << std::setprecision(8);
-    oss << "{"
-        << "\"id\":" << record.id << ","
-        << "\"exchange\":\"" << record.exchange << "\","
-        << "\"symbol\":\"" << record.symbol << "\","
-        << "\"last\":" << record.last << ","
-        << "\"bid\":" << record.bid << ","
-        << "\"ask\":" << record.ask << ","
-        << "\"high\":" << record.high << ","
-        << "\"low\":" << record.low << ","
-        << "\"volume\":" << record.volume << ","
-        << "\"timestamp\":" << record.timestamp
-        << "}";
-    return oss.str();
-}
-
-std::string RedisWriter::serialize_price_stats_record(const PriceStatsRecord& record) {
-    std::ostringstream oss;
-    oss << std::fixed << std::setprecision(8);
-    oss << "{"
-        << "\"id\":" << record.id << ","
-        << "\"symbol\":\"" << record.symbol << "\","
-        << "\"highest_price\":" << record.highest_price << ","
-        << "\"highest_exchange\":\"" << record.highest_exchange << "\","
-        << "\"lowest_price\":" << record.lowest_price << ","
-        << "\"lowest_exchange\":\"" << record.lowest_exchange << "\","
-        << "\"record_count\":" << record.record_count << ","
-        << "\"earliest_timestamp\":" << record.earliest_timestamp << ","
-        << "\"latest_timestamp\":" << record.latest_timestamp
-        << "}";
-    return oss.str();
+// 按 key 选择编码追加到 out；缺少 intern id 时（Redis 分配失败）退回 JSON
+market_codec::ValueSlice RedisWriter::encode_raw_value(const std::string& key, const RawRecord& record,
+                                                              market_codec::JsonWriter& out) const {
+    uint32_t exchange_id, symbol_id;
+    if (codec_for(key) == ValueCodec::BINARY &&
+        interned_->find_id(record.exchange, exchange_id) && interned_->find_id(record.symbol, symbol_id)) {
+        char buf[market_codec::RAW_BINARY_SIZE];
+        size_t len = market_codec::encode_raw(record, exchange_id, symbol_id, buf);
+        return out.append_bytes(buf, len);
+    }
+    return out.append_raw(record);
+}
+
+market_codec::ValueSlice RedisWriter::encode_price_stats_value(const std::string& key,
+                                                                      const PriceStatsRecord& record,
+                                                                      market_codec::JsonWriter& out) const {
+    uint32_t symbol_id, highest_id, lowest_id;
+    if (codec_for(key) == ValueCodec::BINARY &&
+        interned_->find_id(record.symbol, symbol_id) &&
+        interned_->find_id(record.highest_exchange, highest_id) &&
+        interned_->find_id(record.lowest_exchange, lowest_id)) {
+        char buf[market_codec::PRICE_STATS_BINARY_SIZE];
+        size_t len = market_codec::encode_price_stats(record, symbol_id, highest_id, lowest_id, buf);
+        return out.append_bytes(buf, len);
+    }
+    return out.append_price_stats(record);
+}
+
+// 每条记录一条 SETEX。整批先编码进同一块复用的缓冲区，再逐条追加到 pipeline
+size_t RedisWriter::append_raw_sets(redisContext* ctx, const std::vector<RawRecord>& records) {
+    thread_local market_codec::JsonWriter values;
+    thread_local std::vector<std::string> keys;
+    thread_local std::vector<market_codec::ValueSlice> slices;
+    values.clear();
+    keys.resize(records.size());
+    slices.resize(records.size());
+    
+    for (size_t i = 0; i < records.size(); ++i) {
+        keys[i] = get_raw_key(records[i].exchange, records[i].symbol);
+        slices[i] = encode_raw_value(keys[i], records[i], values);
+    }
+    int expire = expire_time_.load();
+    for (size_t i = 0; i < records.size(); ++i) {
+        redisAppendCommand(ctx, "SETEX %s %d %b", keys[i].c_str(), expire, values.data(slices[i]), slices[i].len);
+    }
+    return records.size();
+}
+
+size_t RedisWriter::append_price_stats_sets(redisContext* ctx, const std::vector<PriceStatsRecord>& records) {
+    thread_local market_codec::JsonWriter values;
+    thread_local std::vector<std::string> keys;
+    thread_local std::vector<market_codec::ValueSlice> slices;
+    values.clear();
+    keys.resize(records.size());
+    slices.resize(records.size());
+    
+    for (size_t i = 0; i < records.size(); ++i) {
+        keys[i] = get_price_stats_key(records[i].symbol);
+        slices[i] = encode_price_stats_value(keys[i], records[i], values);
+    }
+    int expire = expire_time_.load();
+    for (size_t i = 0; i < records.size(); ++i) {
+        redisAppendCommand(ctx, "SETEX %s %d %b", keys[i].c_str(), expire, values.data(slices[i]), slices[i].len);
+    }
+    return records.size();
+}
+
+// 按首字节识别格式
+bool RedisWriter::decode_raw_value(redisContext* ctx, const char* data, size_t len, RawRecord& record) {
+    if (!market_codec::is_binary(data, len)) {
+        return market_codec::decode_raw_json(data, len, record);
+    }
+    market_codec::RawBinary bin;
+    if (!market_codec::decode_raw(data, len, bin)) return false;
+    const std::string* exchange = resolve_name(ctx, bin.exchange_id);
+    const std::string* symbol = resolve_name(ctx, bin.symbol_id);
+    if (!exchange || !symbol) return false;
+    
+    record.id = bin.id;
+    record.exchange.assign(*exchange);
+    record.symbol.assign(*symbol);
+    record.last = bin.last;
+    record.bid = bin.bid;
+    record.ask = bin.ask;
+    record.high = bin.high;
+    record.low = bin.low;
+    record.volume = bin.volume;
+    record.timestamp = bin.timestamp;
+    return true;
+}
+
+bool RedisWriter::decode_price_stats_value(redisContext* ctx, const char* data, size_t len, PriceStatsRecord& record) {
+    if (!market_codec::is_binary(data, len)) {
+        return market_codec::decode_price_stats_json(data, len, record);
+    }
+    market_codec::PriceStatsBinary bin;
+    if (!market_codec::decode_price_stats(data, len, bin)) return false;
+    const std::string* symbol = resolve_name(ctx, bin.symbol_id);
+    const std::string* highest_exchange = resolve_name(ctx, bin.highest_exchange_id);
+    const std::string* lowest_exchange = resolve_name(ctx, bin.lowest_exchange_id);
+    if (!symbol || !highest_exchange || !lowest_exchange) return false;
+    
+    record.id = bin.id;
+    record.symbol.assign(*symbol);
+    record.highest_price = bin.highest_price;
+    record.highest_exchange.assign(*highest_exchange);
+    record.lowest_price = bin.lowest_price;
+    record.lowest_exchange.assign(*lowest_exchange);
+    record.record_count = bin.record_count;
+    record.earliest_timestamp = bin.earliest_timestamp;
+    record.latest_timestamp = bin.latest_timestamp;
+    return true;
 }
 
 bool RedisWriter::write_raw_record(const RawRecord& record) {
-    if (!is_connected()) {
+    auto conn = pool_->acquire();
+    if (!conn) {
         std::cerr << "Redis not connected" << std::endl;
         return false;
     }
+    redisContext* ctx = conn.get();
     
-    std::string key = get_raw_key(record.exchange, record.symbol);
-    std::string value = serialize_raw_record(record);
+    std::vector<RawRecord> records{record};
+    intern_names(ctx, records);
+    append_raw_sets(ctx, records);
+    size_t index_commands = append_raw_index(ctx, records);
+    index_commands += append_tick_streams(ctx, records);
+    index_commands += append_change_events(ctx, records);
     
-    redisReply* reply = (redisReply*)redisCommand(context_, 
-        "SETEX %s %d %s", key.c_str(), expire_time_, value.c_str());
-    
-    if (reply == nullptr || reply->type == REDIS_REPLY_ERROR) {
+    if (!drain_replies(ctx, 1 + index_commands, "raw record write")) {
         std::cerr << "Failed to write raw record to Redis" << std::endl;
-        if (reply) freeReplyObject(reply);
         return false;
     }
-    
-    freeReplyObject(reply);
     return true;
 }
 
-bool RedisWriter::write_raw_records(const std::vector<RawRecord>& records) {
-    if (!is_connected()) {
+bool RedisWriter::write_raw_records(const std::vector<RawRecord>& records, RedisWriteTiming* timing) {
+    auto conn = pool_->acquire();
+    if (!conn) {
         std::cerr << "Redis not connected" << std::endl;
         return false;
     }
+    redisContext* ctx = conn.get();
     
     if (records.empty()) return true;
     
     // 使用 pipeline 提高性能
-    for (const auto& record : records) {
-        std::string key = get_raw_key(record.exchange, record.symbol);
-        std::string value = serialize_raw_record(record);
-        
-        redisAppendCommand(context_, "SETEX %s %d %s", 
-            key.c_str(), expire_time_, value.c_str());
-    }
+    auto serialize_start = std::chrono::steady_clock::now();
+    intern_names(ctx, records);
+    append_raw_sets(ctx, records);
+    size_t index_commands = append_raw_index(ctx, records);
+    size_t stream_commands = append_tick_streams(ctx, records);
+    stream_commands += append_change_events(ctx, records);
+    if (timing) timing->serialize_us += elapsed_us(serialize_start);
     
-    // 获取所有回复
+    // 获取所有回复（第一次 redisGetReply 时发送整个 pipeline）
+    auto flush_start = std::chrono::steady_clock::now();
     bool success = true;
     for (size_t i = 0; i < records.size(); ++i) {
         redisReply* reply;
-        if (redisGetReply(context_, (void**)&reply) != REDIS_OK) {
+        if (redisGetReply(ctx, (void**)&reply) != REDIS_OK) {
             success = false;
             std::cerr << "Failed to get reply for raw record " << i << std::endl;
             continue;
@@ -156,55 +514,59 @@ bool RedisWriter::write_raw_records(const std::vector<RawRecord>& records) {
         
         freeReplyObject(reply);
     }
+    success = drain_replies(ctx, index_commands, "raw index") && success;
+    success = drain_replies(ctx, stream_commands, "tick stream / change event") && success;
+    if (timing) timing->flush_us += elapsed_us(flush_start);
     
     std::cout << "Wrote " << records.size() << " raw records to Redis" << std::endl;
     return success;
 }
 
 bool RedisWriter::write_price_stats_record(const PriceStatsRecord& record) {
-    if (!is_connected()) {
+    auto conn = pool_->acquire();
+    if (!conn) {
         std::cerr << "Redis not connected" << std::endl;
         return false;
     }
+    redisContext* ctx = conn.get();
     
-    std::string key = get_price_stats_key(record.symbol);
-    std::string value = serialize_price_stats_record(record);
-    
-    redisReply* reply = (redisReply*)redisCommand(context_, 
-        "SETEX %s %d %s", key.c_str(), expire_time_, value.c_str());
+    std::vector<PriceStatsRecord> records{record};
+    intern_names(ctx, records);
+    append_price_stats_sets(ctx, records);
+    size_t index_commands = append_price_stats_index(ctx, records);
+    index_commands += append_change_events(ctx, records);
     
-    if (reply == nullptr || reply->type == REDIS_REPLY_ERROR) {
+    if (!drain_replies(ctx, 1 + index_commands, "price stats record write")) {
         std::cerr << "Failed to write price stats record to Redis" << std::endl;
-        if (reply) freeReplyObject(reply);
         return false;
     }
-    
-    freeReplyObject(reply);
     return true;
 }
 
-bool RedisWriter::write_price_stats_records(const std::vector<PriceStatsRecord>& records) {
-    if (!is_connected()) {
+bool RedisWriter::write_price_stats_records(const std::vector<PriceStatsRecord>& records, RedisWriteTiming* timing) {
+    auto conn = pool_->acquire();
+    if (!conn) {
         std::cerr << "Redis not connected" << std::endl;
         return false;
     }
+    redisContext* ctx = conn.get();
     
     if (records.empty()) return true;
     
     // 使用 pipeline 提高性能
-    for (const auto& record : records) {
-        std::string key = get_price_stats_key(record.symbol);
-        std::string value = serialize_price_stats_record(record);
-        
-        redisAppendCommand(context_, "SETEX %s %d %s", 
-            key.c_str(), expire_time_, value.c_str());
-    }
+    auto serialize_start = std::chrono::steady_clock::now();
+    intern_names(ctx, records);
+    append_price_stats_sets(ctx, records);
+    size_t index_commands = append_price_stats_index(ctx, records);
+    index_commands += append_change_events(ctx, records);
+    if (timing) timing->serialize_us += elapsed_us(serialize_start);
     
-    // 获取所有回复
+    // 获取所有回复（第一次 redisGetReply 时发送整个 pipeline）
+    auto flush_start = std::chrono::steady_clock::now();
     bool success = true;
     for (size_t i = 0; i < records.size(); ++i) {
         redisReply* reply;
-        if (redisGetReply(context_, (void**)&reply) != REDIS_OK) {
+        if (redisGetReply(ctx, (void**)&reply) != REDIS_OK) {
             success = false;
             std::cerr << "Failed to get reply for price stats record " << i << std::endl;
             continue;
@@ -217,153 +579,534 @@ bool RedisWriter::write_price_stats_records(const std::vector<PriceStatsRecord>&
         
         freeReplyObject(reply);
     }
+    success = drain_replies(ctx, index_commands, "price stats index") && success;
+    if (timing) timing->flush_us += elapsed_us(flush_start);
     
     std::cout << "Wrote " << records.size() << " price stats records to Redis" << std::endl;
     return success;
 }
 
-RawRecord RedisWriter::deserialize_raw_record(const std::string& json_str) {
-    RawRecord record;
-    auto j = json::parse(json_str);
+// 索引维护命令追加在同一个 pipeline 里，返回追加的命令数
+size_t RedisWriter::append_raw_index(redisContext* ctx, const std::vector<RawRecord>& records) {
+    std::map<std::string, std::vector<std::string>> index_members;
+    for (const auto& record : records) {
+        std::string key = get_raw_key(record.exchange, record.symbol);
+        index_members[RAW_EXCHANGE_INDEX_PREFIX + record.exchange].push_back(key);
+        index_members[RAW_SYMBOL_INDEX_PREFIX + record.symbol].push_back(key);
+        index_members[RAW_INDEX].push_back(std::move(key));
+    }
+    size_t appended = 0;
+    append_index_adds(ctx, index_members, appended);
+    return appended;
+}
 
-    record.id        = j.value("id", 0);
-    record.exchange  = j.value("exchange", "");
-    record.symbol    = j.value("symbol", "");
-    record.last      = j.value("last", 0.0);
-    record.bid       = j.value("bid", 0.0);
-    record.ask       = j.value("ask", 0.0);
-    record.high      = j.value("high", 0.0);
-    record.low       = j.value("low", 0.0);
-    record.volume    = j.value("volume", 0.0);
-    record.timestamp = j.value("timestamp", 0LL);
+size_t RedisWriter::append_price_stats_index(redisContext* ctx, const std::vector<PriceStatsRecord>& records) {
+    std::map<std::string, std::vector<std::string>> index_members;
+    for (const auto& record : records) {
+        index_members[STATS_INDEX].push_back(get_price_stats_key(record.symbol));
+    }
+    size_t appended = 0;
+    append_index_adds(ctx, index_members, appended);
+    return appended;
+}
 
-    return record;
+// 开启 tick 流时每条记录一条 XADD，MAXLEN ~ 让 Redis 按整个宏节点裁剪，开销接近 O(1)
+size_t RedisWriter::append_tick_streams(redisContext* ctx, const std::vector<RawRecord>& records) {
+    size_t max_len = tick_stream_max_len_;
+    if (max_len == 0) return 0;
+    
+    thread_local market_codec::JsonWriter values;
+    thread_local std::vector<market_codec::ValueSlice> slices;
+    values.clear();
+    slices.resize(records.size());
+    for (size_t i = 0; i < records.size(); ++i) {
+        slices[i] = values.append_raw(records[i]);
+    }
+    
+    std::string max_len_arg = std::to_string(max_len);
+    for (size_t i = 0; i < records.size(); ++i) {
+        std::string key = redis_keys::tick_stream_key(records[i].symbol);
+        const char* argv[] = {"XADD", key.c_str(), "MAXLEN", "~", max_len_arg.c_str(), "*", TICK_FIELD,
+                              values.data(slices[i])};
+        size_t argvlen[] = {4, key.size(), 6, 1, max_len_arg.size(), 1, std::strlen(TICK_FIELD), slices[i].len};
+        redisAppendCommandArgv(ctx, 8, argv, argvlen);
+    }
+    return records.size();
 }
 
-PriceStatsRecord RedisWriter::deserialize_price_stats_record(const std::string& json_str) {
-    PriceStatsRecord record;
-    auto j = json::parse(json_str);
+// 每条记录一条 PUBLISH，没有订阅者时 Redis 只做一次频道查找
+size_t RedisWriter::append_change_events(redisContext* ctx, const std::vector<RawRecord>& records) {
+    if (change_channel_.empty()) return 0;
+    for (const auto& record : records) {
+        append_argv(ctx, {"PUBLISH", change_channel_, redis_keys::raw_change_payload(record.exchange, record.symbol)});
+    }
+    return records.size();
+}
 
-    record.id                 = j.value("id", 0);
-    record.symbol             = j.value("symbol", "");
-    record.highest_price      = j.value("highest_price", 0.0);
-    record.highest_exchange   = j.value("highest_exchange", "");
-    record.lowest_price       = j.value("lowest_price", 0.0);
-    record.lowest_exchange    = j.value("lowest_exchange", "");
-    record.record_count       = j.value("record_count", 0);
-    record.earliest_timestamp = j.value("earliest_timestamp", 0LL);
-    record.latest_timestamp   = j.value("latest_timestamp", 0LL);
+size_t RedisWriter::append_change_events(redisContext* ctx, const std::vector<PriceStatsRecord>& records) {
+    if (change_channel_.empty()) return 0;
+    for (const auto& record : records) {
+        append_argv(ctx, {"PUBLISH", change_channel_, redis_keys::price_stats_change_payload(record.symbol)});
+    }
+    return records.size();
+}
 
-    return record;
+bool RedisWriter::drain_replies(redisContext* ctx, size_t count, const char* what) {
+    bool success = true;
+    for (size_t i = 0; i < count; ++i) {
+        redisReply* reply;
+        if (redisGetReply(ctx, (void**)&reply) != REDIS_OK) {
+            std::cerr << "Failed to get reply for " << what << " command " << i << std::endl;
+            return false;
+        }
+        if (reply->type == REDIS_REPLY_ERROR) {
+            success = false;
+            std::cerr << "Error in " << what << " command " << i << ": " << reply->str << std::endl;
+        }
+        freeReplyObject(reply);
+    }
+    return success;
 }
 
-bool RedisWriter::read_raw_record(const std::string& exchange, const std::string& symbol, RawRecord& record) {
-    if (!is_connected()) return false;
+bool RedisWriter::expire_keys(redisContext* ctx, const std::vector<std::string>& keys, std::vector<size_t>& missing) {
+    missing.clear();
+    if (keys.empty()) return true;
     
+    for (const auto& key : keys) {
+        redisAppendCommand(ctx, "EXPIRE %s %d", key.c_str(), expire_time_.load());
+    }
+    // 快照状态按写入时间清理过期字段；续期的 key 同时刷新时间，XX 只更新已在快照里的字段
+    std::string now_sec = std::to_string(std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+    std::vector<std::string> touch{"ZADD", SNAPSHOT_UPDATED_KEY, "XX"};
+    touch.reserve(touch.size() + 2 * keys.size());
+    for (const auto& key : keys) {
+        touch.push_back(now_sec);
+        touch.push_back(key);
+    }
+    append_argv(ctx, touch);
+    
+    bool success = true;
+    for (size_t i = 0; i < keys.size(); ++i) {
+        redisReply* reply;
+        if (redisGetReply(ctx, (void**)&reply) != REDIS_OK) {
+            success = false;
+            std::cerr << "Failed to get reply for EXPIRE " << i << std::endl;
+            continue;
+        }
+        
+        // EXPIRE 对不存在的 key 返回 0
+        if (reply->type == REDIS_REPLY_INTEGER && reply->integer == 0) {
+            missing.push_back(i);
+        } else if (reply->type == REDIS_REPLY_ERROR) {
+            success = false;
+            std::cerr << "Error refreshing TTL " << i << ": " << reply->str << std::endl;
+        }
+        
+        freeReplyObject(reply);
+    }
+    success = drain_replies(ctx, 1, "snapshot TTL touch") && success;
+    
+    return success;
+}
+
+bool RedisWriter::refresh_raw_ttl(const std::vector<std::pair<std::string, std::string>>& instruments,
+                                  std::vector<size_t>& missing) {
+    std::vector<std::string> keys;
+    keys.reserve(instruments.size());
+    for (const auto& [exchange, symbol] : instruments) {
+        keys.push_back(get_raw_key(exchange, symbol));
+    }
+    
+    missing.clear();
+    auto conn = pool_->acquire();
+    if (!conn) {
+        std::cerr << "Redis not connected" << std::endl;
+        return false;
+    }
+    return expire_keys(conn.get(), keys, missing);
+}
+
+bool RedisWriter::refresh_price_stats_ttl(const std::vector<std::string>& symbols, std::vector<size_t>& missing) {
+    std::vector<std::string> keys;
+    keys.reserve(symbols.size());
+    for (const auto& symbol : symbols) {
+        keys.push_back(get_price_stats_key(symbol));
+    }
+    
+    missing.clear();
+    auto conn = pool_->acquire();
+    if (!conn) {
+        std::cerr << "Redis not connected" << std::endl;
+        return false;
+    }
+    return expire_keys(conn.get(), keys, missing);
+}
+
+bool RedisWriter::read_raw_record(const std::string& exchange, const std::string& symbol, RawRecord& record) {
+    // 命中客户端缓存时不占用连接；epoch 在读 Redis 之前取
     std::string key = get_raw_key(exchange, symbol);
-    redisReply* reply = (redisReply*)redisCommand(context_, "GET %s", key.c_str());
+    uint64_t epoch = 0;
+    if (client_cache_) {
+        if (client_cache_->get_raw(key, record)) return true;
+        epoch = client_cache_->epoch();
+    }
+    
+    auto conn = pool_->acquire();
+    if (!conn) return false;
+    redisContext* ctx = conn.get();
+    
+    redisReply* reply = (redisReply*)redisCommand(ctx, "GET %s", key.c_str());
     
     if (reply == nullptr || reply->type != REDIS_REPLY_STRING) {
         if (reply) freeReplyObject(reply);
         return false;
     }
     
-    record = deserialize_raw_record(reply->str);
+    bool success = decode_raw_value(ctx, reply->str, reply->len, record);
     freeReplyObject(reply);
-    return true;
+    if (success && client_cache_) client_cache_->put_raw(key, record, epoch);
+    return success;
 }
 
-std::vector<RawRecord> RedisWriter::read_all_raw_records() {
-    std::vector<RawRecord> records;
-    if (!is_connected()) return records;
-    
-    // 获取所有 crypto:raw:* 的 keys
-    redisReply* reply = (redisReply*)redisCommand(context_, "KEYS crypto:raw:*");
-    if (reply == nullptr || reply->type != REDIS_REPLY_ARRAY) {
-        if (reply) freeReplyObject(reply);
-        return records;
+// 分批遍历 key：索引集合存在时 SSCAN 索引，否则（旧数据还没有索引）退回 SCAN MATCH。
+// 两者都是游标迭代，每次只让 Redis 做 SCAN_BATCH 量级的工作，不会阻塞其他客户端
+bool RedisWriter::scan_keys(redisContext* ctx, const std::string& index_key, const std::string& pattern,
+                            const std::function<void(const std::vector<std::string>&)>& on_batch) {
+    bool use_index = false;
+    if (!index_key.empty()) {
+        redisReply* exists = command_argv(ctx, {"EXISTS", index_key});
+        use_index = exists && exists->type == REDIS_REPLY_INTEGER && exists->integer == 1;
+        if (exists) freeReplyObject(exists);
     }
     
-    // 批量获取所有值
-    if (reply->elements > 0) {
-        std::string mget_cmd = "MGET";
-        for (size_t i = 0; i < reply->elements; ++i) {
-            mget_cmd += " " + std::string(reply->element[i]->str);
+    std::string cursor = "0";
+    std::vector<std::string> batch;
+    do {
+        redisReply* reply = use_index
+            ? command_argv(ctx, {"SSCAN", index_key, cursor, "COUNT", std::to_string(SCAN_BATCH)})
+            : command_argv(ctx, {"SCAN", cursor, "MATCH", pattern, "COUNT", std::to_string(SCAN_BATCH)});
+        
+        if (reply == nullptr || reply->type != REDIS_REPLY_ARRAY || reply->elements != 2) {
+            std::cerr << "Failed to scan " << (use_index ? index_key : pattern) << std::endl;
+            if (reply) freeReplyObject(reply);
+            return false;
         }
         
+        cursor.assign(reply->element[0]->str, reply->element[0]->len);
+        redisReply* keys = reply->element[1];
+        batch.clear();
+        for (size_t i = 0; i < keys->elements; ++i) {
+            batch.emplace_back(keys->element[i]->str, keys->element[i]->len);
+        }
         freeReplyObject(reply);
-        reply = (redisReply*)redisCommand(context_, mget_cmd.c_str());
         
-        if (reply && reply->type == REDIS_REPLY_ARRAY) {
-            for (size_t i = 0; i < reply->elements; ++i) {
-                if (reply->element[i]->type == REDIS_REPLY_STRING) {
-                    records.push_back(deserialize_raw_record(reply->element[i]->str));
-                }
-            }
-        }
-    }
+        if (!batch.empty()) on_batch(batch);
+    } while (cursor != "0");
     
-    if (reply) freeReplyObject(reply);
-    return records;
+    return true;
 }
 
-std::vector<RawRecord> RedisWriter::read_raw_records_by_exchange(const std::string& exchange) {
-    std::vector<RawRecord> records;
-    if (!is_connected()) return records;
+// MGET 一批 key，values 与 keys 一一对应，不存在的 key 记入 missing
+bool RedisWriter::mget(redisContext* ctx, const std::vector<std::string>& keys, std::vector<std::string>& values,
+                       std::vector<size_t>& missing) {
+    values.assign(keys.size(), std::string());
+    missing.clear();
     
-    std::string pattern = "crypto:raw:" + exchange + ":*";
-    redisReply* reply = (redisReply*)redisCommand(context_, "KEYS %s", pattern.c_str());
+    std::vector<std::string> args;
+    args.reserve(keys.size() + 1);
+    args.push_back("MGET");
+    args.insert(args.end(), keys.begin(), keys.end());
     
-    if (reply == nullptr || reply->type != REDIS_REPLY_ARRAY) {
+    redisReply* reply = command_argv(ctx, args);
+    if (reply == nullptr || reply->type != REDIS_REPLY_ARRAY || reply->elements != keys.size()) {
+        std::cerr << "MGET failed" << std::endl;
         if (reply) freeReplyObject(reply);
-        return records;
+        return false;
+    }
+    for (size_t i = 0; i < reply->elements; ++i) {
+        redisReply* element = reply->element[i];
+        if (element->type == REDIS_REPLY_STRING) {
+            values[i].assign(element->str, element->len);
+        } else {
+            missing.push_back(i);
+        }
+    }
+    freeReplyObject(reply);
+    return true;
+}
+
+// MGET 之后可能有写入重新创建了 key，清理索引前再确认一次仍不存在
+std::vector<std::string> RedisWriter::still_missing(redisContext* ctx, const std::vector<std::string>& keys) {
+    for (const auto& key : keys) {
+        append_argv(ctx, {"EXISTS", key});
+    }
+    std::vector<std::string> result;
+    for (const auto& key : keys) {
+        redisReply* reply;
+        if (redisGetReply(ctx, (void**)&reply) != REDIS_OK) return {};
+        if (reply->type == REDIS_REPLY_INTEGER && reply->integer == 0) result.push_back(key);
+        freeReplyObject(reply);
+    }
+    return result;
+}
+
+// 数据 key 已过期的索引成员从所有相关索引集合中移除
+void RedisWriter::prune_raw_index(redisContext* ctx, const std::vector<std::string>& candidates) {
+    if (candidates.empty()) return;
+    std::vector<std::string> stale_keys = still_missing(ctx, candidates);
+    if (stale_keys.empty()) return;
+    
+    std::map<std::string, std::vector<std::string>> index_members;
+    const std::string prefix = "crypto:raw:";
+    for (const auto& key : stale_keys) {
+        index_members[RAW_INDEX].push_back(key);
+        // key 格式 crypto:raw:<exchange>:<symbol>，exchange 不含冒号
+        auto sep = key.find(':', prefix.size());
+        if (key.compare(0, prefix.size(), prefix) != 0 || sep == std::string::npos) continue;
+        index_members[RAW_EXCHANGE_INDEX_PREFIX + key.substr(prefix.size(), sep - prefix.size())].push_back(key);
+        index_members[RAW_SYMBOL_INDEX_PREFIX + key.substr(sep + 1)].push_back(key);
+    }
+    for (const auto& [index_key, members] : index_members) {
+        std::vector<std::string> args;
+        args.reserve(members.size() + 2);
+        args.push_back("SREM");
+        args.push_back(index_key);
+        args.insert(args.end(), members.begin(), members.end());
+        append_argv(ctx, args);
     }
+    drain_replies(ctx, index_members.size(), "raw index prune");
+}
+
+void RedisWriter::prune_price_stats_index(redisContext* ctx, const std::vector<std::string>& candidates) {
+    if (candidates.empty()) return;
+    std::vector<std::string> stale_keys = still_missing(ctx, candidates);
+    if (stale_keys.empty()) return;
     
-    // 类似 read_all_raw_records 的逻辑
-    // ... 实现细节
+    std::vector<std::string> args;
+    args.reserve(stale_keys.size() + 2);
+    args.push_back("SREM");
+    args.push_back(STATS_INDEX);
+    args.insert(args.end(), stale_keys.begin(), stale_keys.end());
+    redisReply* reply = command_argv(ctx, args);
+    if (reply) freeReplyObject(reply);
+}
+
+std::vector<RawRecord> RedisWriter::read_raw_records_indexed(const std::string& index_key, const std::string& pattern) {
+    auto conn = pool_->acquire();
+    if (!conn) return {};
+    redisContext* ctx = conn.get();
     
-    freeReplyObject(reply);
+    std::vector<RawRecord> records;
+    std::vector<std::string> values;
+    std::vector<size_t> missing;
+    std::vector<std::string> stale;
+    
+    scan_keys(ctx, index_key, pattern, [&](const std::vector<std::string>& keys) {
+        if (!mget(ctx, keys, values, missing)) return;
+        size_t next_missing = 0;
+        for (size_t i = 0; i < keys.size(); ++i) {
+            if (next_missing < missing.size() && missing[next_missing] == i) {
+                stale.push_back(keys[i]);
+                next_missing++;
+                continue;
+            }
+            RawRecord record;
+            if (decode_raw_value(ctx, values[i].data(), values[i].size(), record)) {
+                records.push_back(std::move(record));
+            } else {
+                std::cerr << "Failed to decode " << keys[i] << std::endl;
+            }
+        }
+    });
+    
+    // SSCAN 结束后再改集合，遍历过程中不修改被遍历的集合
+    prune_raw_index(ctx, stale);
     return records;
 }
 
+std::vector<RawRecord> RedisWriter::read_all_raw_records() {
+    return read_raw_records_indexed(RAW_INDEX, RAW_KEY_PATTERN);
+}
+
+std::vector<RawRecord> RedisWriter::read_raw_records_by_exchange(const std::string& exchange) {
+    return read_raw_records_indexed(RAW_EXCHANGE_INDEX_PREFIX + exchange, "crypto:raw:" + exchange + ":*");
+}
+
+std::vector<RawRecord> RedisWriter::read_raw_records_by_symbol(const std::string& symbol) {
+    return read_raw_records_indexed(RAW_SYMBOL_INDEX_PREFIX + symbol, "crypto:raw:*:" + symbol);
+}
+
 bool RedisWriter::read_price_stats_record(const std::string& symbol, PriceStatsRecord& record) {
-    if (!is_connected()) return false;
-    
     std::string key = get_price_stats_key(symbol);
-    redisReply* reply = (redisReply*)redisCommand(context_, "GET %s", key.c_str());
+    uint64_t epoch = 0;
+    if (client_cache_) {
+        if (client_cache_->get_price_stats(key, record)) return true;
+        epoch = client_cache_->epoch();
+    }
+    
+    auto conn = pool_->acquire();
+    if (!conn) return false;
+    redisContext* ctx = conn.get();
+    
+    redisReply* reply = (redisReply*)redisCommand(ctx, "GET %s", key.c_str());
     
     if (reply == nullptr || reply->type != REDIS_REPLY_STRING) {
         if (reply) freeReplyObject(reply);
         return false;
     }
     
-    record = deserialize_price_stats_record(reply->str);
+    bool success = decode_price_stats_value(ctx, reply->str, reply->len, record);
     freeReplyObject(reply);
-    return true;
+    if (success && client_cache_) client_cache_->put_price_stats(key, record, epoch);
+    return success;
 }
 
 std::vector<PriceStatsRecord> RedisWriter::read_all_price_stats_records() {
+    auto conn = pool_->acquire();
+    if (!conn) return {};
+    redisContext* ctx = conn.get();
+    
     std::vector<PriceStatsRecord> records;
-    if (!is_connected()) return records;
+    std::vector<std::string> values;
+    std::vector<size_t> missing;
+    std::vector<std::string> stale;
     
-    redisReply* reply = (redisReply*)redisCommand(context_, "KEYS crypto:stats:*");
-    if (reply == nullptr || reply->type != REDIS_REPLY_ARRAY) {
+    scan_keys(ctx, STATS_INDEX, STATS_KEY_PATTERN, [&](const std::vector<std::string>& keys) {
+        if (!mget(ctx, keys, values, missing)) return;
+        size_t next_missing = 0;
+        for (size_t i = 0; i < keys.size(); ++i) {
+            if (next_missing < missing.size() && missing[next_missing] == i) {
+                stale.push_back(keys[i]);
+                next_missing++;
+                continue;
+            }
+            PriceStatsRecord record;
+            if (decode_price_stats_value(ctx, values[i].data(), values[i].size(), record)) {
+                records.push_back(std::move(record));
+            } else {
+                std::cerr << "Failed to decode " << keys[i] << std::endl;
+            }
+        }
+    });
+    
+    prune_price_stats_index(ctx, stale);
+    return records;
+}
+
+size_t RedisWriter::read_raw_records(const std::vector<std::pair<std::string, std::string>>& instruments,
+                                     std::vector<RawRecord>& records, std::vector<bool>& found) {
+    size_t count = instruments.size();
+    found.assign(count, false);
+    if (records.size() < count) records.resize(count);
+    if (count == 0) return 0;
+    
+    // key 字符串和未命中下标按线程复用，assign/append 在容量足够时不分配
+    thread_local std::vector<std::string> keys;
+    thread_local std::vector<size_t> misses;
+    if (keys.size() < count) keys.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        keys[i].assign("crypto:raw:").append(instruments[i].first).append(":").append(instruments[i].second);
+    }
+    
+    // 先查客户端缓存，只 MGET 未命中的 key；epoch 在读 Redis 之前取
+    size_t read = 0;
+    uint64_t epoch = client_cache_ ? client_cache_->epoch() : 0;
+    misses.clear();
+    for (size_t i = 0; i < count; ++i) {
+        if (client_cache_ && client_cache_->get_raw(keys[i], records[i])) {
+            found[i] = true;
+            read++;
+        } else {
+            misses.push_back(i);
+        }
+    }
+    if (misses.empty()) return read;
+    
+    auto conn = pool_->acquire();
+    if (!conn) return read;
+    redisContext* ctx = conn.get();
+    
+    redisReply* reply = mget_argv(ctx, keys, misses);
+    if (reply == nullptr || reply->type != REDIS_REPLY_ARRAY || reply->elements != misses.size()) {
+        std::cerr << "MGET failed" << std::endl;
         if (reply) freeReplyObject(reply);
-        return records;
+        return read;
+    }
+    
+    for (size_t j = 0; j < misses.size(); ++j) {
+        size_t i = misses[j];
+        const redisReply* element = reply->element[j];
+        if (element->type == REDIS_REPLY_STRING &&
+            decode_raw_value(ctx, element->str, element->len, records[i])) {
+            found[i] = true;
+            read++;
+            if (client_cache_) client_cache_->put_raw(keys[i], records[i], epoch);
+        }
     }
+    freeReplyObject(reply);
+    return read;
+}
+
+size_t RedisWriter::read_price_stats_records(const std::vector<std::string>& symbols,
+                                             std::vector<PriceStatsRecord>& records, std::vector<bool>& found) {
+    size_t count = symbols.size();
+    found.assign(count, false);
+    if (records.size() < count) records.resize(count);
+    if (count == 0) return 0;
     
-    // 类似 read_all_raw_records 的实现
-    // ... 
+    thread_local std::vector<std::string> keys;
+    thread_local std::vector<size_t> misses;
+    if (keys.size() < count) keys.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        keys[i].assign("crypto:stats:").append(symbols[i]);
+    }
     
+    size_t read = 0;
+    uint64_t epoch = client_cache_ ? client_cache_->epoch() : 0;
+    misses.clear();
+    for (size_t i = 0; i < count; ++i) {
+        if (client_cache_ && client_cache_->get_price_stats(keys[i], records[i])) {
+            found[i] = true;
+            read++;
+        } else {
+            misses.push_back(i);
+        }
+    }
+    if (misses.empty()) return read;
+    
+    auto conn = pool_->acquire();
+    if (!conn) return read;
+    redisContext* ctx = conn.get();
+    
+    redisReply* reply = mget_argv(ctx, keys, misses);
+    if (reply == nullptr || reply->type != REDIS_REPLY_ARRAY || reply->elements != misses.size()) {
+        std::cerr << "MGET failed" << std::endl;
+        if (reply) freeReplyObject(reply);
+        return read;
+    }
+    
+    for (size_t j = 0; j < misses.size(); ++j) {
+        size_t i = misses[j];
+        const redisReply* element = reply->element[j];
+        if (element->type == REDIS_REPLY_STRING &&
+            decode_price_stats_value(ctx, element->str, element->len, records[i])) {
+            found[i] = true;
+            read++;
+            if (client_cache_) client_cache_->put_price_stats(keys[i], records[i], epoch);
+        }
+    }
     freeReplyObject(reply);
-    return records;
+    return read;
 }
 
 bool RedisWriter::exists_raw_record(const std::string& exchange, const std::string& symbol) {
-    if (!is_connected()) return false;
+    auto conn = pool_->acquire();
+    if (!conn) return false;
+    redisContext* ctx = conn.get();
     
     std::string key = get_raw_key(exchange, symbol);
-    redisReply* reply = (redisReply*)redisCommand(context_, "EXISTS %s", key.c_str());
+    redisReply* reply = (redisReply*)redisCommand(ctx, "EXISTS %s", key.c_str());
     
     bool exists = (reply && reply->type == REDIS_REPLY_INTEGER && reply->integer == 1);
     if (reply) freeReplyObject(reply);
@@ -371,48 +1114,49 @@ bool RedisWriter::exists_raw_record(const std::string& exchange, const std::stri
 }
 
 bool RedisWriter::exists_price_stats_record(const std::string& symbol) {
-    if (!is_connected()) return false;
+    auto conn = pool_->acquire();
+    if (!conn) return false;
+    redisContext* ctx = conn.get();
     
     std::string key = get_price_stats_key(symbol);
-    redisReply* reply = (redisReply*)redisCommand(context_, "EXISTS %s", key.c_str());
+    redisReply* reply = (redisReply*)redisCommand(ctx, "EXISTS %s", key.c_str());
     
     bool exists = (reply && reply->type == REDIS_REPLY_INTEGER && reply->integer == 1);
     if (reply) freeReplyObject(reply);
     return exists;
 }
 
+// 直接 SCAN keyspace，结果包含还没有进索引的旧 key
 std::vector<std::string> RedisWriter::get_all_raw_keys() {
-    std::vector<std::string> keys;
-    if (!is_connected()) return keys;
+    auto conn = pool_->acquire();
+    if (!conn) return {};
+    redisContext* ctx = conn.get();
     
-    redisReply* reply = (redisReply*)redisCommand(context_, "KEYS crypto:raw:*");
-    if (reply && reply->type == REDIS_REPLY_ARRAY) {
-        for (size_t i = 0; i < reply->elements; ++i) {
-            keys.push_back(reply->element[i]->str);
-        }
-    }
-    if (reply) freeReplyObject(reply);
+    std::vector<std::string> keys;
+    scan_keys(ctx, "", RAW_KEY_PATTERN, [&keys](const std::vector<std::string>& batch) {
+        keys.insert(keys.end(), batch.begin(), batch.end());
+    });
     return keys;
 }
 
 std::vector<std::string> RedisWriter::get_all_price_stats_keys() {
-    std::vector<std::string> keys;
-    if (!is_connected()) return keys;
+    auto conn = pool_->acquire();
+    if (!conn) return {};
+    redisContext* ctx = conn.get();
     
-    redisReply* reply = (redisReply*)redisCommand(context_, "KEYS crypto:stats:*");
-    if (reply && reply->type == REDIS_REPLY_ARRAY) {
-        for (size_t i = 0; i < reply->elements; ++i) {
-            keys.push_back(reply->element[i]->str);
-        }
-    }
-    if (reply) freeReplyObject(reply);
+    std::vector<std::string> keys;
+    scan_keys(ctx, "", STATS_KEY_PATTERN, [&keys](const std::vector<std::string>& batch) {
+        keys.insert(keys.end(), batch.begin(), batch.end());
+    });
     return keys;
 }
 
 int RedisWriter::get_ttl(const std::string& key) {
-    if (!is_connected()) return -1;
+    auto conn = pool_->acquire();
+    if (!conn) return -1;
+    redisContext* ctx = conn.get();
     
-    redisReply* reply = (redisReply*)redisCommand(context_, "TTL %s", key.c_str());
+    redisReply* reply = (redisReply*)redisCommand(ctx, "TTL %s", key.c_str());
     int ttl = -1;
     if (reply && reply->type == REDIS_REPLY_INTEGER) {
         ttl = reply->integer;
@@ -421,11 +1165,300 @@ int RedisWriter::get_ttl(const std::string& key) {
     return ttl;
 }
 
-bool RedisWriter::clear_price_stats_data() {
-    if (!is_connected()) return false;
+std::string RedisWriter::script_sha(redisContext* ctx, const char* source, bool reload) {
+    if (!reload) {
+        std::lock_guard<std::mutex> lock(script_mutex_);
+        auto it = script_shas_.find(source);
+        if (it != script_shas_.end()) return it->second;
+    }
+    
+    redisReply* reply = command_argv(ctx, {"SCRIPT", "LOAD", source});
+    if (reply == nullptr || reply->type != REDIS_REPLY_STRING) {
+        std::cerr << "SCRIPT LOAD failed" << (reply && reply->str ? std::string(": ") + reply->str : "") << std::endl;
+        if (reply) freeReplyObject(reply);
+        return "";
+    }
+    std::string sha(reply->str, reply->len);
+    freeReplyObject(reply);
     
-    redisReply* reply = (redisReply*)redisCommand(context_, "DEL crypto:stats:*");
-    bool success = (reply && reply->type != REDIS_REPLY_ERROR);
+    std::lock_guard<std::mutex> lock(script_mutex_);
+    script_shas_[source] = sha;
+    return sha;
+}
+
+// EVALSHA；服务端脚本缓存被清空（重启、SCRIPT FLUSH）时重新载入后再试一次
+redisReply* RedisWriter::eval_script(redisContext* ctx, const char* source, const std::vector<std::string>& args) {
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        std::string sha = script_sha(ctx, source, attempt > 0);
+        if (sha.empty()) return nullptr;
+        
+        std::vector<std::string> argv{"EVALSHA", sha};
+        argv.insert(argv.end(), args.begin(), args.end());
+        redisReply* reply = command_argv(ctx, argv);
+        if (reply && reply->type == REDIS_REPLY_ERROR && std::strncmp(reply->str, "NOSCRIPT", 8) == 0) {
+            freeReplyObject(reply);
+            continue;
+        }
+        return reply;
+    }
+    return nullptr;
+}
+
+bool RedisWriter::write_snapshot(const std::vector<RawRecord>& raw_records,
+                                 const std::vector<PriceStatsRecord>& stats_records,
+                                 uint64_t* version, RedisWriteTiming* timing) {
+    auto conn = pool_->acquire();
+    if (!conn) {
+        std::cerr << "Redis not connected" << std::endl;
+        return false;
+    }
+    redisContext* ctx = conn.get();
+    
+    if (raw_records.empty() && stats_records.empty()) return true;
+    
+    auto serialize_start = std::chrono::steady_clock::now();
+    intern_names(ctx, raw_records);
+    intern_names(ctx, stats_records);
+    
+    long now_sec = std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    std::vector<std::string> args{"5", SNAPSHOT_VERSION_KEY, SNAPSHOT_STATE_KEY, SNAPSHOT_UPDATED_KEY,
+                                  SNAPSHOT_PREFIX, SNAPSHOT_BASES_KEY,
+                                  std::to_string(expire_time_.load()), std::to_string(snapshot_retention_.load()),
+                                  std::to_string(now_sec), std::to_string(snapshot_base_interval_.load()),
+                                  std::to_string(SNAPSHOT_MAX_BASES)};
+    args.reserve(args.size() + 2 * (raw_records.size() + stats_records.size()));
+    thread_local market_codec::JsonWriter values;
+    values.clear();
+    for (const auto& record : raw_records) {
+        std::string key = get_raw_key(record.exchange, record.symbol);
+        auto slice = encode_raw_value(key, record, values);
+        args.push_back(std::move(key));
+        args.emplace_back(values.data(slice), slice.len);
+    }
+    for (const auto& record : stats_records) {
+        std::string key = get_price_stats_key(record.symbol);
+        auto slice = encode_price_stats_value(key, record, values);
+        args.push_back(std::move(key));
+        args.emplace_back(values.data(slice), slice.len);
+    }
+    if (timing) timing->serialize_us += elapsed_us(serialize_start);
+    
+    auto flush_start = std::chrono::steady_clock::now();
+    redisReply* reply = eval_script(ctx, SNAPSHOT_WRITE_SCRIPT, args);
+    bool success = reply && reply->type == REDIS_REPLY_INTEGER;
+    long long snapshot_version = success ? reply->integer : 0;
+    if (!success) {
+        std::cerr << "Snapshot write failed" << (reply && reply->str ? std::string(": ") + reply->str : "") << std::endl;
+    }
     if (reply) freeReplyObject(reply);
+    if (!success) {
+        if (timing) timing->flush_us += elapsed_us(flush_start);
+        return false;
+    }
+    if (version) *version = static_cast<uint64_t>(snapshot_version);
+    
+    // 索引、tick 流和变更通知不需要原子性，一个 pipeline 发送
+    size_t aux_commands = append_raw_index(ctx, raw_records) + append_price_stats_index(ctx, stats_records) +
+                          append_tick_streams(ctx, raw_records) +
+                          append_change_events(ctx, raw_records) + append_change_events(ctx, stats_records);
+    success = drain_replies(ctx, aux_commands, "snapshot index / stream / change event");
+    if (timing) timing->flush_us += elapsed_us(flush_start);
+    
+    std::cout << "Wrote snapshot v" << snapshot_version << " (" << raw_records.size() << " raw, "
+              << stats_records.size() << " price stats records) to Redis" << std::endl;
     return success;
-}
\ No newline at end of file
+}
+
+bool RedisWriter::read_snapshot(uint64_t version, uint64_t& snapshot_version,
+                                std::vector<RawRecord>& raw_records, std::vector<PriceStatsRecord>& stats_records) {
+    raw_records.clear();
+    stats_records.clear();
+    
+    auto conn = pool_->acquire();
+    if (!conn) return false;
+    redisContext* ctx = conn.get();
+    
+    redisReply* reply = eval_script(ctx, SNAPSHOT_READ_SCRIPT,
+                                    {"4", SNAPSHOT_VERSION_KEY, SNAPSHOT_STATE_KEY, SNAPSHOT_PREFIX, SNAPSHOT_BASES_KEY,
+                                     std::to_string(version)});
+    // 没有快照时脚本返回 false，对应 nil 回复
+    if (reply == nullptr || reply->type != REDIS_REPLY_ARRAY || reply->elements != 2 ||
+        reply->element[1]->type != REDIS_REPLY_ARRAY || reply->element[1]->elements == 0) {
+        if (reply && reply->type == REDIS_REPLY_ERROR) std::cerr << "Snapshot read failed: " << reply->str << std::endl;
+        if (reply) freeReplyObject(reply);
+        return false;
+    }
+    
+    snapshot_version = std::stoull(std::string(reply->element[0]->str, reply->element[0]->len));
+    const redisReply* fields = reply->element[1];
+    bool success = true;
+    for (size_t i = 0; i + 1 < fields->elements; i += 2) {
+        const redisReply* key = fields->element[i];
+        const redisReply* value = fields->element[i + 1];
+        if (std::strncmp(key->str, "crypto:raw:", 11) == 0) {
+            RawRecord record;
+            if (decode_raw_value(ctx, value->str, value->len, record)) {
+                raw_records.push_back(std::move(record));
+                continue;
+            }
+        } else if (std::strncmp(key->str, "crypto:stats:", 13) == 0) {
+            PriceStatsRecord record;
+            if (decode_price_stats_value(ctx, value->str, value->len, record)) {
+                stats_records.push_back(std::move(record));
+                continue;
+            }
+        }
+        std::cerr << "Failed to decode snapshot field " << std::string(key->str, key->len) << std::endl;
+        success = false;
+    }
+    freeReplyObject(reply);
+    return success;
+}
+
+bool RedisWriter::read_ticks(const std::string& symbol, std::string& last_id,
+                             std::vector<std::pair<std::string, RawRecord>>& ticks, size_t count, int block_ms) {
+    auto conn = pool_->acquire();
+    if (!conn) return false;
+    redisContext* ctx = conn.get();
+    
+    std::string key = redis_keys::tick_stream_key(symbol);
+    
+    // "$" 每次都指向调用时的最后一条，两次调用之间写入的 tick 会丢失，所以先换成具体 id
+    if (last_id == "$") {
+        redisReply* reply = command_argv(ctx, {"XREVRANGE", key, "+", "-", "COUNT", "1"});
+        if (reply == nullptr || reply->type != REDIS_REPLY_ARRAY) {
+            if (reply) freeReplyObject(reply);
+            return false;
+        }
+        last_id = reply->elements > 0
+            ? std::string(reply->element[0]->element[0]->str, reply->element[0]->element[0]->len)
+            : "0-0";
+        freeReplyObject(reply);
+    }
+    
+    std::vector<std::string> args{"XREAD", "COUNT", std::to_string(count)};
+    if (block_ms > 0) {
+        args.push_back("BLOCK");
+        args.push_back(std::to_string(block_ms));
+    }
+    args.insert(args.end(), {"STREAMS", key, last_id});
+    
+    redisReply* reply = command_argv(ctx, args);
+    if (reply == nullptr || reply->type == REDIS_REPLY_ERROR) {
+        if (reply) {
+            std::cerr << "XREAD " << key << " failed: " << reply->str << std::endl;
+            freeReplyObject(reply);
+        }
+        return false;
+    }
+    
+    size_t before = ticks.size();
+    bool success = parse_stream_reply(reply, ticks);
+    freeReplyObject(reply);
+    if (ticks.size() > before) last_id = ticks.back().first;
+    return success;
+}
+
+bool RedisWriter::create_tick_group(const std::string& symbol, const std::string& group, const std::string& start_id) {
+    auto conn = pool_->acquire();
+    if (!conn) return false;
+    redisContext* ctx = conn.get();
+    
+    redisReply* reply = command_argv(ctx, {"XGROUP", "CREATE", redis_keys::tick_stream_key(symbol), group,
+                                           start_id, "MKSTREAM"});
+    if (reply == nullptr) return false;
+    
+    bool success = reply->type != REDIS_REPLY_ERROR ||
+                   std::string(reply->str, reply->len).compare(0, 9, "BUSYGROUP") == 0;
+    if (!success) std::cerr << "XGROUP CREATE " << group << " failed: " << reply->str << std::endl;
+    freeReplyObject(reply);
+    return success;
+}
+
+bool RedisWriter::read_tick_group(const std::string& symbol, const std::string& group, const std::string& consumer,
+                                  std::vector<std::pair<std::string, RawRecord>>& ticks,
+                                  size_t count, int block_ms, const std::string& start_id) {
+    auto conn = pool_->acquire();
+    if (!conn) return false;
+    redisContext* ctx = conn.get();
+    
+    std::vector<std::string> args{"XREADGROUP", "GROUP", group, consumer, "COUNT", std::to_string(count)};
+    if (block_ms > 0) {
+        args.push_back("BLOCK");
+        args.push_back(std::to_string(block_ms));
+    }
+    args.insert(args.end(), {"STREAMS", redis_keys::tick_stream_key(symbol), start_id});
+    
+    redisReply* reply = command_argv(ctx, args);
+    if (reply == nullptr || reply->type == REDIS_REPLY_ERROR) {
+        if (reply) {
+            std::cerr << "XREADGROUP " << group << " failed: " << reply->str << std::endl;
+            freeReplyObject(reply);
+        }
+        return false;
+    }
+    
+    bool success = parse_stream_reply(reply, ticks);
+    freeReplyObject(reply);
+    return success;
+}
+
+bool RedisWriter::ack_ticks(const std::string& symbol, const std::string& group, const std::vector<std::string>& ids) {
+    if (ids.empty()) return true;
+    auto conn = pool_->acquire();
+    if (!conn) return false;
+    redisContext* ctx = conn.get();
+    
+    std::vector<std::string> args{"XACK", redis_keys::tick_stream_key(symbol), group};
+    args.insert(args.end(), ids.begin(), ids.end());
+    redisReply* reply = command_argv(ctx, args);
+    bool success = reply != nullptr && reply->type == REDIS_REPLY_INTEGER;
+    if (reply) freeReplyObject(reply);
+    return success;
+}
+
+// SCAN 到的每一批 key 立即 DEL，再删除对应的索引集合
+bool RedisWriter::delete_matching(redisContext* ctx, const std::string& pattern) {
+    bool success = true;
+    bool scanned = scan_keys(ctx, "", pattern, [&](const std::vector<std::string>& keys) {
+        std::vector<std::string> args;
+        args.reserve(keys.size() + 1);
+        args.push_back("DEL");
+        args.insert(args.end(), keys.begin(), keys.end());
+        redisReply* reply = command_argv(ctx, args);
+        if (reply == nullptr || reply->type == REDIS_REPLY_ERROR) success = false;
+        if (reply) freeReplyObject(reply);
+    });
+    return scanned && success;
+}
+
+bool RedisWriter::clear_snapshots(redisContext* ctx) {
+    bool success = true;
+    for (const char* pattern : {SNAPSHOT_STATE_KEY, SNAPSHOT_UPDATED_KEY, SNAPSHOT_BASES_KEY,
+                                SNAPSHOT_DELTAS_PATTERN, SNAPSHOT_BASE_KEYS_PATTERN}) {
+        success = delete_matching(ctx, pattern) && success;
+    }
+    return success;
+}
+
+bool RedisWriter::clear_raw_data() {
+    auto conn = pool_->acquire();
+    if (!conn) return false;
+    redisContext* ctx = conn.get();
+    bool success = delete_matching(ctx, RAW_KEY_PATTERN);
+    success = delete_matching(ctx, TICK_STREAM_PATTERN) && success;
+    // 快照状态同时包含 raw 和 stats，清理任一类数据时都整体删除；版本计数器保留，版本号不回退
+    success = clear_snapshots(ctx) && success;
+    // crypto:idx:raw 以及按交易所、按币种的索引
+    return delete_matching(ctx, std::string(RAW_INDEX) + "*") && success;
+}
+
+bool RedisWriter::clear_price_stats_data() {
+    auto conn = pool_->acquire();
+    if (!conn) return false;
+    redisContext* ctx = conn.get();
+    bool success = delete_matching(ctx, STATS_KEY_PATTERN);
+    success = clear_snapshots(ctx) && success;
+    return delete_matching(ctx, STATS_INDEX) && success;
+}
@@ -1,80 +1,379 @@
 #include "scheduler.hpp"
 #include <algorithm>
 #include <iostream>
+#include <cstring>
+#include <pthread.h>
+#include <sched.h>
 
-Scheduler::Scheduler() : running(false) {}
+namespace {
+// Queue 策略下单个任务最多排队的补跑次数，超出的触发计为 skipped
+const size_t MAX_PENDING_RUNS = 8;
+
+double elapsedUs(std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to) {
+    return std::chrono::duration<double, std::micro>(to - from).count();
+}
+}
+
+Scheduler::Scheduler(size_t workerCount)
+    : workerCountValue(std::max<size_t>(workerCount, 1)), schedulerCpu(-1), highResolutionWait(false),
+      spinMicros(200), nextToken(1), running(false) {}
 
 Scheduler::~Scheduler() {
     stop();  // 确保退出时安全停止
 }
 
 void Scheduler::start() {
+    if (running) return;
+    {
+        // start 前添加的任务从现在开始计时，避免把 addTask 到 start 之间的时间算成错过的周期
+        std::lock_guard<std::mutex> lock(mtx);
+        auto now = std::chrono::steady_clock::now();
+        dueHeap = decltype(dueHeap)();
+        for (size_t taskId = 0; taskId < tasks.size(); ++taskId) {
+            SchedulerTask& t = tasks[taskId];
+            if (t.cancelled || t.paused) continue;
+            t.epoch = now;
+            t.slot = 1;
+            t.nextRunTime = now + t.interval;
+            pushEntry(taskId);
+        }
+    }
     running = true;
+    for (size_t i = 0; i < workerCountValue; ++i) {
+        workers.emplace_back(&Scheduler::workerLoop, this);
+    }
     schedulerThread = std::thread(&Scheduler::run, this);
+    pinSchedulerThread();
+}
+
+void Scheduler::pinSchedulerThread() {
+    if (schedulerCpu < 0) return;
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(schedulerCpu, &cpus);
+    int rc = pthread_setaffinity_np(schedulerThread.native_handle(), sizeof(cpus), &cpus);
+    if (rc != 0) {
+        std::cerr << "Failed to pin scheduler thread to CPU " << schedulerCpu << ": " << std::strerror(rc) << std::endl;
+    } else {
+        std::cout << "Scheduler thread pinned to CPU " << schedulerCpu << std::endl;
+    }
 }
 
 void Scheduler::stop() {
     if (!running) return;
-    
+
     std::cout << "Stopping scheduler..." << std::endl;
-    
+
     {
         std::lock_guard<std::mutex> lock(mtx);
         running = false;
-        tasks.clear();  // 清理等待中的任务
+        jobs.clear();  // 清理还没开始执行的任务，正在执行的等它结束
         cv.notify_all();
+        jobCv.notify_all();
     }
-    
+
     if (schedulerThread.joinable()) {
         schedulerThread.join();
     }
-    
+    for (auto& worker : workers) {
+        if (worker.joinable()) worker.join();
+    }
+    workers.clear();
+
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        tasks.clear();
+        freeIds.clear();
+        dueHeap = decltype(dueHeap)();
+    }
+
     std::cout << "Scheduler stopped." << std::endl;
 }
 
-void Scheduler::addTask(const std::function<void()>& task, int interval_ms) {
+SchedulerTaskHandle Scheduler::addTask(const std::function<void()>& task, int interval_ms, OverrunPolicy policy,
+                                       ScheduleMode mode) {
     std::lock_guard<std::mutex> lock(mtx);
-    SchedulerTask t;
+    size_t taskId;
+    if (!freeIds.empty()) {
+        // 复用已回收的槽位；代号接着旧任务递增，堆里残留的旧条目出堆时仍按代号丢弃
+        taskId = freeIds.back();
+        freeIds.pop_back();
+        uint64_t generation = tasks[taskId].generation + 1;
+        tasks[taskId] = SchedulerTask();
+        tasks[taskId].generation = generation;
+    } else {
+        tasks.emplace_back();
+        taskId = tasks.size() - 1;
+    }
+    SchedulerTask& t = tasks[taskId];
     t.taskFn = task;
-    t.interval = std::chrono::milliseconds(interval_ms);
-    t.nextRunTime = std::chrono::steady_clock::now() + t.interval;
-    tasks.push_back(t);
+    t.interval = std::chrono::milliseconds(std::max(interval_ms, 1));
+    t.policy = policy;
+    t.mode = mode;
+    t.epoch = std::chrono::steady_clock::now();
+    t.slot = 1;
+    t.nextRunTime = t.epoch + t.interval;
+    t.token = nextToken++;
+
+    pushEntry(taskId);
     cv.notify_all();  // 有新任务了，唤醒线程
+    return SchedulerTaskHandle(this, taskId, t.token);
+}
+
+// 调用方持有 mtx
+void Scheduler::pushEntry(size_t taskId) {
+    const SchedulerTask& t = tasks[taskId];
+    dueHeap.push(HeapEntry{t.nextRunTime, taskId, t.generation});
+}
+
+// 调用方持有 mtx；任务已取消且不在执行中，释放回调和统计占用的内存，槽位留给 addTask 复用
+void Scheduler::releaseTask(size_t taskId) {
+    SchedulerTask& t = tasks[taskId];
+    t.taskFn = nullptr;
+    t.pendingRuns.clear();
+    t.jitterUs = RollingHistogram(0);
+    t.latencyUs = RollingHistogram(0);
+    freeIds.push_back(taskId);
+}
+
+// 调用方持有 mtx；句柄过期（任务已取消或 stop() 清空过）时返回 nullptr
+SchedulerTask* Scheduler::findTask(size_t taskId, uint64_t token) {
+    if (taskId >= tasks.size()) return nullptr;
+    SchedulerTask& t = tasks[taskId];
+    if (t.token != token || t.cancelled) return nullptr;
+    return &t;
+}
+
+bool Scheduler::cancelTask(size_t taskId, uint64_t token) {
+    std::lock_guard<std::mutex> lock(mtx);
+    SchedulerTask* t = findTask(taskId, token);
+    if (!t) return false;
+    t->cancelled = true;
+    t->generation++;
+    t->pendingRuns.clear();
+    // 正在执行时由工作线程结束后释放
+    if (!t->inFlight) releaseTask(taskId);
+    return true;
+}
+
+bool Scheduler::pauseTask(size_t taskId, uint64_t token) {
+    std::lock_guard<std::mutex> lock(mtx);
+    SchedulerTask* t = findTask(taskId, token);
+    if (!t) return false;
+    if (t->paused) return true;
+    t->paused = true;
+    t->generation++;
+    t->pendingRuns.clear();
+    return true;
+}
+
+bool Scheduler::resumeTask(size_t taskId, uint64_t token) {
+    std::lock_guard<std::mutex> lock(mtx);
+    SchedulerTask* t = findTask(taskId, token);
+    if (!t) return false;
+    if (!t->paused) return true;
+    t->paused = false;
+    t->generation++;
+    t->epoch = std::chrono::steady_clock::now();
+    t->slot = 1;
+    t->nextRunTime = t->epoch + t->interval;
+    // FixedDelay 正在执行时，由执行结束时安排下一次
+    if (t->mode == ScheduleMode::FixedRate || !t->inFlight) {
+        pushEntry(taskId);
+        cv.notify_all();
+    }
+    return true;
+}
+
+bool Scheduler::setTaskInterval(size_t taskId, uint64_t token, int interval_ms) {
+    std::lock_guard<std::mutex> lock(mtx);
+    SchedulerTask* t = findTask(taskId, token);
+    if (!t) return false;
+
+    auto now = std::chrono::steady_clock::now();
+    auto base = t->nextRunTime - t->interval;  // 上一个计划触发点
+    t->interval = std::chrono::milliseconds(std::max(interval_ms, 1));
+    t->generation++;
+    t->nextRunTime = std::max(now, base + t->interval);
+    // FixedRate 以新的触发点重新对齐
+    t->epoch = t->nextRunTime - t->interval;
+    t->slot = 1;
+    if (!t->paused && (t->mode == ScheduleMode::FixedRate || !t->inFlight)) {
+        pushEntry(taskId);
+        cv.notify_all();
+    }
+    return true;
+}
+
+bool Scheduler::getTaskStats(size_t taskId, uint64_t token, SchedulerTaskStats& stats) {
+    std::lock_guard<std::mutex> lock(mtx);
+    const SchedulerTask* task = findTask(taskId, token);
+    if (!task) return false;
+    const SchedulerTask& t = *task;
+    stats = t.stats;
+    stats.jitterP50Us = t.jitterUs.p50();
+    stats.jitterP99Us = t.jitterUs.p99();
+    stats.jitterMaxUs = t.jitterUs.max();
+    stats.latencyP50Us = t.latencyUs.p50();
+    stats.latencyP99Us = t.latencyUs.p99();
+    stats.latencyMaxUs = t.latencyUs.max();
+    return true;
+}
+
+// 调用方持有 mtx
+void Scheduler::dispatch(size_t taskId, std::chrono::steady_clock::time_point due) {
+    SchedulerTask& t = tasks[taskId];
+    if (!t.inFlight) {
+        t.inFlight = true;
+        jobs.push_back(Job{taskId, due});
+        jobCv.notify_one();
+        return;
+    }
+
+    // 上一次还没结束
+    t.stats.overruns++;
+    switch (t.policy) {
+        case OverrunPolicy::Skip:
+            t.stats.skipped++;
+            break;
+        case OverrunPolicy::Coalesce:
+            if (t.pendingRuns.empty()) {
+                t.pendingRuns.push_back(due);
+            } else {
+                t.stats.coalesced++;
+            }
+            break;
+        case OverrunPolicy::Queue:
+            if (t.pendingRuns.size() < MAX_PENDING_RUNS) {
+                t.pendingRuns.push_back(due);
+            } else {
+                t.stats.skipped++;
+            }
+            break;
+    }
+}
+
+// 调用方持有 mtx。FixedRate 按周期数推进，不以 now 为基准，所以迟到不会累积；
+// 醒来时已经错过的整周期直接跳过（计入 missedSlots），不会为了追赶连续触发。
+// FixedDelay 的下一次由工作线程在执行结束时安排
+void Scheduler::scheduleNext(size_t taskId, std::chrono::steady_clock::time_point now) {
+    SchedulerTask& t = tasks[taskId];
+    if (t.mode != ScheduleMode::FixedRate) return;
+
+    t.slot++;
+    t.nextRunTime = t.epoch + t.interval * static_cast<long long>(t.slot);
+    if (t.nextRunTime <= now) {
+        uint64_t missed = static_cast<uint64_t>((now - t.nextRunTime) / t.interval) + 1;
+        t.slot += missed;
+        t.nextRunTime = t.epoch + t.interval * static_cast<long long>(t.slot);
+        t.stats.missedSlots += missed;
+    }
+    pushEntry(taskId);
 }
 
 void Scheduler::run() {
+    std::unique_lock<std::mutex> lock(mtx);
     while (running) {
-        std::unique_lock<std::mutex> lock(mtx);
-
-        if (tasks.empty()) {
+        if (dueHeap.empty()) {
             cv.wait(lock);
             continue;
         }
 
+        // 堆顶就是下次要执行的任务
+        HeapEntry next = dueHeap.top();
         auto now = std::chrono::steady_clock::now();
+        if (now < next.due) {
+            auto spin = std::chrono::microseconds(spinMicros);
+            if (!highResolutionWait) {
+                cv.wait_until(lock, next.due);
+            } else if (next.due - now > spin) {
+                cv.wait_until(lock, next.due - spin);
+            } else {
+                // 最后一小段不交给内核定时器，释放锁自旋到点，之后重新检查堆顶
+                lock.unlock();
+                while (std::chrono::steady_clock::now() < next.due) {
+                    std::this_thread::yield();
+                }
+                lock.lock();
+            }
+            continue;
+        }
 
-        // 找下次要执行任务的最小时间
-        auto next_it = std::min_element(tasks.begin(), tasks.end(),
-            [](const SchedulerTask& a, const SchedulerTask& b) {
-                return a.nextRunTime < b.nextRunTime;
-            });
+        dueHeap.pop();
+        SchedulerTask& t = tasks[next.taskId];
+        if (next.generation != t.generation) continue;  // 已取消、暂停或改过间隔
+        t.jitterUs.record(elapsedUs(next.due, now));
+        scheduleNext(next.taskId, now);
+        dispatch(next.taskId, next.due);
+    }
+}
 
-        if (next_it == tasks.end()) {
-            cv.wait(lock);
+void Scheduler::workerLoop() {
+    std::unique_lock<std::mutex> lock(mtx);
+    while (true) {
+        jobCv.wait(lock, [this] { return !running || !jobs.empty(); });
+        if (!running) return;
+
+        Job job = jobs.front();
+        jobs.pop_front();
+        SchedulerTask& t = tasks[job.taskId];
+
+        // 排队期间被取消或暂停
+        if (t.cancelled || t.paused) {
+            t.inFlight = false;
+            if (t.cancelled) releaseTask(job.taskId);
             continue;
         }
 
-        if (now >= next_it->nextRunTime) {
-            auto taskToRun = *next_it;
-            next_it->nextRunTime = now + next_it->interval;
+        auto started = std::chrono::steady_clock::now();
+        t.latencyUs.record(elapsedUs(job.due, started));
 
-            // unlock 让其他线程也可以 addTask
-            lock.unlock();
+        lock.unlock();
+        try {
+            t.taskFn();
+        } catch (const std::exception& e) {
+            std::cerr << "Scheduled task " << job.taskId << " failed: " << e.what() << std::endl;
+        }
+        auto finished = std::chrono::steady_clock::now();
+        lock.lock();
 
-            // 异步执行任务，防止阻塞主调度线程
-            std::thread(taskToRun.taskFn).detach();
+        t.stats.runs++;
+        t.stats.lastDurationUs = elapsedUs(started, finished);
+
+        // 有补跑就接着排队，inFlight 保持为 true，保证同一任务串行
+        if (running && !t.pendingRuns.empty()) {
+            jobs.push_back(Job{job.taskId, t.pendingRuns.front()});
+            t.pendingRuns.pop_front();
+            jobCv.notify_one();
         } else {
-            cv.wait_until(lock, next_it->nextRunTime);
+            t.inFlight = false;
+            if (t.cancelled) {
+                releaseTask(job.taskId);
+            } else if (running && !t.paused && t.mode == ScheduleMode::FixedDelay) {
+                t.nextRunTime = finished + t.interval;
+                pushEntry(job.taskId);
+                cv.notify_all();
+            }
         }
     }
 }
+
+bool SchedulerTaskHandle::cancel() {
+    return scheduler && scheduler->cancelTask(taskId, token);
+}
+
+bool SchedulerTaskHandle::pause() {
+    return scheduler && scheduler->pauseTask(taskId, token);
+}
+
+bool SchedulerTaskHandle::resume() {
+    return scheduler && scheduler->resumeTask(taskId, token);
+}
+
+bool SchedulerTaskHandle::setInterval(int interval_ms) {
+    return scheduler && scheduler->setTaskInterval(taskId, token, interval_ms);
+}
+
+bool SchedulerTaskHandle::getStats(SchedulerTaskStats& stats) const {
+    return scheduler && scheduler->getTaskStats(taskId, token, stats);
+}
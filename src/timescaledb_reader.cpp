@@ -1,79 +1,631 @@
 #include "timescaledb_reader.h"
+#include "pg_binary.h"
 #include <libpq-fe.h>
 #include <iostream>
+#include <chrono>
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <thread>
 
-TimescaleDBReader::TimescaleDBReader(const std::string& conninfo) {
-    conn_ = PQconnectdb(conninfo.c_str());
-    if (PQstatus((PGconn*)conn_) != CONNECTION_OK) {
-        std::cerr << "Connection to database failed: " << PQerrorMessage((PGconn*)conn_) << std::endl;
-        PQfinish((PGconn*)conn_);
-        conn_ = nullptr;
+namespace {
+
+// 预编译语句名
+const char* STMT_LATEST_RAW = "read_latest_raw";
+const char* STMT_LATEST_STATS = "read_latest_price_stats";
+const char* STMT_INCREMENTAL_RAW = "read_incremental_raw";
+const char* STMT_INCREMENTAL_STATS = "read_incremental_price_stats";
+const char* STMT_RAW_FOR_KEYS = "read_latest_raw_for_keys";
+const char* STMT_STREAM_RAW_RANGE = "stream_raw_range";
+
+// 列显式转换为固定的二进制类型，解码时不依赖表里的实际列类型
+#define RAW_COLUMNS \
+    "id::int4, exchange::text, symbol::text, last::float8, bid::float8, ask::float8, " \
+    "high::float8, low::float8, volume::float8, \"timestamp\"::int8 "
+// 分片占位符：不分片时保留为注释，分片时替换为 symbol 哈希过滤条件
+#define SHARD_MARKER "/*shard*/"
+
+#define STATS_COLUMNS \
+    "id::int4, symbol::text, highest_price::float8, highest_exchange::text, lowest_price::float8, " \
+    "lowest_exchange::text, record_count::int4, earliest_timestamp::int8, latest_timestamp::int8 "
+
+struct StatementDef {
+    const char* name;
+    const char* sql;
+    int n_params;
+};
+
+const StatementDef STATEMENTS[] = {
+    // 按 (exchange, symbol) 分组，取最新一条
+    {STMT_LATEST_RAW,
+     "SELECT DISTINCT ON (exchange, symbol) " RAW_COLUMNS
+     "FROM crypto_raw_prices WHERE true " SHARD_MARKER " ORDER BY exchange, symbol, timestamp DESC", 0},
+    // 按 symbol 分组，取最新一条
+    {STMT_LATEST_STATS,
+     "SELECT DISTINCT ON (symbol) " STATS_COLUMNS
+     "FROM crypto_price_stats WHERE true " SHARD_MARKER " ORDER BY symbol, latest_timestamp DESC", 0},
+    // 只扫描全局高水位减回看窗口之后的数据，代价取决于新增行数而不是表大小
+    {STMT_INCREMENTAL_RAW,
+     "SELECT DISTINCT ON (exchange, symbol) " RAW_COLUMNS
+     "FROM crypto_raw_prices WHERE timestamp > $1 " SHARD_MARKER " ORDER BY exchange, symbol, timestamp DESC", 1},
+    {STMT_INCREMENTAL_STATS,
+     "SELECT DISTINCT ON (symbol) " STATS_COLUMNS
+     "FROM crypto_price_stats WHERE latest_timestamp > $1 " SHARD_MARKER " ORDER BY symbol, latest_timestamp DESC", 1},
+    // 只查指定的 (exchange, symbol)：$1/$2 为等长的 text[]，$3 为时间下界；分片时只返回本分片的 key
+    {STMT_RAW_FOR_KEYS,
+     "SELECT DISTINCT ON (exchange, symbol) " RAW_COLUMNS
+     "FROM crypto_raw_prices WHERE timestamp > $3 "
+     "AND (exchange, symbol) IN (SELECT * FROM unnest($1::text[], $2::text[])) " SHARD_MARKER " "
+     "ORDER BY exchange, symbol, timestamp DESC", 3},
+    // 历史区间：$1/$2 为 [start, end)，$3/$4 为 exchange/symbol 过滤（空数组表示不过滤）
+    {STMT_STREAM_RAW_RANGE,
+     "SELECT " RAW_COLUMNS
+     "FROM crypto_raw_prices WHERE timestamp >= $1 AND timestamp < $2 "
+     "AND (cardinality($3::text[]) = 0 OR exchange = ANY($3::text[])) "
+     "AND (cardinality($4::text[]) = 0 OR symbol = ANY($4::text[])) "
+     "ORDER BY timestamp", 4},
+};
+
+// 拼接 text[] 的文本字面量：{"a","b"}，元素内的 \ 和 " 需要转义
+std::string to_text_array(const std::vector<std::string>& items) {
+    std::string out = "{";
+    for (size_t i = 0; i < items.size(); ++i) {
+        if (i > 0) out += ',';
+        out += '"';
+        for (char c : items[i]) {
+            if (c == '"' || c == '\\') out += '\\';
+            out += c;
+        }
+        out += '"';
+    }
+    out += '}';
+    return out;
+}
+
+double elapsed_us(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+}
+
+// 分片过滤条件：同一个 symbol 的 raw 和 stats 总落在同一分片
+std::string shard_filter(int shard_index, int shard_count) {
+    if (shard_count <= 1) return "";
+    return "AND (hashtext(symbol) & 2147483647) % " + std::to_string(shard_count) +
+           " = " + std::to_string(shard_index);
+}
+
+// 预编译语句属于连接，每个连接（包括重连后）准备一次
+bool prepare_statements(PGconn* conn, const std::string& filter) {
+    for (const auto& stmt : STATEMENTS) {
+        std::string sql = stmt.sql;
+        auto pos = sql.find(SHARD_MARKER);
+        if (pos != std::string::npos && !filter.empty()) {
+            sql.replace(pos, sizeof(SHARD_MARKER) - 1, filter);
+        }
+        PGresult* res = PQprepare(conn, stmt.name, sql.c_str(), stmt.n_params, nullptr);
+        bool ok = PQresultStatus(res) == PGRES_COMMAND_OK;
+        if (!ok) {
+            std::cerr << "Failed to prepare " << stmt.name << ": " << PQerrorMessage(conn) << std::endl;
+        }
+        PQclear(res);
+        if (!ok) return false;
+    }
+    return true;
+}
+
+// 建立连接并准备全部语句，失败返回 nullptr
+PGconn* open_connection(const std::string& conninfo, const std::string& filter) {
+    PGconn* conn = PQconnectdb(conninfo.c_str());
+    if (PQstatus(conn) != CONNECTION_OK) {
+        std::cerr << "Connection to database failed: " << PQerrorMessage(conn) << std::endl;
+        PQfinish(conn);
+        return nullptr;
+    }
+    if (!prepare_statements(conn, filter)) {
+        PQfinish(conn);
+        return nullptr;
+    }
+    return conn;
+}
+
+// 区间查询的参数：[start, end) 为 int8 二进制，exchange/symbol 过滤为 text[] 字面量
+struct RangeParams {
+    char start_buf[8];
+    char end_buf[8];
+    std::string exchange_array;
+    std::string symbol_array;
+    const char* values[4];
+    int lengths[4];
+    int formats[4];
+
+    RangeParams(long start_ts, long end_ts,
+                const std::vector<std::string>& exchanges,
+                const std::vector<std::string>& symbols)
+        : exchange_array(to_text_array(exchanges)), symbol_array(to_text_array(symbols)),
+          values{start_buf, end_buf, exchange_array.c_str(), symbol_array.c_str()},
+          lengths{sizeof(start_buf), sizeof(end_buf), 0, 0},
+          formats{1, 1, 0, 0} {
+        pg_binary::write_int8(start_buf, start_ts);
+        pg_binary::write_int8(end_buf, end_ts);
+    }
+};
+
+} // namespace
+
+namespace pg_binary {
+
+bool decode_raw_row(const PGresult* res, int row, RawRecord& rec) {
+    // 主键列缺失的行无法写入 Redis，也不能推进高水位
+    if (PQgetisnull(res, row, 1) || PQgetisnull(res, row, 2) || PQgetisnull(res, row, 9)) return false;
+
+    int32_t id;
+    int64_t timestamp;
+    if (!get_int4(res, row, 0, id) ||
+        !get_float8(res, row, 3, rec.last) ||
+        !get_float8(res, row, 4, rec.bid) ||
+        !get_float8(res, row, 5, rec.ask) ||
+        !get_float8(res, row, 6, rec.high) ||
+        !get_float8(res, row, 7, rec.low) ||
+        !get_float8(res, row, 8, rec.volume) ||
+        !get_int8(res, row, 9, timestamp)) {
+        return false;
     }
+    rec.id = id;
+    rec.timestamp = timestamp;
+    rec.exchange.assign(PQgetvalue(res, row, 1), PQgetlength(res, row, 1));
+    rec.symbol.assign(PQgetvalue(res, row, 2), PQgetlength(res, row, 2));
+    return true;
+}
+
+bool decode_price_stats_row(const PGresult* res, int row, PriceStatsRecord& rec) {
+    if (PQgetisnull(res, row, 1) || PQgetisnull(res, row, 8)) return false;
+
+    int32_t id;
+    int32_t record_count;
+    int64_t earliest_timestamp;
+    int64_t latest_timestamp;
+    if (!get_int4(res, row, 0, id) ||
+        !get_float8(res, row, 2, rec.highest_price) ||
+        !get_float8(res, row, 4, rec.lowest_price) ||
+        !get_int4(res, row, 6, record_count) ||
+        !get_int8(res, row, 7, earliest_timestamp) ||
+        !get_int8(res, row, 8, latest_timestamp)) {
+        return false;
+    }
+    rec.id = id;
+    rec.record_count = record_count;
+    rec.earliest_timestamp = earliest_timestamp;
+    rec.latest_timestamp = latest_timestamp;
+    rec.symbol.assign(PQgetvalue(res, row, 1), PQgetlength(res, row, 1));
+    // 交易所为 NULL 时 PQgetvalue 返回空串，与 JSON 缺省一致
+    rec.highest_exchange.assign(PQgetvalue(res, row, 3), PQgetlength(res, row, 3));
+    rec.lowest_exchange.assign(PQgetvalue(res, row, 5), PQgetlength(res, row, 5));
+    return true;
+}
+
+} // namespace pg_binary
+
+TimescaleDBReader::TimescaleDBReader(const std::string& conninfo, int shard_index, int shard_count)
+    : conninfo_(conninfo), shard_filter_(shard_filter(shard_index, shard_count)),
+      raw_high_water_(0), stats_high_water_(0), lookback_(60000) {
+    conn_ = open_connection(conninfo, shard_filter_);
 }
 
 TimescaleDBReader::~TimescaleDBReader() {
     if (conn_) {
         PQfinish((PGconn*)conn_);
     }
+    for (void* conn : pool_conns_) {
+        PQfinish((PGconn*)conn);
+    }
 }
 
-std::vector<RawRecord> TimescaleDBReader::read_latest_raw() {
-    std::vector<RawRecord> result;
-    if (!conn_) return result;
-    // 按 (exchange, symbol) 分组，取最新一条
-    const char* sql =
-        "SELECT DISTINCT ON (exchange, symbol) id, exchange, symbol, last, bid, ask, high, low, volume, timestamp "
-        "FROM crypto_raw_prices ORDER BY exchange, symbol, timestamp DESC;";
-    PGresult* res = PQexec((PGconn*)conn_, sql);
+bool TimescaleDBReader::ensure_connection() {
+    if (!conn_) return false;
+    if (PQstatus((PGconn*)conn_) == CONNECTION_OK) return true;
+
+    std::cerr << "Lost connection to database, reconnecting..." << std::endl;
+    PQreset((PGconn*)conn_);
+    return PQstatus((PGconn*)conn_) == CONNECTION_OK && prepare_statements((PGconn*)conn_, shard_filter_);
+}
+
+// 执行预编译语句，结果统一以二进制格式返回
+void* TimescaleDBReader::exec_prepared(const char* stmt_name, int n_params, const char* const* values,
+                                       const int* lengths, const int* formats) {
+    if (!ensure_connection()) return nullptr;
+
+    auto start_time = std::chrono::steady_clock::now();
+    PGresult* res = PQexecPrepared((PGconn*)conn_, stmt_name, n_params, values, lengths, formats, 1);
+    last_read_timing_.query_us = elapsed_us(start_time);
+    last_read_timing_.decode_us = 0.0;
     if (PQresultStatus(res) != PGRES_TUPLES_OK) {
+        std::cerr << "Query " << stmt_name << " failed: " << PQerrorMessage((PGconn*)conn_) << std::endl;
         PQclear(res);
-        return result;
+        return nullptr;
     }
+    return res;
+}
+
+// param 为可选的 int8 参数，以二进制格式发送
+void* TimescaleDBReader::exec_prepared(const char* stmt_name, const long* param) {
+    char param_buf[8];
+    const char* values[1] = {param_buf};
+    const int lengths[1] = {sizeof(param_buf)};
+    const int formats[1] = {1};
+    if (!param) return exec_prepared(stmt_name, 0, nullptr, nullptr, nullptr);
+
+    pg_binary::write_int8(param_buf, *param);
+    return exec_prepared(stmt_name, 1, values, lengths, formats);
+}
+
+std::vector<RawRecord> TimescaleDBReader::decode_raw_result(void* result_ptr) {
+    std::vector<RawRecord> result;
+    PGresult* res = (PGresult*)result_ptr;
+    if (!res) return result;
+
+    auto start_time = std::chrono::steady_clock::now();
     int rows = PQntuples(res);
+    result.resize(rows);
+    size_t kept = 0;
     for (int i = 0; i < rows; ++i) {
-        RawRecord rec;
-        rec.id = std::stoi(PQgetvalue(res, i, 0));
-        rec.exchange = PQgetvalue(res, i, 1);
-        rec.symbol = PQgetvalue(res, i, 2);
-        rec.last = std::stod(PQgetvalue(res, i, 3));
-        rec.bid = std::stod(PQgetvalue(res, i, 4));
-        rec.ask = std::stod(PQgetvalue(res, i, 5));
-        rec.high = std::stod(PQgetvalue(res, i, 6));
-        rec.low = std::stod(PQgetvalue(res, i, 7));
-        rec.volume = std::stod(PQgetvalue(res, i, 8));
-        rec.timestamp = std::stol(PQgetvalue(res, i, 9));
-        result.push_back(rec);
+        if (pg_binary::decode_raw_row(res, i, result[kept])) ++kept;
+    }
+    if (kept < result.size()) {
+        std::cerr << "Skipped " << (result.size() - kept) << " raw rows with NULL or malformed columns" << std::endl;
+        result.resize(kept);
     }
     PQclear(res);
+    last_read_timing_.decode_us += elapsed_us(start_time);
     return result;
 }
 
-std::vector<PriceStatsRecord> TimescaleDBReader::read_latest_price_stats() {
+std::vector<RawRecord> TimescaleDBReader::query_raw(const char* stmt_name, const long* param) {
+    return decode_raw_result(exec_prepared(stmt_name, param));
+}
+
+std::vector<PriceStatsRecord> TimescaleDBReader::query_price_stats(const char* stmt_name, const long* param) {
     std::vector<PriceStatsRecord> result;
-    if (!conn_) return result;
-    // 按 symbol 分组，取最新一条
-    const char* sql =
-        "SELECT DISTINCT ON (symbol) id, symbol, highest_price, highest_exchange, lowest_price, lowest_exchange, record_count, earliest_timestamp, latest_timestamp "
-        "FROM crypto_price_stats ORDER BY symbol, latest_timestamp DESC;";
-    PGresult* res = PQexec((PGconn*)conn_, sql);
-    if (PQresultStatus(res) != PGRES_TUPLES_OK) {
-        PQclear(res);
-        return result;
-    }
+    PGresult* res = (PGresult*)exec_prepared(stmt_name, param);
+    if (!res) return result;
+
+    auto start_time = std::chrono::steady_clock::now();
     int rows = PQntuples(res);
+    result.resize(rows);
+    size_t kept = 0;
     for (int i = 0; i < rows; ++i) {
-        PriceStatsRecord rec;
-        rec.id = std::stoi(PQgetvalue(res, i, 0));
-        rec.symbol = PQgetvalue(res, i, 1);
-        rec.highest_price = std::stod(PQgetvalue(res, i, 2));
-        rec.highest_exchange = PQgetvalue(res, i, 3);
-        rec.lowest_price = std::stod(PQgetvalue(res, i, 4));
-        rec.lowest_exchange = PQgetvalue(res, i, 5);
-        rec.record_count = std::stoi(PQgetvalue(res, i, 6));
-        rec.earliest_timestamp = std::stol(PQgetvalue(res, i, 7));
-        rec.latest_timestamp = std::stol(PQgetvalue(res, i, 8));
-        result.push_back(rec);
+        if (pg_binary::decode_price_stats_row(res, i, result[kept])) ++kept;
+    }
+    if (kept < result.size()) {
+        std::cerr << "Skipped " << (result.size() - kept) << " price stats rows with NULL or malformed columns" << std::endl;
+        result.resize(kept);
     }
     PQclear(res);
+    last_read_timing_.decode_us += elapsed_us(start_time);
     return result;
-} 
\ No newline at end of file
+}
+
+// 记录比高水位新时推进高水位并返回 true
+bool TimescaleDBReader::advance_raw_watermark(const RawRecord& rec) {
+    long& mark = raw_watermarks_[rec.exchange + ":" + rec.symbol];
+    if (mark != 0 && rec.timestamp <= mark) return false;
+    mark = rec.timestamp;
+    if (rec.timestamp > raw_high_water_) raw_high_water_ = rec.timestamp;
+    return true;
+}
+
+bool TimescaleDBReader::advance_stats_watermark(const PriceStatsRecord& rec) {
+    long& mark = stats_watermarks_[rec.symbol];
+    if (mark != 0 && rec.latest_timestamp <= mark) return false;
+    mark = rec.latest_timestamp;
+    if (rec.latest_timestamp > stats_high_water_) stats_high_water_ = rec.latest_timestamp;
+    return true;
+}
+
+void TimescaleDBReader::reset_watermarks() {
+    raw_watermarks_.clear();
+    stats_watermarks_.clear();
+    raw_high_water_ = 0;
+    stats_high_water_ = 0;
+}
+
+std::vector<RawRecord> TimescaleDBReader::read_latest_raw() {
+    auto result = query_raw(STMT_LATEST_RAW, nullptr);
+    if (!result.empty()) {
+        auto start_time = std::chrono::steady_clock::now();
+        raw_watermarks_.clear();
+        raw_high_water_ = 0;
+        for (const auto& rec : result) advance_raw_watermark(rec);
+        last_read_timing_.decode_us += elapsed_us(start_time);
+    }
+    return result;
+}
+
+std::vector<PriceStatsRecord> TimescaleDBReader::read_latest_price_stats() {
+    auto result = query_price_stats(STMT_LATEST_STATS, nullptr);
+    if (!result.empty()) {
+        auto start_time = std::chrono::steady_clock::now();
+        stats_watermarks_.clear();
+        stats_high_water_ = 0;
+        for (const auto& rec : result) advance_stats_watermark(rec);
+        last_read_timing_.decode_us += elapsed_us(start_time);
+    }
+    return result;
+}
+
+std::vector<RawRecord> TimescaleDBReader::read_incremental_raw() {
+    if (raw_watermarks_.empty()) return read_latest_raw();
+
+    long lower_bound = raw_high_water_ - lookback_;
+    auto rows = query_raw(STMT_INCREMENTAL_RAW, &lower_bound);
+
+    auto start_time = std::chrono::steady_clock::now();
+    std::vector<RawRecord> result;
+    for (auto& rec : rows) {
+        if (advance_raw_watermark(rec)) result.push_back(std::move(rec));
+    }
+    last_read_timing_.decode_us += elapsed_us(start_time);
+    return result;
+}
+
+std::vector<PriceStatsRecord> TimescaleDBReader::read_incremental_price_stats() {
+    if (stats_watermarks_.empty()) return read_latest_price_stats();
+
+    long lower_bound = stats_high_water_ - lookback_;
+    auto rows = query_price_stats(STMT_INCREMENTAL_STATS, &lower_bound);
+
+    auto start_time = std::chrono::steady_clock::now();
+    std::vector<PriceStatsRecord> result;
+    for (auto& rec : rows) {
+        if (advance_stats_watermark(rec)) result.push_back(std::move(rec));
+    }
+    last_read_timing_.decode_us += elapsed_us(start_time);
+    return result;
+}
+
+std::vector<RawRecord> TimescaleDBReader::read_latest_raw_for(
+        const std::vector<std::pair<std::string, std::string>>& keys) {
+    if (raw_watermarks_.empty()) return read_incremental_raw();
+    if (keys.empty()) return {};
+
+    std::vector<std::string> exchanges, symbols;
+    exchanges.reserve(keys.size());
+    symbols.reserve(keys.size());
+    // 下界取这些 key 中最旧的高水位；新出现的 key 按全局高水位处理
+    long lower_bound = raw_high_water_;
+    for (const auto& [exchange, symbol] : keys) {
+        exchanges.push_back(exchange);
+        symbols.push_back(symbol);
+        auto it = raw_watermarks_.find(exchange + ":" + symbol);
+        if (it != raw_watermarks_.end() && it->second < lower_bound) lower_bound = it->second;
+    }
+    lower_bound -= lookback_;
+
+    std::string exchange_array = to_text_array(exchanges);
+    std::string symbol_array = to_text_array(symbols);
+    char bound_buf[8];
+    pg_binary::write_int8(bound_buf, lower_bound);
+
+    const char* values[3] = {exchange_array.c_str(), symbol_array.c_str(), bound_buf};
+    const int lengths[3] = {0, 0, sizeof(bound_buf)};
+    const int formats[3] = {0, 0, 1};
+    auto rows = decode_raw_result(exec_prepared(STMT_RAW_FOR_KEYS, 3, values, lengths, formats));
+
+    auto start_time = std::chrono::steady_clock::now();
+    std::vector<RawRecord> result;
+    for (auto& rec : rows) {
+        if (advance_raw_watermark(rec)) result.push_back(std::move(rec));
+    }
+    last_read_timing_.decode_us += elapsed_us(start_time);
+    return result;
+}
+
+bool TimescaleDBReader::stream_raw_range(long start_ts, long end_ts,
+                                         const std::vector<std::string>& exchanges,
+                                         const std::vector<std::string>& symbols,
+                                         const RawRecordCallback& callback,
+                                         RangeStreamStats* stats) {
+    RangeStreamStats local;
+    RangeStreamStats& out = stats ? *stats : local;
+    out = RangeStreamStats();
+    if (!ensure_connection()) return false;
+
+    PGconn* conn = (PGconn*)conn_;
+    auto start_time = std::chrono::steady_clock::now();
+
+    RangeParams params(start_ts, end_ts, exchanges, symbols);
+    if (!PQsendQueryPrepared(conn, STMT_STREAM_RAW_RANGE, 4, params.values, params.lengths, params.formats, 1)) {
+        std::cerr << "Failed to send range query: " << PQerrorMessage(conn) << std::endl;
+        return false;
+    }
+    auto cancel_query = [conn]() {
+        if (PGcancel* cancel = PQgetCancel(conn)) {
+            char errbuf[256];
+            PQcancel(cancel, errbuf, sizeof(errbuf));
+            PQfreeCancel(cancel);
+        }
+    };
+    if (!PQsetSingleRowMode(conn)) {
+        // 不能退回整批物化：区间可能远大于内存。取消查询并排空结果，连接留给后续使用
+        std::cerr << "Failed to enter single-row mode, cancelling range query" << std::endl;
+        cancel_query();
+        while (PGresult* res = PQgetResult(conn)) PQclear(res);
+        return false;
+    }
+
+    // 单行模式下每行一个 PGresult，解码到同一个 RawRecord 里，内存不随行数增长
+    RawRecord rec;
+    bool ok = true;
+    bool stopped = false;
+    while (PGresult* res = PQgetResult(conn)) {
+        ExecStatusType status = PQresultStatus(res);
+        if (status == PGRES_SINGLE_TUPLE || status == PGRES_TUPLES_OK) {
+            int rows = stopped ? 0 : PQntuples(res);
+            for (int i = 0; i < rows && !stopped; ++i) {
+                if (!pg_binary::decode_raw_row(res, i, rec)) {
+                    out.skipped++;
+                    continue;
+                }
+                out.rows++;
+                if (!callback(rec)) {
+                    // 取消服务端查询，剩余结果直接丢弃
+                    stopped = true;
+                    cancel_query();
+                }
+            }
+        } else if (!stopped) {
+            std::cerr << "Range query failed: " << PQerrorMessage(conn) << std::endl;
+            ok = false;
+        }
+        PQclear(res);
+    }
+
+    out.elapsed_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_time).count();
+    out.rows_per_sec = out.elapsed_ms > 0 ? out.rows * 1000.0 / out.elapsed_ms : 0.0;
+    out.completed = ok && !stopped;
+
+    std::cout << "Streamed " << out.rows << " raw records in " << out.elapsed_ms << "ms ("
+              << static_cast<long>(out.rows_per_sec) << " rows/s)" << std::endl;
+    if (out.skipped > 0) {
+        std::cerr << "Skipped " << out.skipped << " raw rows with NULL or malformed columns" << std::endl;
+    }
+    return ok;
+}
+
+// 查询与 [start_ts, end_ts) 相交的 chunk 边界，按边界把区间切成互不重叠的子区间。
+// 拿不到 chunk 信息（非 hypertable、没有 TimescaleDB 扩展等）时按 fallback_pieces 等分。
+std::vector<std::pair<long, long>> TimescaleDBReader::plan_chunk_ranges(long start_ts, long end_ts, int fallback_pieces) {
+    std::vector<long> bounds = {start_ts, end_ts};
+
+    if (ensure_connection()) {
+        const char* sql =
+            "SELECT range_start_integer::int8, range_end_integer::int8 "
+            "FROM timescaledb_information.chunks "
+            "WHERE hypertable_name = 'crypto_raw_prices' "
+            "AND range_end_integer > $1 AND range_start_integer < $2";
+        char start_buf[8], end_buf[8];
+        pg_binary::write_int8(start_buf, start_ts);
+        pg_binary::write_int8(end_buf, end_ts);
+        const char* values[2] = {start_buf, end_buf};
+        const int lengths[2] = {sizeof(start_buf), sizeof(end_buf)};
+        const int formats[2] = {1, 1};
+        const Oid types[2] = {pg_binary::INT8_OID, pg_binary::INT8_OID};
+
+        PGresult* res = PQexecParams((PGconn*)conn_, sql, 2, types, values, lengths, formats, 1);
+        if (PQresultStatus(res) == PGRES_TUPLES_OK) {
+            for (int i = 0; i < PQntuples(res); ++i) {
+                for (int col = 0; col < 2; ++col) {
+                    if (PQgetisnull(res, i, col)) continue;
+                    long bound = pg_binary::read_int8(PQgetvalue(res, i, col));
+                    if (bound > start_ts && bound < end_ts) bounds.push_back(bound);
+                }
+            }
+        } else {
+            std::cerr << "Chunk lookup failed, splitting evenly: " << PQerrorMessage((PGconn*)conn_) << std::endl;
+        }
+        PQclear(res);
+    }
+
+    if (bounds.size() == 2 && fallback_pieces > 1) {
+        long step = (end_ts - start_ts) / fallback_pieces;
+        for (int i = 1; step > 0 && i < fallback_pieces; ++i) {
+            bounds.push_back(start_ts + step * i);
+        }
+    }
+
+    // 多个空间分区的 chunk 共享同一时间边界，去重后相邻两点构成一个子区间
+    std::sort(bounds.begin(), bounds.end());
+    bounds.erase(std::unique(bounds.begin(), bounds.end()), bounds.end());
+
+    std::vector<std::pair<long, long>> ranges;
+    for (size_t i = 0; i + 1 < bounds.size(); ++i) {
+        ranges.emplace_back(bounds[i], bounds[i + 1]);
+    }
+    return ranges;
+}
+
+bool TimescaleDBReader::fetch_raw_range_parallel(long start_ts, long end_ts,
+                                                 const std::vector<std::string>& exchanges,
+                                                 const std::vector<std::string>& symbols,
+                                                 std::vector<RawRecord>& out,
+                                                 int connections) {
+    out.clear();
+    if (!conn_ || end_ts <= start_ts) return false;
+    if (connections < 1) connections = 1;
+
+    auto start_time = std::chrono::steady_clock::now();
+    auto ranges = plan_chunk_ranges(start_ts, end_ts, connections * 4);
+
+    // 连接池按需扩充，读完后保留给下一次使用
+    int workers = std::min<int>(connections, ranges.size());
+    while (static_cast<int>(pool_conns_.size()) < workers) {
+        PGconn* conn = open_connection(conninfo_, shard_filter_);
+        if (!conn) break;
+        pool_conns_.push_back(conn);
+    }
+    workers = std::min<int>(workers, pool_conns_.size());
+    if (workers == 0) {
+        std::cerr << "No database connections available for parallel fetch" << std::endl;
+        return false;
+    }
+
+    // 每个子区间各自按时间排序，子区间之间互不重叠，按顺序拼接即是全局时间顺序
+    std::vector<std::vector<RawRecord>> parts(ranges.size());
+    std::atomic<size_t> next_range(0);
+    std::atomic<bool> failed(false);
+    std::atomic<long> skipped(0);
+
+    auto worker = [&](PGconn* conn) {
+        if (PQstatus(conn) != CONNECTION_OK) {
+            PQreset(conn);
+            if (PQstatus(conn) != CONNECTION_OK || !prepare_statements(conn, shard_filter_)) {
+                failed = true;
+                return;
+            }
+        }
+        for (size_t i = next_range++; i < ranges.size() && !failed; i = next_range++) {
+            RangeParams params(ranges[i].first, ranges[i].second, exchanges, symbols);
+            PGresult* res = PQexecPrepared(conn, STMT_STREAM_RAW_RANGE, 4,
+                                           params.values, params.lengths, params.formats, 1);
+            if (PQresultStatus(res) != PGRES_TUPLES_OK) {
+                std::cerr << "Parallel range query failed: " << PQerrorMessage(conn) << std::endl;
+                PQclear(res);
+                failed = true;
+                return;
+            }
+            int rows = PQntuples(res);
+            parts[i].resize(rows);
+            size_t kept = 0;
+            for (int row = 0; row < rows; ++row) {
+                if (pg_binary::decode_raw_row(res, row, parts[i][kept])) ++kept;
+            }
+            if (kept < parts[i].size()) {
+                skipped += parts[i].size() - kept;
+                parts[i].resize(kept);
+            }
+            PQclear(res);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int w = 0; w < workers; ++w) {
+        threads.emplace_back(worker, (PGconn*)pool_conns_[w]);
+    }
+    for (auto& t : threads) t.join();
+
+    if (failed) return false;
+
+    size_t total = 0;
+    for (const auto& part : parts) total += part.size();
+    out.reserve(total);
+    for (auto& part : parts) {
+        std::move(part.begin(), part.end(), std::back_inserter(out));
+        std::vector<RawRecord>().swap(part);
+    }
+
+    double elapsed_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_time).count();
+    std::cout << "Fetched " << total << " raw records from " << ranges.size() << " chunk ranges over "
+              << workers << " connections in " << elapsed_ms << "ms" << std::endl;
+    if (skipped > 0) {
+        std::cerr << "Skipped " << skipped << " raw rows with NULL or malformed columns" << std::endl;
+    }
+    return true;
+}
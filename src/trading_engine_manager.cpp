@@ -3,6 +3,7 @@
 #include <random>
 #include <sstream>
 #include <iomanip>  
+#include <algorithm>
 
 // 构造函数
 TradingEngineManager::TradingEngineManager(const std::string& db_conninfo,
@@ -12,13 +13,33 @@ TradingEngineManager::TradingEngineManager(const std::string& db_conninfo,
     : engine_status_(EngineStatus::STOPPED), 
       should_run_(false), 
       trading_interval_ms_(5000), 
-      max_sessions_(10) {
+      max_sessions_(500),
+      groups_active_(false),
+      idle_heartbeat_ms_(60000) {
     
     // 创建Redis客户端（共享指针，因为要传给策略）
-    redis_client_ = std::make_shared<RedisWriter>(redis_host, redis_port, redis_password);
+    // 多个会话并发读取，用连接池避免所有读取排队等同一个连接
+    redis_client_ = std::make_shared<RedisWriter>(redis_host, redis_port, redis_password, 8);
+    // 多个会话共享少数几个品种，重复读取由客户端缓存承担，数据变化时 Redis 推送失效
+    redis_client_->enable_client_cache();
+    
+    // 进程内行情缓存：同步服务写入，策略直接读取，热路径上不走 Redis
+    market_cache_ = std::make_shared<MarketDataCache>();
+    freshness_tracker_ = std::make_shared<FreshnessTracker>();
     
     // 创建数据同步服务
     data_sync_service_ = std::make_unique<DataSyncService>(db_conninfo, redis_host, redis_port, redis_password);
+    data_sync_service_->set_market_data_cache(market_cache_);
+    data_sync_service_->set_freshness_tracker(freshness_tracker_);
+    
+    // 同步服务每写入一条记录发布一条变更事件，交易循环据此只唤醒相关会话
+    data_sync_service_->set_change_channel(redis_keys::CHANGE_CHANNEL);
+    change_subscriber_ = std::make_unique<RedisChangeSubscriber>(redis_host, redis_port, redis_password,
+                                                                 redis_keys::CHANGE_CHANNEL);
+    
+    // 会话执行线程池按 CPU 核数；定时器回调只提交任务，一个线程足够
+    session_pool_ = std::make_unique<WorkStealingPool>();
+    session_timers_ = std::make_unique<Scheduler>(1);
     
     // 重置统计信息
     reset_stats();
@@ -64,7 +85,10 @@ void TradingEngineManager::shutdown() {
     stop_engine();
     
     // 清理所有会话
-    trading_sessions_.clear();
+    {
+        std::lock_guard<std::mutex> lock(sessions_mutex_);
+        trading_sessions_.clear();
+    }
     
     engine_status_ = EngineStatus::STOPPED;
     std::cout << "Trading engine shutdown complete" << std::endl;
@@ -79,6 +103,7 @@ bool TradingEngineManager::is_healthy() const {
 
 // 重置统计信息
 void TradingEngineManager::reset_stats() {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
     stats_.total_sessions_created = 0;
     stats_.active_sessions = 0;
     stats_.total_trades_executed = 0;
@@ -139,15 +164,18 @@ std::string TradingEngineManager::create_trading_session(const ClientRequest& re
     std::cout << "\n=== Creating Trading Session ===" << std::endl;
     
     // 验证请求
-    if (!validate_client_request(request)) {
-        return "";
+    {
+        std::lock_guard<std::mutex> lock(sessions_mutex_);
+        if (!validate_client_request(request)) {
+            return "";
+        }
     }
     
     // 生成会话ID
     std::string session_id = generate_session_id();
     
     // 创建新会话
-    auto session = std::make_unique<TradingSession>();
+    auto session = std::make_shared<TradingSession>();
     session->session_id = session_id;
     session->request = request;
     session->status = EngineStatus::STOPPED;
@@ -161,10 +189,13 @@ std::string TradingEngineManager::create_trading_session(const ClientRequest& re
         std::cout << "Initializing arbitrage strategy..." << std::endl;
         session->arbitrage_strategy = std::make_unique<ArbitrageStrategy>(
             redis_client_,
-            request.symbol
+            request.symbol,
+            market_cache_
         );
         session->arbitrage_strategy->set_min_profit_bps(request.target_profit);
         session->arbitrage_strategy->set_max_trade_size(request.max_amount);
+        session->arbitrage_strategy->set_max_staleness_ms(request.max_staleness_ms);
+        session->arbitrage_strategy->set_freshness_tracker(freshness_tracker_);
         std::cout << "Arbitrage strategy initialized" << std::endl;
     }
     
@@ -173,7 +204,8 @@ std::string TradingEngineManager::create_trading_session(const ClientRequest& re
         session->market_making_strategy = std::make_unique<MarketMakingStrategy>(
             redis_client_,
             request.symbol,
-            request.exchange
+            request.exchange,
+            market_cache_
         );
         
         // 根据目标利润设置价差 (做市策略的价差应该小于目标利润)
@@ -183,12 +215,20 @@ std::string TradingEngineManager::create_trading_session(const ClientRequest& re
         // 根据金额计算订单大小
         double order_size = request.max_amount / 1000.0; // 简单计算，可以优化
         session->market_making_strategy->set_order_size(order_size);
+        session->market_making_strategy->set_max_staleness_ms(request.max_staleness_ms);
+        session->market_making_strategy->set_freshness_tracker(freshness_tracker_);
         std::cout << "Market making strategy initialized" << std::endl;
     }
     
     // 存储会话
-    trading_sessions_[session_id] = std::move(session);
-    stats_.total_sessions_created++;
+    {
+        std::lock_guard<std::mutex> lock(sessions_mutex_);
+        trading_sessions_[session_id] = std::move(session);
+    }
+    {
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        stats_.total_sessions_created++;
+    }
     
     std::cout << "Trading session created successfully!" << std::endl;
     std::cout << "Session ID: " << session_id << std::endl;
@@ -208,21 +248,25 @@ std::string TradingEngineManager::create_trading_session(const ClientRequest& re
 bool TradingEngineManager::start_trading_session(const std::string& session_id) {
     std::cout << "\n=== Starting Trading Session ===" << std::endl;
     
-    auto it = trading_sessions_.find(session_id);
-    if (it == trading_sessions_.end()) {
+    auto session = find_session(session_id);
+    if (!session) {
         std::cerr << "Session not found: " << session_id << std::endl;
         return false;
     }
     
-    auto& session = it->second;
-    
-    // 检查当前状态
-    if (session->status == EngineStatus::RUNNING) {
-        std::cout << "Session already running: " << session_id << std::endl;
-        return true;
-    }
+    // 检查当前状态；并发的 start 请求只有一个能把 STOPPED/ERROR 换成 STARTING，其余的不再重复计数和入组
+    EngineStatus expected = session->status;
+    do {
+        if (expected == EngineStatus::RUNNING || expected == EngineStatus::STARTING) {
+            std::cout << "Session already running: " << session_id << std::endl;
+            return true;
+        }
+        if (expected == EngineStatus::STOPPING) {
+            std::cerr << "Session is stopping: " << session_id << std::endl;
+            return false;
+        }
+    } while (!session->status.compare_exchange_strong(expected, EngineStatus::STARTING));
     
-    session->status = EngineStatus::STARTING;
     std::cout << "Starting session: " << session_id << std::endl;
     
     // 检查策略健康状态
@@ -255,7 +299,20 @@ bool TradingEngineManager::start_trading_session(const std::string& session_id)
     // 启动成功
     session->status = EngineStatus::RUNNING;
     session->last_update = std::chrono::system_clock::now();
-    stats_.active_sessions++;
+    {
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        stats_.active_sessions++;
+    }
+    // 品种组已建好时立即加入：新建的组挂上定时器，已有的组马上跑一轮；否则由 start_engine 统一分组。
+    // groups_active_ 和分组都在 sessions_mutex_ 下，会话要么被 start_engine 分组，要么在这里入组；
+    // 两边都看到时 join_groups 不会重复加入
+    std::vector<std::shared_ptr<InstrumentGroup>> created, joined;
+    {
+        std::lock_guard<std::mutex> lock(sessions_mutex_);
+        if (groups_active_) join_groups(session, created, joined);
+    }
+    for (auto& group : created) arm_group(group);
+    for (auto& group : joined) submit_group(group);
     
     std::cout << "Trading session started successfully!" << std::endl;
     log_session_activity(session_id, "Session started and running");
@@ -267,23 +324,27 @@ bool TradingEngineManager::start_trading_session(const std::string& session_id)
 bool TradingEngineManager::stop_trading_session(const std::string& session_id) {
     std::cout << "\n=== Stopping Trading Session ===" << std::endl;
     
-    auto it = trading_sessions_.find(session_id);
-    if (it == trading_sessions_.end()) {
+    auto session = find_session(session_id);
+    if (!session) {
         std::cerr << "Session not found: " << session_id << std::endl;
         return false;
     }
     
-    auto& session = it->second;
-    
-    // 检查当前状态
-    if (session->status != EngineStatus::RUNNING) {
+    // 检查当前状态；止盈止损可能在工作线程上同时停止同一会话，只有一方能把 RUNNING 换成 STOPPING
+    EngineStatus expected = EngineStatus::RUNNING;
+    if (!session->status.compare_exchange_strong(expected, EngineStatus::STOPPING)) {
         std::cout << "Session not running: " << session_id << std::endl;
         return true;
     }
     
-    session->status = EngineStatus::STOPPING;
     std::cout << "Stopping session: " << session_id << std::endl;
     
+    // 退出品种组；组正在执行的那一轮可能还带着它，执行前看到状态不是 RUNNING 就跳过
+    {
+        std::lock_guard<std::mutex> lock(sessions_mutex_);
+        leave_groups(session);
+    }
+    
     // 这里可以添加清理逻辑
     // 比如取消挂单、平仓等
     // TODO: 实现具体的清理逻辑
@@ -291,7 +352,10 @@ bool TradingEngineManager::stop_trading_session(const std::string& session_id) {
     // 停止成功
     session->status = EngineStatus::STOPPED;
     session->last_update = std::chrono::system_clock::now();
-    stats_.active_sessions--;
+    {
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        stats_.active_sessions--;
+    }
     
     std::cout << "Trading session stopped successfully!" << std::endl;
     log_session_activity(session_id, "Session stopped");
@@ -303,20 +367,26 @@ bool TradingEngineManager::stop_trading_session(const std::string& session_id) {
 bool TradingEngineManager::remove_trading_session(const std::string& session_id) {
     std::cout << "\n=== Removing Trading Session ===" << std::endl;
     
-    auto it = trading_sessions_.find(session_id);
-    if (it == trading_sessions_.end()) {
+    auto session = find_session(session_id);
+    if (!session) {
         std::cerr << "Session not found: " << session_id << std::endl;
         return false;
     }
     
     // 确保会话已停止
-    if (it->second->status == EngineStatus::RUNNING) {
+    if (session->status == EngineStatus::RUNNING) {
         std::cout << "Stopping session before removal..." << std::endl;
         stop_trading_session(session_id);
     }
     
     std::cout << "Removing session: " << session_id << std::endl;
-    trading_sessions_.erase(it);
+    {
+        // 执行中的任务持有 shared_ptr，会话在任务结束后才释放；
+        // 不论处于什么状态都退出品种组，组不再持有已删除的会话
+        std::lock_guard<std::mutex> lock(sessions_mutex_);
+        leave_groups(session);
+        trading_sessions_.erase(session_id);
+    }
     
     std::cout << "Trading session removed successfully!" << std::endl;
     log_session_activity(session_id, "Session removed");
@@ -326,6 +396,7 @@ bool TradingEngineManager::remove_trading_session(const std::string& session_id)
 
 // 获取活跃会话列表
 std::vector<std::string> TradingEngineManager::get_active_sessions() const {
+    std::lock_guard<std::mutex> lock(sessions_mutex_);
     std::vector<std::string> sessions;
     for (const auto& pair : trading_sessions_) {
         sessions.push_back(pair.first);
@@ -333,10 +404,31 @@ std::vector<std::string> TradingEngineManager::get_active_sessions() const {
     return sessions;
 }
 
-// 获取指定会话
-TradingSession* TradingEngineManager::get_session(const std::string& session_id) {
+// 获取指定会话；返回 shared_ptr，会话在使用期间被删除也不会释放
+std::shared_ptr<TradingSession> TradingEngineManager::get_session(const std::string& session_id) {
+    return find_session(session_id);
+}
+
+std::shared_ptr<TradingSession> TradingEngineManager::find_session(const std::string& session_id) const {
+    std::lock_guard<std::mutex> lock(sessions_mutex_);
     auto it = trading_sessions_.find(session_id);
-    return (it != trading_sessions_.end()) ? it->second.get() : nullptr;
+    return (it != trading_sessions_.end()) ? it->second : nullptr;
+}
+
+std::map<std::string, FreshnessTracker::SymbolSummary> TradingEngineManager::get_freshness_summary() const {
+    return freshness_tracker_->summary();
+}
+
+bool TradingEngineManager::set_sync_interval(int interval_ms) {
+    if (interval_ms <= 0 || !data_sync_service_) return false;
+    return data_sync_service_->set_sync_interval(interval_ms);
+}
+
+bool TradingEngineManager::get_redis_cache_stats(RedisClientCache::Stats& stats) const {
+    RedisClientCache* cache = redis_client_->client_cache();
+    if (!cache) return false;
+    stats = cache->stats();
+    return true;
 }
 
 // 更新会话统计信息
@@ -346,7 +438,8 @@ void TradingEngineManager::update_session_stats(TradingSession* session, double
         session->executed_trades += trades;
         session->last_update = std::chrono::system_clock::now();
         
-        // 更新全局统计
+        // 更新全局统计，多个会话并发执行
+        std::lock_guard<std::mutex> lock(stats_mutex_);
         stats_.total_profit_generated += profit;
         stats_.total_trades_executed += trades;
         stats_.last_update_time = session->last_update;
@@ -362,13 +455,54 @@ void TradingEngineManager::start_engine() {
     
     std::cout << "Starting trading engine..." << std::endl;
     engine_status_ = EngineStatus::STARTING;
-    should_run_ = true;
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        should_run_ = true;
+        pending_changes_ = PendingChanges();
+    }
     
-    // 启动数据同步调度器
+    // 启动数据同步：优先用 NOTIFY 推送，定时同步作为兜底心跳
     data_sync_service_->start_scheduler();
-    data_sync_service_->schedule_sync_task(5000); // 5秒同步一次
+    if (data_sync_service_->start_push_sync()) {
+        data_sync_service_->schedule_sync_task(30000); // 推送模式下30秒心跳一次
+    } else {
+        data_sync_service_->schedule_sync_task(5000); // 5秒同步一次
+    }
+    // 策略共享的连接池空闲时也定期检查，断线在下一次借出前就被发现并重连
+    data_sync_service_->schedule_redis_health_check(redis_client_->pool(), 10000);
+    
+    // 订阅变更通知；订阅失败时交易循环退回按 trading_interval_ms_ 轮询
+    if (change_subscriber_->start([this](const std::vector<MarketChangeEvent>& events) {
+            on_market_changes(events);
+        }, [this](bool connected) {
+            on_subscriber_state(connected);
+        })) {
+        std::cout << "Event-driven trading enabled" << std::endl;
+    } else {
+        std::cout << "Change subscription unavailable, polling every " << trading_interval_ms_ << "ms" << std::endl;
+    }
+    
+    // 启动会话线程池，把已经在运行的会话分组，给每个组挂上定时器并先执行一轮
+    session_pool_->start();
+    session_timers_->start();
+    std::vector<std::shared_ptr<InstrumentGroup>> groups, joined;
+    {
+        // 上次停止时线程池丢弃了排队的任务，组的调度状态不可信，整体重建
+        std::lock_guard<std::mutex> lock(sessions_mutex_);
+        arbitrage_groups_.clear();
+        market_making_groups_.clear();
+        groups_active_ = true;
+        for (auto& [session_id, session] : trading_sessions_) {
+            if (session->status == EngineStatus::RUNNING) {
+                join_groups(session, groups, joined);
+            }
+        }
+    }
+    for (auto& group : groups) {
+        arm_group(group);
+    }
     
-    // 启动交易循环线程
+    // 启动分发线程
     engine_thread_ = std::make_unique<std::thread>(&TradingEngineManager::trading_loop, this);
     
     engine_status_ = EngineStatus::RUNNING;
@@ -386,21 +520,36 @@ void TradingEngineManager::stop_engine() {
     
     std::cout << "Stopping trading engine..." << std::endl;
     engine_status_ = EngineStatus::STOPPING;
-    should_run_ = false;
+    change_subscriber_->stop();
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        should_run_ = false;
+    }
+    wake_cv_.notify_all();
     
-    // 等待交易线程结束
+    // 此后启动的会话不再入组，等下次 start_engine 统一分组
+    {
+        std::lock_guard<std::mutex> lock(sessions_mutex_);
+        groups_active_ = false;
+    }
+    
+    // 等待分发线程结束，再停定时器和线程池（等正在执行的会话跑完）
     if (engine_thread_ && engine_thread_->joinable()) {
         engine_thread_->join();
     }
+    session_timers_->stop();
+    session_pool_->stop();
     
     // 停止数据同步服务
     if (data_sync_service_) {
+        data_sync_service_->stop_push_sync();
         data_sync_service_->stop_scheduler();
     }
     
     // 停止所有活跃会话
-    for (auto& [session_id, session] : trading_sessions_) {
-        if (session->status == EngineStatus::RUNNING) {
+    for (const auto& session_id : get_active_sessions()) {
+        auto session = find_session(session_id);
+        if (session && session->status == EngineStatus::RUNNING) {
             stop_trading_session(session_id);
         }
     }
@@ -409,95 +558,331 @@ void TradingEngineManager::stop_engine() {
     std::cout << "Trading engine stopped" << std::endl;
 }
 
-// 交易循环
+// 分发循环：取走变更，把受影响的会话提交到线程池；会话的兜底执行由各自的定时器负责
 void TradingEngineManager::trading_loop() {
     std::cout << "Trading loop started" << std::endl;
     
-    while (should_run_) {
+    while (true) {
+        PendingChanges changes;
+        {
+            // 没有变更时按 trading_interval_ms_ 醒来清理过期会话
+            std::unique_lock<std::mutex> lock(wake_mutex_);
+            wake_cv_.wait_for(lock, std::chrono::milliseconds(trading_interval_ms_), [this]() {
+                return !should_run_ || !pending_changes_.empty();
+            });
+            if (!should_run_) break;
+            
+            changes = std::move(pending_changes_);
+            pending_changes_ = PendingChanges();
+        }
+        
         try {
-            // 检查所有运行中的会话
-            for (auto& [session_id, session] : trading_sessions_) {
-                if (session->status == EngineStatus::RUNNING) {
-                    execute_trading_session(session.get());
-                    session->last_update = std::chrono::system_clock::now();
-                    // === 止盈止损判断逻辑 ===
-                    double profit = session->total_profit;
-                    double max_amount = session->request.max_amount;
-                    double take_profit_amount = max_amount * session->request.take_profit_ratio;
-                    double stop_loss_amount = max_amount * session->request.stop_loss_ratio;
-
-                    if (profit >= take_profit_amount) {
-                        std::cout << "[止盈] Session " << session_id 
-                                  << " 盈利 $" << profit << "，自动停止" << std::endl;
-                        stop_trading_session(session_id);
-                        log_session_activity(session_id, "止盈触发，自动停止");
-                    } else if (profit <= -stop_loss_amount) {
-                        std::cout << "[止损] Session " << session_id 
-                                  << " 亏损 $" << profit << "，自动停止" << std::endl;
-                        stop_trading_session(session_id);
-                        log_session_activity(session_id, "止损触发，自动停止");
+            // 只提交行情有变化的品种组：套利比较所有交易所的同一 symbol，做市只看自己的 (exchange, symbol)；
+            // 统计变更两者都关心
+            if (!changes.empty()) {
+                std::vector<std::shared_ptr<InstrumentGroup>> affected;
+                {
+                    std::lock_guard<std::mutex> lock(sessions_mutex_);
+                    for (auto& [symbol, group] : arbitrage_groups_) {
+                        if (changes.stats.count(symbol) || changes.raw_symbols.count(symbol)) {
+                            affected.push_back(group);
+                        }
                     }
+                    for (auto& [key, group] : market_making_groups_) {
+                        if (changes.stats.count(key.second) || changes.raw.count(key)) {
+                            affected.push_back(group);
+                        }
+                    }
+                }
+                for (auto& group : affected) {
+                    submit_group(group);
                 }
             }
-
+            
             // 清理过期/异常会话
             cleanup_expired_sessions();
-
+            
         } catch (const std::exception& e) {
             std::cerr << "Error in trading loop: " << e.what() << std::endl;
         }
+    }
+    
+    std::cout << "Trading loop stopped" << std::endl;
+}
 
-        // 每轮间隔
-        std::this_thread::sleep_for(std::chrono::milliseconds(trading_interval_ms_));
+// 按会话的策略加入对应的品种组，组不存在时新建；已在组里则跳过。调用方持有 sessions_mutex_
+void TradingEngineManager::join_groups(const std::shared_ptr<TradingSession>& session,
+                                       std::vector<std::shared_ptr<InstrumentGroup>>& created,
+                                       std::vector<std::shared_ptr<InstrumentGroup>>& joined) {
+    const auto& request = session->request;
+    auto join = [&](std::shared_ptr<InstrumentGroup>& group, bool arbitrage, const std::string& exchange) {
+        if (group && std::find(group->sessions.begin(), group->sessions.end(), session) != group->sessions.end()) {
+            return;
+        }
+        if (!group) {
+            group = std::make_shared<InstrumentGroup>();
+            group->arbitrage = arbitrage;
+            group->exchange = exchange;
+            group->symbol = request.symbol;
+            created.push_back(group);
+        } else {
+            joined.push_back(group);
+        }
+        group->sessions.push_back(session);
+    };
+    
+    if (session->arbitrage_strategy) {
+        join(arbitrage_groups_[request.symbol], true, "");
+    }
+    if (session->market_making_strategy) {
+        join(market_making_groups_[{request.exchange, request.symbol}], false, request.exchange);
     }
+}
 
-    std::cout << "Trading loop stopped" << std::endl;
+// 从所在的品种组移除，组空了就取消定时器并删除；调用方持有 sessions_mutex_
+void TradingEngineManager::leave_groups(const std::shared_ptr<TradingSession>& session) {
+    auto leave = [&](InstrumentGroup& group) {
+        auto& members = group.sessions;
+        members.erase(std::remove(members.begin(), members.end(), session), members.end());
+        if (members.empty()) group.timer.cancel();
+        return members.empty();
+    };
+    
+    const auto& request = session->request;
+    if (session->arbitrage_strategy) {
+        auto it = arbitrage_groups_.find(request.symbol);
+        if (it != arbitrage_groups_.end() && leave(*it->second)) {
+            arbitrage_groups_.erase(it);
+        }
+    }
+    if (session->market_making_strategy) {
+        auto it = market_making_groups_.find({request.exchange, request.symbol});
+        if (it != market_making_groups_.end() && leave(*it->second)) {
+            market_making_groups_.erase(it);
+        }
+    }
 }
 
-// 执行交易会话
-void TradingEngineManager::execute_trading_session(TradingSession* session) {
-    if (!session) return;
+// 订阅连接可用时只需低频心跳，否则按 trading_interval_ms_ 轮询
+int TradingEngineManager::group_timer_interval_ms() const {
+    return change_subscriber_->is_connected() ? idle_heartbeat_ms_ : trading_interval_ms_;
+}
+
+// 订阅线程回调：断线时所有组改为轮询；恢复时改回心跳，并补跑一轮兜住断线期间丢失的通知
+void TradingEngineManager::on_subscriber_state(bool connected) {
+    int interval_ms = connected ? idle_heartbeat_ms_ : trading_interval_ms_;
+    std::vector<std::shared_ptr<InstrumentGroup>> groups;
+    {
+        std::lock_guard<std::mutex> lock(sessions_mutex_);
+        for (auto& [symbol, group] : arbitrage_groups_) groups.push_back(group);
+        for (auto& [key, group] : market_making_groups_) groups.push_back(group);
+        for (auto& group : groups) group->timer.setInterval(interval_ms);
+    }
     
-    try {
-        std::cout << "Executing session: " << session->session_id << std::endl;
-        
-        // 执行套利策略
-        if (session->arbitrage_strategy) {
-            execute_arbitrage_session(session);
+    std::cout << "Change subscription " << (connected ? "restored" : "lost") << ", group timers every "
+              << interval_ms << "ms" << std::endl;
+    if (!connected) return;
+    for (auto& group : groups) {
+        submit_group(group);
+    }
+}
+
+// 挂上兜底定时器并立即执行一次
+void TradingEngineManager::arm_group(const std::shared_ptr<InstrumentGroup>& group) {
+    int interval_ms = group_timer_interval_ms();
+    std::weak_ptr<InstrumentGroup> weak = group;
+    SchedulerTaskHandle timer = session_timers_->addTask([this, weak]() {
+        if (auto group = weak.lock()) submit_group(group);
+    }, interval_ms, OverrunPolicy::Skip, ScheduleMode::FixedRate);
+    {
+        std::lock_guard<std::mutex> lock(sessions_mutex_);
+        group->timer.cancel();
+        // 挂定时器期间组里的会话可能已经全部停止，组已从表中删除
+        if (group->sessions.empty()) {
+            timer.cancel();
+            return;
+        }
+        group->timer = timer;
+        // 挂定时器期间订阅状态可能已经变化，状态回调也在 sessions_mutex_ 下调整，这里以当前状态为准
+        int current_ms = group_timer_interval_ms();
+        if (current_ms != interval_ms) group->timer.setInterval(current_ms);
+    }
+    submit_group(group);
+}
+
+// 先置 rerun 再抢 in_flight：抢到就提交；没抢到说明正在执行，执行方结束时会看到 rerun
+void TradingEngineManager::submit_group(const std::shared_ptr<InstrumentGroup>& group) {
+    group->rerun = true;
+    if (group->in_flight.exchange(true)) return;
+    if (!session_pool_->submit([this, group]() { run_group(group); })) {
+        group->in_flight = false;
+    }
+}
+
+// 线程池任务：每轮读一次行情，按 const 引用交给组内所有会话；执行期间到达的触发合并成下一轮
+void TradingEngineManager::run_group(const std::shared_ptr<InstrumentGroup>& group) {
+    while (true) {
+        group->rerun = false;
+        std::vector<std::shared_ptr<TradingSession>> members;
+        {
+            std::lock_guard<std::mutex> lock(sessions_mutex_);
+            members = group->sessions;
         }
         
-        // 执行做市策略
-        if (session->market_making_strategy) {
-            execute_market_making_session(session);
+        // 组内策略的品种相同、读的是同一个缓存槽位或 Redis key，由第一个会话的策略读取即可；
+        // 组已被删除时 members 为空，这一轮什么也不做
+        try {
+            if (group->arbitrage && !members.empty()) {
+                ArbitrageStrategy::PriceStatsData price_stats = members.front()->arbitrage_strategy->get_price_stats();
+                for (auto& session : members) {
+                    execute_trading_session(session, &price_stats, nullptr);
+                }
+            } else if (!members.empty()) {
+                MarketMakingStrategy::MarketData market_data = members.front()->market_making_strategy->get_market_data();
+                for (auto& session : members) {
+                    execute_trading_session(session, nullptr, &market_data);
+                }
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Error reading market data for " << group->exchange << ":" << group->symbol
+                      << ": " << e.what() << std::endl;
         }
         
-        // 更新最后活动时间
-        session->last_update = std::chrono::system_clock::now();
+        group->in_flight = false;
+        // 释放 in_flight 之前到达的触发只置了 rerun，重新抢到 in_flight 就接着执行
+        if (!group->rerun || group->in_flight.exchange(true)) return;
+    }
+}
+
+// 止盈止损判断，调用方持有 session->run_mutex；触发时返回原因，由调用方释放锁后停止会话
+std::string TradingEngineManager::check_profit_limits(TradingSession* session) {
+    if (session->status != EngineStatus::RUNNING) return "";
+    const std::string& session_id = session->session_id;
+    double profit = session->total_profit;
+    double max_amount = session->request.max_amount;
+    double take_profit_amount = max_amount * session->request.take_profit_ratio;
+    double stop_loss_amount = max_amount * session->request.stop_loss_ratio;
+
+    if (profit >= take_profit_amount) {
+        std::cout << "[止盈] Session " << session_id 
+                  << " 盈利 $" << profit << "，自动停止" << std::endl;
+        return "止盈触发，自动停止";
+    } else if (profit <= -stop_loss_amount) {
+        std::cout << "[止损] Session " << session_id 
+                  << " 亏损 $" << profit << "，自动停止" << std::endl;
+        return "止损触发，自动停止";
+    }
+    return "";
+}
+
+// 订阅线程回调：记录变更并唤醒分发循环，不接触会话
+void TradingEngineManager::on_market_changes(const std::vector<MarketChangeEvent>& events) {
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        for (const auto& event : events) {
+            if (event.is_stats) {
+                pending_changes_.stats.insert(event.symbol);
+            } else {
+                pending_changes_.raw.emplace(event.exchange, event.symbol);
+                pending_changes_.raw_symbols.insert(event.symbol);
+            }
+        }
+    }
+    wake_cv_.notify_one();
+}
+
+// 执行交易会话；MIXED 会话的两个组可能同时执行到它，持 run_mutex 串行
+void TradingEngineManager::execute_trading_session(const std::shared_ptr<TradingSession>& session,
+                                                   const ArbitrageStrategy::PriceStatsData* price_stats,
+                                                   const MarketMakingStrategy::MarketData* market_data) {
+    if (!session) return;
+    
+    bool failed = false;
+    std::string limit_reason;
+    {
+        std::lock_guard<std::mutex> run_lock(session->run_mutex);
+        if (session->status != EngineStatus::RUNNING) return;
         
-    } catch (const std::exception& e) {
-        std::cerr << "Error executing session " << session->session_id << ": " << e.what() << std::endl;
-        session->status = EngineStatus::ERROR;
+        try {
+            std::cout << "Executing session: " << session->session_id << std::endl;
+            
+            // 执行套利策略
+            if (price_stats) {
+                execute_arbitrage_session(session.get(), *price_stats);
+            }
+            
+            // 执行做市策略
+            if (market_data) {
+                execute_market_making_session(session.get(), *market_data);
+            }
+            
+            // 更新最后活动时间
+            session->last_update = std::chrono::system_clock::now();
+            
+            // 盈亏由两个组的任务在 run_mutex 下累加，判断也在锁内做
+            limit_reason = check_profit_limits(session.get());
+            
+        } catch (const std::exception& e) {
+            std::cerr << "Error executing session " << session->session_id << ": " << e.what() << std::endl;
+            failed = true;
+        }
+    }
+    
+    if (failed) {
+        fail_session(session);
+        return;
+    }
+    // 停止会话要取 sessions_mutex_ 并退出品种组，放在 run_mutex 之外
+    if (!limit_reason.empty()) {
+        stop_trading_session(session->session_id);
+        log_session_activity(session->session_id, limit_reason);
     }
 }
 
+// 执行出错：和停止一样退出品种组、减少活跃会话数，状态置为 ERROR 等待清理
+void TradingEngineManager::fail_session(const std::shared_ptr<TradingSession>& session) {
+    // 与 stop_trading_session 竞争，只有把 RUNNING 换掉的一方负责计数
+    EngineStatus expected = EngineStatus::RUNNING;
+    if (!session->status.compare_exchange_strong(expected, EngineStatus::ERROR)) return;
+    
+    {
+        std::lock_guard<std::mutex> lock(sessions_mutex_);
+        leave_groups(session);
+    }
+    {
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        stats_.active_sessions--;
+    }
+    log_session_activity(session->session_id, "Session failed, removed from scheduling");
+}
+
 // 执行套利会话
-void TradingEngineManager::execute_arbitrage_session(TradingSession* session) {
+void TradingEngineManager::execute_arbitrage_session(TradingSession* session,
+                                                     const ArbitrageStrategy::PriceStatsData& price_stats) {
     if (!session->arbitrage_strategy) return;
     
     std::cout << "Running arbitrage strategy for " << session->request.symbol << std::endl;
     
-    // 调用套利策略的运行函数
-    StrategyResult result = session->arbitrage_strategy->run_once();
+    // 调用套利策略的运行函数，行情由品种组统一读取
+    StrategyResult result = session->arbitrage_strategy->run_once(price_stats);
     auto time_t = std::chrono::system_clock::to_time_t(session->last_update);
     std::ostringstream ts;
     ts << "[" << std::put_time(std::localtime(&time_t), "%H:%M:%S") << "] ";
 
-    for (const auto& line : result.logs) {
-        session->log.push_back(ts.str() + line);
+    {
+        std::lock_guard<std::mutex> lock(session->log_mutex);
+        for (const auto& line : result.logs) {
+            session->log.push_back(ts.str() + line);
+        }
     }
 
     update_session_stats(session, result.profit, result.trades);
 
+    if (result.skipped_stale) {
+        log_session_activity(session->session_id,
+            "Arbitrage skipped: data " + std::to_string(static_cast<long>(result.data_age_ms)) + "ms old");
+    }
+
     if (result.profit > 0 || result.trades > 0) {
         log_session_activity(session->session_id,
             "Arbitrage executed: profit=" + std::to_string(result.profit) +
@@ -507,24 +892,33 @@ void TradingEngineManager::execute_arbitrage_session(TradingSession* session) {
 }
 
 // 执行做市会话
-void TradingEngineManager::execute_market_making_session(TradingSession* session) {
+void TradingEngineManager::execute_market_making_session(TradingSession* session,
+                                                         const MarketMakingStrategy::MarketData& market_data) {
     if (!session->market_making_strategy) return;
     
     std::cout << "Running market making strategy for " << session->request.symbol 
               << " on " << session->request.exchange << std::endl;
     
-    // 调用做市策略的运行函数
-    StrategyResult result = session->market_making_strategy->run_once();
+    // 调用做市策略的运行函数，行情由品种组统一读取
+    StrategyResult result = session->market_making_strategy->run_once(market_data);
     auto time_t = std::chrono::system_clock::to_time_t(session->last_update);
     std::ostringstream ts;
     ts << "[" << std::put_time(std::localtime(&time_t), "%H:%M:%S") << "] ";
 
-    for (const auto& line : result.logs) {
-        session->log.push_back(ts.str() + line);
+    {
+        std::lock_guard<std::mutex> lock(session->log_mutex);
+        for (const auto& line : result.logs) {
+            session->log.push_back(ts.str() + line);
+        }
     }
 
     update_session_stats(session, result.profit, result.trades);
 
+    if (result.skipped_stale) {
+        log_session_activity(session->session_id,
+            "Market making skipped: data " + std::to_string(static_cast<long>(result.data_age_ms)) + "ms old");
+    }
+
     if (result.profit > 0 || result.trades > 0) {
         log_session_activity(session->session_id,
             "Market making executed: profit=" + std::to_string(result.profit) +
@@ -538,18 +932,28 @@ void TradingEngineManager::cleanup_expired_sessions() {
     auto now = std::chrono::system_clock::now();
     std::vector<std::string> sessions_to_remove;
     
-    for (const auto& [session_id, session] : trading_sessions_) {
+    // HTTP 线程和工作线程会同时增删会话，先在锁内复制一份再检查
+    std::vector<std::shared_ptr<TradingSession>> sessions;
+    {
+        std::lock_guard<std::mutex> lock(sessions_mutex_);
+        sessions.reserve(trading_sessions_.size());
+        for (const auto& [session_id, session] : trading_sessions_) {
+            sessions.push_back(session);
+        }
+    }
+    
+    for (const auto& session : sessions) {
         // 检查会话是否超时（比如1小时没有活动）
         auto inactive_duration = std::chrono::duration_cast<std::chrono::hours>(
-            now - session->last_update).count();
+            now - session->last_update.load()).count();
         
         if (inactive_duration > 1 && session->status == EngineStatus::STOPPED) {
-            sessions_to_remove.push_back(session_id);
+            sessions_to_remove.push_back(session->session_id);
         }
         
         // 检查错误状态的会话
         if (session->status == EngineStatus::ERROR) {
-            sessions_to_remove.push_back(session_id);
+            sessions_to_remove.push_back(session->session_id);
         }
     }
     
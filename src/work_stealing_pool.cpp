@@ -0,0 +1,131 @@
+#include "work_stealing_pool.h"
+#include <algorithm>
+#include <iostream>
+
+namespace {
+// 当前线程所属的池和队列下标，用于判断 submit 是否来自池内线程
+thread_local const WorkStealingPool* current_pool = nullptr;
+thread_local size_t current_index = 0;
+}
+
+WorkStealingPool::WorkStealingPool(size_t thread_count)
+    : running_(false), next_queue_(0), pending_(0), executed_(0), stolen_(0) {
+    if (thread_count == 0) {
+        thread_count = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    }
+    for (size_t i = 0; i < thread_count; ++i) {
+        queues_.push_back(std::make_unique<WorkerQueue>());
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    stop();
+}
+
+void WorkStealingPool::start() {
+    if (running_) return;
+    running_ = true;
+    for (size_t i = 0; i < queues_.size(); ++i) {
+        threads_.emplace_back(&WorkStealingPool::worker_loop, this, i);
+    }
+    std::cout << "Work-stealing pool started with " << queues_.size() << " threads" << std::endl;
+}
+
+void WorkStealingPool::stop() {
+    if (!running_) return;
+    {
+        std::lock_guard<std::mutex> lock(idle_mutex_);
+        running_ = false;
+    }
+    idle_cv_.notify_all();
+
+    for (auto& thread : threads_) {
+        if (thread.joinable()) thread.join();
+    }
+    threads_.clear();
+
+    for (auto& queue : queues_) {
+        std::lock_guard<std::mutex> lock(queue->mutex);
+        queue->tasks.clear();
+    }
+    pending_ = 0;
+}
+
+bool WorkStealingPool::submit(Task task) {
+    if (!running_) return false;
+
+    // 池内线程提交到自己的队列，外部线程轮流分配
+    size_t index = current_pool == this ? current_index : next_queue_++ % queues_.size();
+    {
+        // 先计数再入队：任务一入队就可能被取走并减计数，计数必须先于任务可见；
+        // 在 idle_mutex_ 下增加，避免与正在判断是否睡眠的线程错过唤醒
+        std::lock_guard<std::mutex> lock(idle_mutex_);
+        pending_++;
+    }
+    {
+        std::lock_guard<std::mutex> lock(queues_[index]->mutex);
+        queues_[index]->tasks.push_back(std::move(task));
+    }
+    idle_cv_.notify_one();
+    return true;
+}
+
+bool WorkStealingPool::pop_local(size_t index, Task& task) {
+    WorkerQueue& queue = *queues_[index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty()) return false;
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    return true;
+}
+
+// 从下一个队列开始依次尝试，避免所有线程都去偷同一个
+bool WorkStealingPool::steal(size_t thief, Task& task) {
+    for (size_t offset = 1; offset < queues_.size(); ++offset) {
+        WorkerQueue& queue = *queues_[(thief + offset) % queues_.size()];
+        std::unique_lock<std::mutex> lock(queue.mutex, std::try_to_lock);
+        if (!lock.owns_lock() || queue.tasks.empty()) continue;
+        task = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+        return true;
+    }
+    return false;
+}
+
+void WorkStealingPool::worker_loop(size_t index) {
+    current_pool = this;
+    current_index = index;
+
+    while (running_) {
+        Task task;
+        bool found = pop_local(index, task);
+        if (!found && steal(index, task)) {
+            found = true;
+            stolen_++;
+        }
+
+        if (!found) {
+            // try_to_lock 可能跳过有任务的队列，所以以 pending_ 为准决定是否睡眠
+            std::unique_lock<std::mutex> lock(idle_mutex_);
+            idle_cv_.wait(lock, [this]() { return !running_ || pending_ > 0; });
+            continue;
+        }
+
+        pending_--;
+        try {
+            task();
+        } catch (const std::exception& e) {
+            std::cerr << "Pool task failed: " << e.what() << std::endl;
+        }
+        executed_++;
+    }
+
+    current_pool = nullptr;
+}
+
+WorkStealingPool::Stats WorkStealingPool::stats() const {
+    Stats stats;
+    stats.executed = executed_;
+    stats.stolen = stolen_;
+    return stats;
+}